@@ -12,6 +12,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 /* Threading support: GCD on macOS, pthreads elsewhere */
 #ifdef __APPLE__
@@ -39,6 +40,19 @@
 #define ALWAYS_INLINE inline
 #endif
 
+/* Cache line size for false-sharing isolation (Apple silicon uses 128-byte lines) */
+#if defined(__APPLE__) && defined(__aarch64__)
+#define CACHE_LINE_SIZE 128
+#else
+#define CACHE_LINE_SIZE 64
+#endif
+
+#ifdef __GNUC__
+#define CACHE_ALIGNED __attribute__((aligned(CACHE_LINE_SIZE)))
+#else
+#define CACHE_ALIGNED
+#endif
+
 /* Memory prefetch hints */
 #ifdef __GNUC__
 #define PREFETCH_READ(addr) __builtin_prefetch(addr, 0, 3)
@@ -64,15 +78,34 @@
 #define DEBUG_LOG(fmt, ...) ((void)0)
 #endif
 
+/* Spin-wait hint for polling loops */
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define cpu_relax() __asm__ __volatile__("yield" ::: "memory")
+#else
+#define cpu_relax() __asm__ __volatile__("" ::: "memory")
+#endif
+
 /* Configuration constants */
 #define MAX_IFNAME_LEN 16
 #define MAX_WORKERS 16
+#define PLACEMENT_MAX_CPUS 1024 /* Highest CPU number + 1 the placement engine handles */
 #define BATCH_SIZE 64
 #define STATS_FLUSH_BATCHES 8 /* Flush stats every 8 batches (~512 packets) */
+#define IDLE_SPIN_POLLS 2048  /* Default empty polls before sleeping (~tens of us) */
 #define FRAME_SIZE 4096
 #define NUM_FRAMES 4096
 #define UMEM_SIZE (NUM_FRAMES * FRAME_SIZE) /* 16MB */
 
+/* AF_PACKET TPACKET_V3: longest a partly filled RX block waits for delivery (ms) */
+#define PACKET_BLOCK_TIMEOUT_MS 1
+
+/* Burst sizing: config.batch_size defaults to BATCH_SIZE (see burst_ctl_t) */
+#define MAX_BATCH_SIZE 256      /* Largest burst; sizes the worker's stack arrays */
+#define ADAPTIVE_BATCH_MIN 16   /* Adaptive mode never requests fewer packets */
+#define ADAPTIVE_SHRINK_AFTER 8 /* Light bursts in a row before the burst is halved */
+
 /* ITO packet signatures (NetAlly/Fluke/NETSCOUT) */
 #define ITO_SIG_PROBEOT "PROBEOT"
 #define ITO_SIG_DATAOT "DATA:OT"
@@ -128,6 +161,7 @@
 #define VLAN_HDR_LEN 4      /* TPID (2) + TCI (2) */
 #define VLAN_TPID_OFFSET 0  /* Tag Protocol Identifier */
 #define VLAN_TCI_OFFSET 2   /* Tag Control Information */
+#define MAX_VLAN_DEPTH 2    /* 802.1Q, or 802.1ad QinQ outer + inner */
 
 /* IPv6 header offsets (40 bytes fixed, unlike IPv4) */
 #define IPV6_HDR_LEN 40
@@ -201,6 +235,13 @@ typedef enum {
 	ERR_CATEGORY_COUNT
 } error_category_t;
 
+/*
+ * RX stamps (NIC, kernel) and the TX stamp come from different clocks. A
+ * sample with RX after TX by up to this much is clock jitter and counts as
+ * 0 ns; beyond it the clocks disagree and the sample is rejected.
+ */
+#define LATENCY_CLOCK_SLACK_NS 1000
+
 /* Latency statistics */
 typedef struct {
 	uint64_t count;    /* Number of measurements */
@@ -208,8 +249,74 @@ typedef struct {
 	uint64_t min_ns;   /* Minimum latency */
 	uint64_t max_ns;   /* Maximum latency */
 	double avg_ns;     /* Average latency */
+	uint64_t p50_ns;   /* Percentiles from latency_hist (filled by reflector_get_stats) */
+	uint64_t p99_ns;
+	uint64_t p999_ns;
+	uint64_t p9999_ns;
+	uint64_t rejected; /* RX stamp after TX by more than LATENCY_CLOCK_SLACK_NS (not counted) */
 } latency_stats_t;
 
+/*
+ * Latency histogram (HDR-style log-linear buckets)
+ *
+ * Values below LATENCY_HIST_SUB_BUCKETS ns get one bucket each; above that,
+ * every power of two is split into LATENCY_HIST_SUB_BUCKETS linear buckets,
+ * so a bucket is at most 1/32 (~3%) of its value wide. Values of
+ * 2^LATENCY_HIST_MAX_BITS ns (~4.3 s) and above land in the last bucket.
+ * Fixed size (7 KB); each worker records into its own copy.
+ */
+#define LATENCY_HIST_SUB_BITS 5
+#define LATENCY_HIST_SUB_BUCKETS (1 << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_MAX_BITS 32
+#define LATENCY_HIST_BUCKETS                                                                       \
+	((LATENCY_HIST_MAX_BITS - LATENCY_HIST_SUB_BITS + 1) * LATENCY_HIST_SUB_BUCKETS)
+
+typedef struct {
+	uint64_t buckets[LATENCY_HIST_BUCKETS];
+} latency_hist_t;
+
+/*
+ * Hot-path profile (build with -DENABLE_HOT_PATH_PROFILE, enable with
+ * config.profile_hot_path)
+ *
+ * Each worker reads hardware counters between the phases of every non-empty
+ * burst and accumulates the deltas per phase. Without the build flag the
+ * worker loop contains no profiling code and these counters stay zero.
+ */
+typedef enum {
+	PROF_PHASE_RECV = 0, /* recv_batch() and RX accounting */
+	PROF_PHASE_CLASSIFY, /* Fused classify+reflect kernel and signature accounting */
+	PROF_PHASE_RELEASE,  /* release_batch() of rejected frames */
+	PROF_PHASE_SEND,     /* send_batch() and TX accounting */
+	PROF_PHASE_COUNT
+} prof_phase_t;
+
+typedef enum {
+	PROF_EVENT_CYCLES = 0,
+	PROF_EVENT_INSTRUCTIONS,
+	PROF_EVENT_CACHE_MISSES, /* Last-level cache misses */
+	PROF_EVENT_COUNT
+} prof_event_t;
+
+typedef struct {
+	uint64_t bursts;                                     /* Profiled (non-empty) bursts */
+	uint64_t packets;                                    /* Packets in those bursts */
+	uint64_t counts[PROF_PHASE_COUNT][PROF_EVENT_COUNT]; /* Event totals per phase */
+	uint32_t events;                                     /* Bit per prof_event_t read */
+	bool tsc_cycles;                                     /* Cycles from the TSC (no PMU) */
+} hot_path_profile_t;
+
+/* In-kernel XDP program counters (stats_map summed over CPUs, AF_XDP only) */
+typedef struct {
+	uint64_t packets_total;   /* Every frame the program saw */
+	uint64_t packets_ito;     /* Matched and redirected to AF_XDP or reflected */
+	uint64_t packets_passed;  /* Handed to the kernel stack (XDP_PASS) */
+	uint64_t packets_dropped; /* XDP_DROP / XDP_ABORTED */
+	uint64_t packets_tx;      /* Reflected in-kernel with XDP_TX */
+	uint64_t bytes_tx;        /* Bytes reflected with XDP_TX */
+	bool valid;               /* Map was read (false on other backends) */
+} xdp_map_stats_t;
+
 /* Statistics structure */
 typedef struct {
 	/* Basic packet counters */
@@ -234,6 +341,7 @@ typedef struct {
 	uint64_t err_invalid_signature;
 	uint64_t err_too_short;
 	uint64_t err_tx_failed;
+	uint64_t err_tx_backpressure; /* TX drops after the bounded backlog wait (in err_tx_failed) */
 	uint64_t err_nomem;
 
 	/* Legacy error counters (for compatibility) */
@@ -244,6 +352,13 @@ typedef struct {
 
 	/* Latency measurements */
 	latency_stats_t latency;
+	latency_hist_t latency_hist; /* Dwell-time distribution (single writer: the worker) */
+
+	/* Per-phase hardware counters (zero unless profiling, see hot_path_profile_t) */
+	hot_path_profile_t profile;
+
+	/* Backend counters (filled in aggregated stats only) */
+	xdp_map_stats_t xdp;
 
 	/* Performance metrics */
 	double pps;  /* Packets per second (reflected) */
@@ -270,22 +385,46 @@ typedef struct {
 	bool enable_stats;           /* Enable statistics collection */
 	bool promiscuous;            /* Enable promiscuous mode */
 	bool zero_copy;              /* Enable zero-copy mode (if supported) */
-	int batch_size;              /* Packet batch size */
+	int batch_size;              /* Burst size, 1..MAX_BATCH_SIZE (adaptive: the ceiling) */
+	bool adaptive_batch;         /* Grow the burst under load, shrink it when light */
 	int frame_size;              /* Frame size in UMEM */
 	int num_frames;              /* Number of frames in UMEM */
 	int queue_id;                /* RX/TX queue ID (-1 for auto) */
-	bool busy_poll;              /* Enable busy polling */
+	bool busy_poll;              /* Always spin; never sleep when idle */
 	int poll_timeout_ms;         /* Poll timeout in milliseconds */
+	int idle_spin_polls;         /* Empty polls before an idle worker sleeps in wait_rx */
 	bool measure_latency;        /* Enable latency measurements */
+	bool latency_per_packet;     /* Read the clock per packet instead of per burst */
+	bool hw_timestamps;          /* Use NIC hardware RX timestamps when available */
 	stats_format_t stats_format; /* Statistics output format */
 	int stats_interval_sec;      /* Statistics display interval (seconds) */
-	int cpu_affinity;            /* CPU to pin worker thread (-1 for auto) */
+	int cpu_affinity;            /* First CPU for workers, consecutive (-1 for auto) */
 	bool use_huge_pages;         /* Use huge pages for UMEM (Linux only) */
+	bool shared_umem;            /* One UMEM for all AF_XDP queues (XDP_SHARED_UMEM) */
+	int block_timeout_ms;        /* AF_PACKET V3 block retire timeout (tp_retire_blk_tov) */
 	bool software_checksum;      /* Calculate checksums in software (fallback) */
+	bool profile_hot_path;       /* Per-phase counters (needs ENABLE_HOT_PATH_PROFILE) */
+	int snapshot_interval_ms;    /* Publish a stats snapshot this often (0 = never) */
+	bool stats_shm;              /* Mirror snapshots into /dev/shm (see reflector_shm_t) */
+
+	/* Worker placement (see plan_worker_cpus) */
+	int worker_cpus[MAX_WORKERS]; /* Explicit worker -> CPU list (--cpus) */
+	int num_worker_cpus;          /* Entries in worker_cpus (0 = not set) */
+	bool avoid_smt_siblings;      /* Auto: first hardware thread of each core only */
+	bool avoid_irq_cpus;          /* Auto: keep workers off the queues' IRQ CPUs */
 
 	/* DPDK options (Linux only, requires --dpdk flag) */
 	bool use_dpdk;   /* Use DPDK instead of AF_XDP (100G mode) */
 	char *dpdk_args; /* EAL arguments (e.g., "--lcores=1-4") */
+	int dpdk_mtu;    /* Port MTU, e.g. 9000 for jumbo frames (0 = device default) */
+
+	/* Virtual NIC options (interface "vnic", see vnic_platform.c) */
+	char *vnic_rx_pcap;     /* Replay the frames of this pcap (NULL = synthetic probes) */
+	char *vnic_tx_pcap;     /* Capture reflected frames here (NULL = count only) */
+	uint64_t vnic_rx_count; /* Frames injected per worker (0 = unlimited) */
+	int vnic_frame_len;     /* Synthetic frame length in bytes (0 = 64) */
+	uint32_t vnic_tx_ring;  /* Bounded TX ring size in frames (0 = TX completes at once) */
+	bool vnic_tx_stall;     /* The TX ring never completes (backlog overflow tests) */
 
 	/* ITO packet filtering options */
 	uint16_t ito_port;   /* Required UDP port (default 3842, 0 = any) */
@@ -295,6 +434,7 @@ typedef struct {
 
 	/* Reflection mode */
 	reflect_mode_t reflect_mode; /* What to swap: MAC, MAC+IP, or ALL */
+	bool xdp_tx;                 /* Reflect in-kernel via XDP_TX (AF_XDP + eBPF only) */
 
 	/* Signature filter */
 	sig_filter_t sig_filter; /* Which signatures to accept (default: ALL) */
@@ -304,27 +444,180 @@ typedef struct {
 	bool enable_vlan; /* Enable VLAN-tagged packet handling (default: true) */
 } reflector_config_t;
 
+/* Header offsets recorded by classify_packet() (single parse per packet) */
+typedef struct {
+	uint16_t l3_offset;      /* Start of IPv4/IPv6 header */
+	uint16_t l4_offset;      /* Start of UDP header */
+	uint16_t payload_offset; /* Start of UDP payload */
+	uint8_t vlan_depth;      /* Number of 802.1Q/802.1ad tags (0..MAX_VLAN_DEPTH) */
+	bool is_ipv6;            /* L3 is IPv6 (fixed 40-byte header) */
+} pkt_hdrs_t;
+
 /* Packet descriptor */
 typedef struct {
 	uint8_t *data;      /* Packet data pointer */
-	uint32_t len;       /* Packet length */
+	uint32_t len;       /* Contiguous bytes at data (all the core may touch) */
+	uint32_t extra_len; /* Frame bytes in chained buffers past len (worker zeroes it) */
 	uint64_t addr;      /* Buffer address (for zero-copy) */
-	uint64_t timestamp; /* Receive timestamp (nanoseconds) */
+	uint64_t timestamp; /* RX time in fast_clock_ns() domain (0 = stamp in core) */
 } packet_t;
 
 /* Platform-specific context (opaque) */
 typedef struct platform_ctx platform_ctx_t;
 
-/* Worker thread context */
+/*
+ * Worker thread context. Each context is cache-line aligned (the workers
+ * array is allocated with CACHE_LINE_SIZE alignment) and the stats block
+ * starts on its own line, so neighbouring workers never share counter lines.
+ *
+ * stats is written only by the owning worker, bracketed by
+ * worker_stats_write_begin()/end(): stats_seq is odd while an update is in
+ * progress, and readers (reflector_get_stats) retry until they copy the
+ * block between two identical even values. latency_hist is updated in the
+ * same seqlock write as latency, so its total always equals latency.count.
+ */
 typedef struct {
 	int worker_id;
 	int queue_id;
 	int cpu_id;
+	int numa_node; /* Node of cpu_id (-1 if unknown) */
 	platform_ctx_t *pctx;
 	reflector_config_t *config;
-	reflector_stats_t stats;
 	volatile bool running;
-} worker_ctx_t;
+	volatile bool stats_reset; /* Set by reflector_reset_stats(), cleared by the worker */
+
+	uint32_t stats_seq CACHE_ALIGNED; /* Seqlock sequence for stats */
+	reflector_stats_t stats;
+} CACHE_ALIGNED worker_ctx_t;
+
+/* Open a stats update (owning worker only) */
+static inline void worker_stats_write_begin(worker_ctx_t *wctx)
+{
+	__atomic_store_n(&wctx->stats_seq, wctx->stats_seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/* Publish a stats update (owning worker only) */
+static inline void worker_stats_write_end(worker_ctx_t *wctx)
+{
+	__atomic_store_n(&wctx->stats_seq, wctx->stats_seq + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Per-worker RX burst size. Fixed mode requests config.batch_size every time.
+ * Adaptive mode starts at ADAPTIVE_BATCH_MIN and doubles whenever a burst
+ * comes back full (the ring is backing up, so amortise per-burst costs), and
+ * halves after ADAPTIVE_SHRINK_AFTER bursts in a row under a quarter full
+ * (light load: keep the first packet of a burst from waiting on the rest).
+ */
+typedef struct {
+	int size;         /* Burst to request from recv_batch */
+	int min;          /* Floor (== max in fixed mode) */
+	int max;          /* Ceiling: config.batch_size */
+	int light_bursts; /* Consecutive bursts under a quarter full */
+} burst_ctl_t;
+
+/* Feed the size of a non-empty burst back into the controller */
+static inline void burst_ctl_update(burst_ctl_t *bc, int rcvd)
+{
+	if (bc->min == bc->max) {
+		return;
+	}
+	if (rcvd >= bc->size) {
+		bc->size = bc->size * 2 < bc->max ? bc->size * 2 : bc->max;
+		bc->light_bursts = 0;
+	} else if (rcvd * 4 <= bc->size) {
+		if (++bc->light_bursts >= ADAPTIVE_SHRINK_AFTER) {
+			bc->size = bc->size / 2 > bc->min ? bc->size / 2 : bc->min;
+			bc->light_bursts = 0;
+		}
+	} else {
+		bc->light_bursts = 0;
+	}
+}
+
+/* One worker's entry in a published snapshot */
+typedef struct {
+	int worker_id;
+	int queue_id;
+	int cpu_id;
+	int numa_node;
+	reflector_stats_t stats; /* Worker's own counters (no backend-held counts) */
+} worker_snapshot_t;
+
+/*
+ * Stats snapshot published by the dataplane every snapshot_interval_ms
+ * (see reflector_read_snapshot). Consumers that poll often, such as metrics
+ * scrapers, read this copy instead of the workers' stats lines.
+ */
+typedef struct {
+	uint64_t generation;   /* Bumped on every publish (0 = never published) */
+	uint64_t timestamp_ns; /* CLOCK_REALTIME at publish */
+	char platform[32];     /* Backend name, e.g. "Linux AF_XDP" */
+	int num_workers;
+	reflector_stats_t total; /* Same as reflector_get_stats() at publish time */
+	worker_snapshot_t workers[MAX_WORKERS];
+} reflector_snapshot_t;
+
+/*
+ * Shared-memory stats segment
+ *
+ * With config.stats_shm set, every snapshot publish is mirrored into the POSIX
+ * shared-memory object REFLECTOR_SHM_PREFIX<ifname> (/dev/shm/reflector-eth0
+ * on Linux). Monitoring tools map it read-only and read counters with plain
+ * loads: no syscalls, IPC or locks in the reflector. Each record sits on its
+ * own cache lines behind its own seqlock (see reflector_shm_read_record).
+ * Readers must check magic, version and the size fields before trusting the
+ * layout, since reflector_stats_t is embedded as is.
+ */
+#define REFLECTOR_SHM_MAGIC 0x52464c53u /* "RFLS" */
+#define REFLECTOR_SHM_VERSION 1
+#define REFLECTOR_SHM_PREFIX "/reflector-"
+#define REFLECTOR_SHM_DEFAULT_INTERVAL_MS 100 /* Publish period when only stats_shm is set */
+
+typedef struct {
+	uint32_t seq;          /* Seqlock: odd while the publisher is writing */
+	int32_t worker_id;     /* -1 in the total record */
+	int32_t queue_id;
+	int32_t cpu_id;
+	uint64_t timestamp_ns; /* CLOCK_REALTIME of the snapshot this came from */
+	reflector_stats_t stats;
+} CACHE_ALIGNED reflector_shm_record_t;
+
+typedef struct {
+	uint32_t magic;        /* REFLECTOR_SHM_MAGIC once the segment is initialized */
+	uint32_t version;      /* REFLECTOR_SHM_VERSION */
+	uint32_t header_size;  /* sizeof(reflector_shm_header_t) */
+	uint32_t record_size;  /* sizeof(reflector_shm_record_t) */
+	uint32_t stats_size;   /* sizeof(reflector_stats_t) */
+	uint32_t max_workers;  /* Entries in reflector_shm_t.workers */
+	uint32_t num_workers;  /* Entries in use */
+	uint32_t interval_ms;  /* Publish period */
+	uint32_t running;      /* 0 once the reflector has stopped */
+	int32_t pid;           /* Publishing process */
+	uint64_t generation;   /* Snapshot generation of the last publish */
+	char ifname[MAX_IFNAME_LEN];
+	char platform[32];
+} CACHE_ALIGNED reflector_shm_header_t;
+
+typedef struct {
+	reflector_shm_header_t header;
+	reflector_shm_record_t total; /* Same as reflector_snapshot_t.total */
+	reflector_shm_record_t workers[MAX_WORKERS];
+} reflector_shm_t;
+
+/* Copy one record consistently from a mapped segment (readers, lock-free) */
+static inline void reflector_shm_read_record(const reflector_shm_record_t *rec,
+                                             reflector_shm_record_t *out)
+{
+	uint32_t seq_begin, seq_end;
+	do {
+		seq_begin = __atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE);
+		memcpy(out, rec, sizeof(*out));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		seq_end = __atomic_load_n(&rec->seq, __ATOMIC_RELAXED);
+	} while ((seq_begin & 1) || seq_begin != seq_end);
+}
 
 /* Reflector context */
 typedef struct {
@@ -340,6 +633,21 @@ typedef struct {
 	reflector_stats_t global_stats;
 	volatile bool running;
 	int num_workers;
+
+	/* Periodic stats snapshot (NULL unless config.snapshot_interval_ms > 0) */
+	reflector_snapshot_t *snapshot;         /* Published copy, guarded by snapshot_seq */
+	reflector_snapshot_t *snapshot_staging; /* Publisher's scratch copy */
+	uint32_t snapshot_seq;                  /* Seqlock: odd while publishing */
+	bool snapshot_publishing;               /* Guards snapshot_staging */
+	volatile bool snapshot_running;
+#ifdef __APPLE__
+	dispatch_source_t snapshot_timer;
+	dispatch_queue_t snapshot_queue;
+#else
+	pthread_t snapshot_tid;
+#endif
+	reflector_shm_t *shm; /* Mapped stats segment (NULL unless config.stats_shm) */
+	char shm_name[sizeof(REFLECTOR_SHM_PREFIX) + MAX_IFNAME_LEN];
 } reflector_ctx_t;
 
 /* Platform abstraction interface */
@@ -355,14 +663,65 @@ typedef struct {
 	/* Receive a batch of packets */
 	int (*recv_batch)(worker_ctx_t *wctx, packet_t *pkts, int max_pkts);
 
-	/* Send a batch of packets */
+	/*
+	 * Send a batch of packets. Takes ownership of all num_pkts buffers:
+	 * returns how many were accepted for transmission (sent now or queued
+	 * by the backend and sent later); the rest were dropped and their
+	 * buffers already recycled. Negative = none accepted, all recycled.
+	 * Accepted packets must end up first in pkts (a backend that skips one
+	 * moves the rest forward). The caller must not release_batch()
+	 * anything passed here.
+	 */
 	int (*send_batch)(worker_ctx_t *wctx, packet_t *pkts, int num_pkts);
 
-	/* Return packets to fill queue (for platforms that need it) */
+	/* Return received packets that will not be sent (for platforms that need it) */
 	void (*release_batch)(worker_ctx_t *wctx, packet_t *pkts, int num_pkts);
 
+	/* Add counters the worker loop never sees, e.g. XDP_TX (optional) */
+	void (*get_stats)(const worker_ctx_t *wctx, reflector_stats_t *stats);
+
+	/* Clear backend-held counters (optional) */
+	void (*reset_stats)(worker_ctx_t *wctx);
+
+	/*
+	 * Sleep until RX is likely ready or timeout_ms passes (optional). Called
+	 * once the worker has seen idle_spin_polls empty polls in a row. Returns
+	 * >0 if ready, 0 on timeout, negative errno on error. Backends whose
+	 * recv_batch already blocks leave this NULL.
+	 */
+	int (*wait_rx)(worker_ctx_t *wctx, int timeout_ms);
+
 } platform_ops_t;
 
+/*
+ * TX backlog for backends with a bounded TX ring (AF_XDP, vnic)
+ *
+ * Frames the ring cannot take yet are queued in FIFO order and resubmitted
+ * ahead of newer ones, so frames leave in the order they were reflected.
+ * Once the backlog is full, tx_backlog_send() reclaims completions and
+ * retries for up to TX_BACKLOG_WAIT_NS, then drops the rest through
+ * ops->drop and counts them in err_tx_backpressure.
+ */
+#define TX_BACKLOG_SIZE (2 * MAX_BATCH_SIZE) /* Power of two */
+#define TX_BACKLOG_MASK (TX_BACKLOG_SIZE - 1)
+#define TX_BACKLOG_WAIT_NS 50000ULL
+
+typedef struct {
+	packet_t pkts[TX_BACKLOG_SIZE];
+	uint32_t head; /* Oldest queued frame */
+	uint32_t count;
+} tx_backlog_t;
+
+/* Backend TX ring callbacks used by the backlog */
+typedef struct {
+	/* Put up to n frames on the TX ring in order; returns how many it took */
+	uint32_t (*submit)(worker_ctx_t *wctx, const packet_t *pkts, uint32_t n);
+	/* Wake the TX path and take back completed frames */
+	void (*reclaim)(worker_ctx_t *wctx);
+	/* Free a frame that will not be sent */
+	void (*drop)(worker_ctx_t *wctx, const packet_t *pkt);
+} tx_ring_ops_t;
+
 /* ========================================================================
  * FUNCTION DECLARATIONS
  * ======================================================================== */
@@ -458,6 +817,23 @@ void reflector_get_stats(const reflector_ctx_t *rctx, reflector_stats_t *stats);
  */
 void reflector_reset_stats(reflector_ctx_t *rctx);
 
+/**
+ * Publish a fresh stats snapshot now (the snapshot thread calls this every
+ * snapshot_interval_ms; reflector_stop() publishes a final one)
+ * @param rctx Reflector context
+ */
+void reflector_publish_snapshot(reflector_ctx_t *rctx);
+
+/**
+ * Copy the most recently published stats snapshot
+ * Lock-free: retries while a publish is in progress and never reads worker
+ * stats, so it is cheap to call at any rate.
+ * @param rctx Reflector context
+ * @param snap Output buffer
+ * @return 0 on success, -EAGAIN if snapshots are disabled or none was published yet
+ */
+int reflector_read_snapshot(const reflector_ctx_t *rctx, reflector_snapshot_t *snap);
+
 /* ------------------------------------------------------------------------
  * Network Interface Utilities
  * ------------------------------------------------------------------------ */
@@ -513,6 +889,13 @@ int get_nic_vendor(const char *ifname, uint16_t *vendor_id, uint16_t *device_id)
  */
 int get_nic_speed(const char *ifname);
 
+/**
+ * Get the NUMA node the NIC's PCI device is attached to (Linux only)
+ * @param ifname Interface name
+ * @return NUMA node, or -1 if unknown or not a NUMA system
+ */
+int get_nic_numa_node(const char *ifname);
+
 /**
  * Print warning when falling back to AF_PACKET mode
  * Explains limitations and how to upgrade to AF_XDP/DPDK
@@ -526,19 +909,190 @@ void print_af_packet_warning(const char *ifname);
 void print_recommended_nics(void);
 
 /**
- * Get CPU affinity for specific queue (best-effort heuristic)
+ * Get CPU affinity for specific queue from its IRQ's smp_affinity_list
+ * Falls back to round-robin when the queue's IRQ cannot be identified.
  * @param ifname Interface name
  * @param queue_id Queue ID to query
  * @return CPU ID, or -1 if unable to determine
  */
 int get_queue_cpu_affinity(const char *ifname, int queue_id);
 
+/**
+ * Parse a CPU list in sysfs/taskset syntax, e.g. "0-3,8,10-11"
+ * @param list CPU list string (trailing whitespace allowed)
+ * @param cpus Output array
+ * @param max_cpus Capacity of cpus
+ * @return Number of CPUs parsed, or -EINVAL if malformed or too long
+ */
+int parse_cpu_list(const char *list, int *cpus, int max_cpus);
+
+/**
+ * Match a /proc/interrupts IRQ name to an interface RX queue
+ * The interface name must appear as a whole token followed by '-' or ':'.
+ * @param name IRQ name (last field of the /proc/interrupts line)
+ * @param ifname Interface name
+ * @param bdf PCI address of the interface (mlx5 names), or NULL
+ * @param queue_id Queue ID
+ * @return true if the IRQ serves that queue
+ */
+bool irq_name_matches_queue(const char *name, const char *ifname, const char *bdf, int queue_id);
+
+/**
+ * Get the NUMA node a CPU belongs to (Linux only)
+ * @param cpu CPU number
+ * @return NUMA node, or -1 if unknown
+ */
+int get_cpu_numa_node(int cpu);
+
+/**
+ * Prefer memory for the calling thread's future allocations on a NUMA node
+ * @param node NUMA node, or -1 to restore the default local policy
+ * @return 0 on success, negative errno on failure
+ */
+int set_thread_numa_node(int node);
+
+/**
+ * Build the worker -> CPU map: explicit worker_cpus, else consecutive CPUs
+ * from cpu_affinity, else automatic placement on the NIC's NUMA node that
+ * follows queue IRQ affinity and honours avoid_smt_siblings/avoid_irq_cpus
+ * @param cfg Configuration
+ * @param nic_node NIC's NUMA node (-1 if unknown)
+ * @param num_workers Number of workers
+ * @param cpus Output: CPU per worker
+ * @return 0 on success, -1 if placement is unsupported (cpus set to -1)
+ */
+int plan_worker_cpus(const reflector_config_t *cfg, int nic_node, int num_workers, int *cpus);
+
+/**
+ * Set up a worker's burst size controller
+ * @param bc Controller to initialize
+ * @param batch_size Configured burst size, clamped to 1..MAX_BATCH_SIZE
+ * @param adaptive Adapt between ADAPTIVE_BATCH_MIN and batch_size
+ */
+void burst_ctl_init(burst_ctl_t *bc, int batch_size, bool adaptive);
+
+/**
+ * Move as much of the TX backlog to the ring as it accepts (oldest first)
+ * @param wctx Worker context
+ * @param bl Worker's backlog
+ * @param ops Backend TX ring
+ * @return Number of frames submitted
+ */
+uint32_t tx_backlog_flush(worker_ctx_t *wctx, tx_backlog_t *bl, const tx_ring_ops_t *ops);
+
+/**
+ * Send a burst behind anything already queued (send_batch() body for ring backends)
+ * Frames the ring cannot take are queued; with the backlog full, waits up to
+ * TX_BACKLOG_WAIT_NS for room, then drops the remainder via ops->drop.
+ * @param wctx Worker context
+ * @param bl Worker's backlog
+ * @param ops Backend TX ring
+ * @param pkts Frames to send (ownership passes to the backend)
+ * @param n Number of frames
+ * @return Frames submitted or queued; the rest were dropped
+ */
+int tx_backlog_send(worker_ctx_t *wctx, tx_backlog_t *bl, const tx_ring_ops_t *ops,
+                    const packet_t *pkts, int n);
+
+/**
+ * Drop every queued frame via ops->drop (backend cleanup)
+ * @param wctx Worker context
+ * @param bl Worker's backlog
+ * @param ops Backend TX ring
+ * @return Number of frames dropped
+ */
+uint32_t tx_backlog_drop_all(worker_ctx_t *wctx, tx_backlog_t *bl, const tx_ring_ops_t *ops);
+
 /**
  * Get high-resolution monotonic timestamp in nanoseconds
  * @return Timestamp in nanoseconds, or 0 on error
  */
 uint64_t get_timestamp_ns(void);
 
+/**
+ * Calibrate the fast latency clock (invariant TSC on x86-64, CNTVCT on
+ * aarch64) against CLOCK_MONOTONIC. Called from reflector_init(); safe to call
+ * again. Without a usable counter fast_clock_ns() falls back to clock_gettime.
+ * @return 0 on success, negative errno if the fallback is in use
+ */
+int fast_clock_init(void);
+
+/**
+ * Read the fast clock
+ * @return Nanoseconds in the CLOCK_MONOTONIC epoch
+ */
+uint64_t fast_clock_ns(void);
+
+/**
+ * Re-measure the CLOCK_REALTIME offset used by fast_clock_from_realtime().
+ * Call periodically (outside the per-packet path) to absorb NTP steps.
+ */
+void fast_clock_resync(void);
+
+/**
+ * Convert a CLOCK_REALTIME-domain timestamp (kernel or PHC-synced NIC stamp)
+ * to the fast clock domain
+ * @param realtime_ns Timestamp in nanoseconds since the epoch
+ * @return Equivalent fast_clock_ns() value
+ */
+uint64_t fast_clock_from_realtime(uint64_t realtime_ns);
+
+/**
+ * Name of the active fast clock source ("tsc", "cntvct" or "clock_gettime")
+ * @return Static string
+ */
+const char *fast_clock_source(void);
+
+/*
+ * NIC PTP hardware clock (PHC), for raw hardware RX stamps without phc2sys.
+ * The PHC - fast clock offset is measured when the clock is opened and again
+ * whenever a stamp is PHC_RESYNC_NS past the last measurement, so PHC drift
+ * against the host clock stays bounded.
+ */
+#define PHC_RESYNC_NS 100000000ULL /* 100 ms */
+
+typedef struct {
+	bool active;            /* Opened; otherwise stamps are taken as CLOCK_REALTIME */
+	int fd;                 /* /dev/ptpN */
+	int64_t offset_ns;      /* PHC - fast clock */
+	uint64_t synced_phc_ns; /* PHC time of the last offset measurement */
+} phc_clock_t;
+
+/**
+ * Open the PHC behind an interface (ETHTOOL_GET_TS_INFO) and measure its offset
+ * @param phc Clock to fill in (inactive on failure)
+ * @param ifname Interface name
+ * @return 0 on success, negative errno (-ENODEV: the NIC has no PHC)
+ */
+int phc_clock_open(phc_clock_t *phc, const char *ifname);
+
+/**
+ * Close a PHC opened with phc_clock_open() (no-op when inactive)
+ * @param phc Clock
+ */
+void phc_clock_close(phc_clock_t *phc);
+
+/**
+ * Re-measure the PHC - fast clock offset (best of a few sandwiched reads)
+ * @param phc Active clock
+ */
+void phc_clock_resync(phc_clock_t *phc);
+
+/**
+ * Convert a PHC timestamp to the fast_clock_ns() domain, re-measuring the
+ * offset first once it is PHC_RESYNC_NS old
+ * @param phc Active clock
+ * @param phc_ns PHC timestamp in nanoseconds
+ * @return Equivalent fast_clock_ns() value
+ */
+static inline uint64_t phc_clock_to_fast(phc_clock_t *phc, uint64_t phc_ns)
+{
+	if (unlikely((int64_t)(phc_ns - phc->synced_phc_ns) > (int64_t)PHC_RESYNC_NS)) {
+		phc_clock_resync(phc);
+	}
+	return phc_ns - (uint64_t)phc->offset_ns;
+}
+
 /**
  * Drop unnecessary privileges after initialization
  * On Linux: Drops to 'nobody' user if running as root
@@ -573,6 +1127,112 @@ bool is_ito_packet(const uint8_t *data, uint32_t len, const reflector_config_t *
 bool is_ito_packet_extended(const uint8_t *data, uint32_t len, const reflector_config_t *config,
                             bool *is_ipv6, bool *is_vlan);
 
+/**
+ * Single-pass classification: Ethernet -> VLAN/QinQ -> IPv4/IPv6 -> UDP
+ * Applies the same MAC/OUI/port/signature filters as is_ito_packet() and
+ * honours enable_vlan/enable_ipv6.
+ * @param data Packet data buffer
+ * @param len Packet length in bytes
+ * @param config Reflector config
+ * @param hdrs Output: header offsets (valid only when a signature matched)
+ * @return Matched signature type, or SIG_TYPE_UNKNOWN if not reflectable
+ */
+sig_type_t classify_packet(const uint8_t *data, uint32_t len, const reflector_config_t *config,
+                           pkt_hdrs_t *hdrs);
+
+/* Number of uint64_t words in a classify_batch() accept mask for n packets */
+#define CLASSIFY_MASK_WORDS(n) (((n) + 63) / 64)
+
+/**
+ * Classify a whole RX burst (SIMD fast path for untagged IPv4)
+ * Results match classify_packet() for every packet. Only ahead of the
+ * per-packet paths on untagged-IPv4-only traffic; the worker loop uses the
+ * fused kernels (classify_reflect_select()).
+ * @param pkts Received packets
+ * @param n Number of packets
+ * @param config Reflector config
+ * @param out_mask Output: bit i set if pkts[i] accepted (CLASSIFY_MASK_WORDS(n) words)
+ * @param out_sig Output: signature type per packet (SIG_TYPE_UNKNOWN if rejected)
+ * @param out_hdrs Output: header offsets per packet (may be NULL)
+ * @return Number of accepted packets
+ */
+int classify_batch(const packet_t *pkts, int n, const reflector_config_t *config,
+                   uint64_t *out_mask, sig_type_t *out_sig, pkt_hdrs_t *out_hdrs);
+
+/**
+ * Reflect packet using offsets from classify_packet() (no re-parse)
+ * @param data Packet data buffer (will be modified)
+ * @param len Packet length in bytes
+ * @param hdrs Header offsets from classify_packet()
+ * @param mode Reflection mode (MAC, MAC+IP, or ALL)
+ * @param software_checksum Whether to recalculate checksums in software
+ */
+void reflect_packet_hdrs(uint8_t *data, uint32_t len, const pkt_hdrs_t *hdrs, reflect_mode_t mode,
+                         bool software_checksum);
+
+/* Fused validate + classify + reflect kernel (see classify_reflect_select()) */
+typedef sig_type_t (*classify_reflect_fn_t)(uint8_t *data, uint32_t len,
+                                            const reflector_config_t *config);
+
+/**
+ * Select the fused kernel specialised for a reflection mode and checksum setting
+ * Resolve once per worker and call per packet; config->reflect_mode and
+ * config->software_checksum are ignored by the returned kernel.
+ * @param mode Reflection mode (MAC, MAC+IP, or ALL)
+ * @param software_checksum Whether the kernel recalculates checksums in software
+ * @return Kernel that classifies like classify_packet() and reflects accepted packets in place
+ */
+classify_reflect_fn_t classify_reflect_select(reflect_mode_t mode, bool software_checksum);
+
+/**
+ * Classify and, if accepted, reflect a packet in one pass
+ * Equivalent to is_ito_packet_extended() + get_ito_signature_type() +
+ * reflect_packet_with_mode() with a single header parse.
+ * @param data Packet data buffer (modified only if accepted)
+ * @param len Packet length in bytes
+ * @param config Reflector config (filters, reflect_mode, software_checksum)
+ * @return Matched signature type, or SIG_TYPE_UNKNOWN if not reflected
+ */
+sig_type_t classify_and_reflect(uint8_t *data, uint32_t len, const reflector_config_t *config);
+
+/* ------------------------------------------------------------------------
+ * Checksum Helpers
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Add a buffer to an Internet (ones' complement) checksum sum
+ * Vectorised (AVX2/SSE2 on x86-64, NEON on ARM64). An odd trailing byte is
+ * padded with zero.
+ * @param data Buffer (any alignment)
+ * @param len Length in bytes
+ * @param sum Running sum of host-order 16-bit words (0 to start)
+ * @return Updated sum folded to 16 bits (not complemented)
+ */
+uint32_t checksum_partial(const uint8_t *data, uint32_t len, uint32_t sum);
+
+/**
+ * Incrementally update a checksum after rewriting bytes (RFC 1624 eqn. 3)
+ * O(len) in the rewritten bytes only; the rest of the packet is not read.
+ * Note that an IPv4 UDP checksum of 0 ("none") must not be adjusted.
+ * @param check Current checksum field value (network byte order)
+ * @param old_data Bytes before the rewrite
+ * @param new_data Bytes after the rewrite (same 16-bit alignment, even len)
+ * @param len Number of rewritten bytes
+ * @return New checksum field value (network byte order)
+ */
+uint16_t checksum_adjust(uint16_t check, const uint8_t *old_data, const uint8_t *new_data,
+                         uint32_t len);
+
+/**
+ * Recompute IPv4 header and UDP checksums from scratch
+ * Reflection itself never needs this (swaps are checksum-neutral); use it
+ * after rewriting large parts of the payload.
+ * @param data Packet data buffer (will be modified)
+ * @param len Packet length in bytes
+ * @param hdrs Header offsets from classify_packet()
+ */
+void packet_recompute_checksums(uint8_t *data, uint32_t len, const pkt_hdrs_t *hdrs);
+
 /**
  * Get ITO signature type from validated packet
  * @param data Packet data buffer (must be validated first)
@@ -651,6 +1311,37 @@ void update_signature_stats(reflector_stats_t *stats, ito_sig_type_t sig_type);
  */
 void update_latency_stats(latency_stats_t *latency, uint64_t latency_ns);
 
+/**
+ * Histogram bucket a latency sample falls into
+ * @param latency_ns Latency measurement in nanoseconds
+ * @return Index into latency_hist_t.buckets (< LATENCY_HIST_BUCKETS)
+ */
+uint32_t latency_hist_index(uint64_t latency_ns);
+
+/**
+ * Record a latency sample in a histogram
+ * Lock-free for a single writer: one relaxed load/store, no atomic RMW, so
+ * concurrent readers see a consistent (possibly slightly stale) count.
+ * @param hist Histogram owned by the calling worker
+ * @param latency_ns Latency measurement in nanoseconds
+ */
+void latency_hist_record(latency_hist_t *hist, uint64_t latency_ns);
+
+/**
+ * Add src histogram into dst (relaxed loads from src, safe while src is live)
+ * @param dst Destination histogram
+ * @param src Source histogram
+ */
+void latency_hist_merge(latency_hist_t *dst, const latency_hist_t *src);
+
+/**
+ * Get value at a percentile
+ * @param hist Histogram
+ * @param percentile Percentile in (0, 100], e.g. 99.9
+ * @return Highest value in the bucket holding the percentile (ns), 0 if empty
+ */
+uint64_t latency_hist_percentile(const latency_hist_t *hist, double percentile);
+
 /**
  * Update error statistics by category
  * @param stats Statistics structure to update
@@ -677,9 +1368,63 @@ void reflector_print_stats_json(const reflector_stats_t *stats);
  */
 void reflector_print_stats_csv(const reflector_stats_t *stats);
 
+/**
+ * Short lower-case name of a hot-path profile phase (e.g. "classify")
+ * @param phase Phase
+ * @return Static string
+ */
+const char *prof_phase_name(prof_phase_t phase);
+
 /* Platform detection */
 const platform_ops_t *get_platform_ops(void);
 
+/*
+ * Virtual NIC: in-memory backend selected with the interface name "vnic"
+ * (see vnic_platform.c). No hardware or privileges needed, for end-to-end
+ * tests and benchmarks of the worker loop.
+ */
+#define VNIC_IFNAME "vnic"
+#define VNIC_MAC_ADDR {0x02, 0x76, 0x6e, 0x69, 0x63, 0x00} /* Locally administered */
+
+typedef struct {
+	uint64_t rx_frames;    /* Frames handed to the core */
+	uint64_t tx_frames;    /* Frames transmitted (completed by the TX ring, if any) */
+	uint64_t tx_bytes;     /* Bytes transmitted */
+	uint64_t tx_dropped;   /* Frames the TX path freed unsent (backlog overflow, stall) */
+	uint64_t tx_reordered; /* Frames transmitted after one received later */
+	uint64_t released;     /* Frames returned through release_batch */
+	uint64_t bad_returns;  /* Sent/released frames the core did not own (double return) */
+	uint64_t leaked;       /* Frames never returned by the time the worker stopped */
+} vnic_stats_t;
+
+/**
+ * Check whether an interface name selects the virtual NIC
+ * @param ifname Interface name
+ * @return true for VNIC_IFNAME
+ */
+bool is_vnic_ifname(const char *ifname);
+
+/**
+ * Get virtual NIC counters summed over every worker cleaned up so far
+ * (workers add theirs in reflector_stop)
+ * @param totals Output counters
+ */
+void vnic_get_totals(vnic_stats_t *totals);
+
+/**
+ * Reset the virtual NIC totals before a new run
+ */
+void vnic_reset_totals(void);
+
+/**
+ * Let a running virtual NIC worker receive more frames once its
+ * vnic_rx_count budget is used up (safe from any thread; an idle worker
+ * picks them up within one poll_timeout_ms)
+ * @param wctx Worker on the virtual NIC
+ * @param frames Frames to add
+ */
+void vnic_add_rx_frames(worker_ctx_t *wctx, uint64_t frames);
+
 /* Logging */
 typedef enum { LOG_DEBUG, LOG_INFO, LOG_WARN, LOG_ERROR } log_level_t;
 
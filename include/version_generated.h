@@ -0,0 +1,35 @@
+/*
+ * version_generated.h - Auto-generated version information
+ * DO NOT EDIT - Generated by scripts/gen-version.sh
+ * 
+ * Version extracted from git tags at build time.
+ * Git is the single source of truth for version numbers.
+ */
+
+#ifndef VERSION_GENERATED_H
+#define VERSION_GENERATED_H
+
+/* Version from git tag */
+#define REFLECTOR_VERSION_MAJOR 0
+#define REFLECTOR_VERSION_MINOR 0
+#define REFLECTOR_VERSION_PATCH 0
+#define REFLECTOR_VERSION_EXTRA "-dev-689a98f"
+
+/* Full version string */
+#define REFLECTOR_VERSION_STRING "689a98f"
+
+/* Git metadata */
+#define REFLECTOR_GIT_HASH "689a98f"
+#define REFLECTOR_GIT_DATE "2026-10-16"
+
+/* Build information */
+#define REFLECTOR_BUILD_DATE __DATE__
+#define REFLECTOR_BUILD_TIME __TIME__
+
+/* Helper macro to create version integer */
+#define REFLECTOR_VERSION_CODE(major, minor, patch)     (((major) << 16) | ((minor) << 8) | (patch))
+
+/* Current version as integer for comparisons */
+#define REFLECTOR_VERSION_NUMBER     REFLECTOR_VERSION_CODE(REFLECTOR_VERSION_MAJOR,                           REFLECTOR_VERSION_MINOR,                           REFLECTOR_VERSION_PATCH)
+
+#endif /* VERSION_GENERATED_H */
@@ -0,0 +1,63 @@
+/*
+ * xdp_maps.h - Map value layouts shared by filter.bpf.c and the AF_XDP backend
+ *
+ * Copyright (c) 2025 Kris Armstrong
+ *
+ * Only kernel UAPI types are used here so the header can be included both
+ * from the eBPF program (clang -target bpf) and from userspace.
+ */
+
+#ifndef XDP_MAPS_H
+#define XDP_MAPS_H
+
+#include <linux/types.h>
+
+/* config_map flags */
+#define XDP_CFG_TX_REFLECT (1u << 0)    /* Reflect in-kernel and return XDP_TX */
+#define XDP_CFG_FILTER_DST_MAC (1u << 1) /* Require dst MAC == mac_map entry */
+#define XDP_CFG_FILTER_OUI (1u << 2)    /* Require src MAC OUI == oui */
+#define XDP_CFG_VLAN (1u << 3)          /* Accept 802.1Q / QinQ tagged frames */
+#define XDP_CFG_IPV6 (1u << 4)          /* Accept IPv6 */
+
+/* Upper bound on signature types tracked in xdp_stats.sig_tx (>= SIG_TYPE_COUNT) */
+#define XDP_SIG_TYPE_MAX 8
+
+/* Single-entry config_map value, written by userspace before attach */
+struct xdp_reflect_config {
+	__u32 flags;        /* XDP_CFG_* */
+	__u32 reflect_mode; /* reflect_mode_t: 0=MAC, 1=MAC+IP, 2=ALL */
+	__u16 ito_port;     /* Required UDP dst port, host order (0 = any) */
+	__u8 oui[3];        /* Required source OUI when XDP_CFG_FILTER_OUI */
+	__u8 pad[3];
+};
+
+/*
+ * Written in the metadata area directly in front of each frame redirected by
+ * xdp_filter_ito_rxts, so the AF_XDP backend finds it at data - sizeof().
+ */
+#define XDP_META_RX_TIMESTAMP (1u << 0) /* rx_timestamp holds the NIC RX time */
+
+struct xdp_rx_meta {
+	__u64 rx_timestamp; /* bpf_xdp_metadata_rx_timestamp() (ns, PHC clock) */
+	__u32 flags;        /* XDP_META_* */
+	__u32 pad;
+};
+
+/* sig_map value: where the 7-byte key must appear and what it counts as */
+struct xdp_sig_value {
+	__u32 sig_type;       /* sig_type_t */
+	__u32 payload_offset; /* Offset in UDP payload (5 = ITO, 0 = RFC2544/Y.1564) */
+};
+
+/* Per-CPU stats_map value */
+struct xdp_stats {
+	__u64 packets_total;
+	__u64 packets_ito;
+	__u64 packets_passed;
+	__u64 packets_dropped;
+	__u64 packets_tx;               /* Reflected in-kernel via XDP_TX */
+	__u64 bytes_tx;                 /* Bytes reflected via XDP_TX */
+	__u64 sig_tx[XDP_SIG_TYPE_MAX]; /* XDP_TX reflections by sig_type */
+};
+
+#endif /* XDP_MAPS_H */
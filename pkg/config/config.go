@@ -55,8 +55,9 @@ type PlatformConfig struct {
 
 // StatsConfig holds statistics settings
 type StatsConfig struct {
-	Format   string `yaml:"format"`   // text, json, csv
-	Interval int    `yaml:"interval"` // seconds
+	Format     string `yaml:"format"`      // text, json, csv
+	Interval   int    `yaml:"interval"`    // seconds
+	SnapshotMs int    `yaml:"snapshot_ms"` // Dataplane snapshot period (-1 = off)
 }
 
 // LoadFile loads configuration from a YAML file
@@ -97,6 +98,9 @@ func (c *Config) applyDefaults() {
 	if c.Stats.Interval == 0 {
 		c.Stats.Interval = 10
 	}
+	if c.Stats.SnapshotMs == 0 {
+		c.Stats.SnapshotMs = 1000
+	}
 	// TUI enabled by default
 	if !c.TUI.Enabled && c.Interface != "" {
 		c.TUI.Enabled = true
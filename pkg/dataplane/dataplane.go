@@ -24,7 +24,8 @@ static reflector_config_t make_config(
     uint8_t oui0, uint8_t oui1, uint8_t oui2,
     int reflect_mode,
     int use_dpdk,
-    const char *dpdk_args
+    const char *dpdk_args,
+    int snapshot_ms
 ) {
     reflector_config_t config = {0};
     config.ito_port = ito_port;
@@ -33,6 +34,7 @@ static reflector_config_t make_config(
     config.oui[1] = oui1;
     config.oui[2] = oui2;
     config.reflect_mode = (reflect_mode_t)reflect_mode;
+    config.snapshot_interval_ms = snapshot_ms;
 #if HAVE_DPDK
     config.use_dpdk = use_dpdk ? true : false;
     config.dpdk_args = (char *)dpdk_args;
@@ -45,6 +47,7 @@ import "C"
 import (
 	"fmt"
 	"sync"
+	"time"
 	"unsafe"
 
 	"github.com/krisarmstrong/reflector-native/pkg/config"
@@ -64,9 +67,57 @@ type Stats struct {
 	LatencyMin       float64
 	LatencyAvg       float64
 	LatencyMax       float64
+	LatencyP50       float64
+	LatencyP99       float64
+	LatencyP999      float64
+	LatencyP9999     float64
 	LatencyCount     uint64
 }
 
+// Counters holds the monotonic counters of one worker or of the whole dataplane
+type Counters struct {
+	PacketsReceived  uint64
+	PacketsReflected uint64
+	BytesReceived    uint64
+	BytesReflected   uint64
+	PollTimeouts     uint64
+	TxBackpressure   uint64            // TX drops after the backlog wait (part of tx_failed)
+	Signatures       map[string]uint64 // probeot, dataot, latency, rfc2544, y1564
+	Errors           map[string]uint64 // invalid_mac, ..., tx_failed, nomem
+}
+
+// WorkerStats is one worker's entry in a Snapshot
+type WorkerStats struct {
+	WorkerID int
+	QueueID  int
+	CPUID    int
+	NUMANode int
+	Counters
+}
+
+// XDPStats holds the in-kernel XDP program counters (AF_XDP only)
+type XDPStats struct {
+	Valid          bool
+	PacketsTotal   uint64
+	PacketsITO     uint64
+	PacketsPassed  uint64
+	PacketsDropped uint64
+	PacketsTX      uint64
+	BytesTX        uint64
+}
+
+// Snapshot is a copy of the stats snapshot published by the C dataplane
+type Snapshot struct {
+	Generation   uint64
+	Timestamp    time.Time
+	Platform     string
+	Total        Counters
+	Workers      []WorkerStats
+	XDP          XDPStats
+	Latency      Stats // Latency fields only (microseconds)
+	LatencySumNs uint64
+}
+
 // Dataplane wraps the C reflector context
 type Dataplane struct {
 	ctx      C.reflector_ctx_t
@@ -74,6 +125,9 @@ type Dataplane struct {
 	running  bool
 	mu       sync.RWMutex
 	dpdkArgs *C.char // Store to prevent dangling pointer
+
+	snapMu  sync.Mutex
+	snapBuf *C.reflector_snapshot_t // Reused copy target (~128 KB), guarded by snapMu
 }
 
 // New creates a new dataplane instance
@@ -108,6 +162,12 @@ func New(cfg *config.Config) (*Dataplane, error) {
 		useDPDK = 1
 	}
 
+	// Snapshot publishing feeds /metrics and GetStats; negative disables it
+	snapshotMs := cfg.Stats.SnapshotMs
+	if snapshotMs < 0 {
+		snapshotMs = 0
+	}
+
 	cConfig := C.make_config(
 		ifname,
 		C.uint16_t(cfg.Filtering.Port),
@@ -116,6 +176,7 @@ func New(cfg *config.Config) (*Dataplane, error) {
 		C.int(cfg.ReflectModeInt()),
 		C.int(useDPDK),
 		dpdkArgs,
+		C.int(snapshotMs),
 	)
 
 	// Initialize reflector
@@ -173,8 +234,115 @@ func (dp *Dataplane) Close() {
 // GetStats returns current statistics
 func (dp *Dataplane) GetStats() Stats {
 	var cStats C.reflector_stats_t
-	C.reflector_get_stats(&dp.ctx, &cStats)
 
+	dp.mu.RLock()
+	live := dp.ctx.workers != nil
+	if live {
+		C.reflector_get_stats(&dp.ctx, &cStats)
+	}
+	dp.mu.RUnlock()
+
+	// No workers (not started or stopped): fall back to the last published snapshot
+	if !live {
+		dp.snapMu.Lock()
+		if snap := dp.readSnapshot(); snap != nil {
+			cStats = snap.total
+		}
+		dp.snapMu.Unlock()
+	}
+
+	return statsFromC(&cStats)
+}
+
+// Snapshot returns the most recently published stats snapshot. It returns
+// false when publishing is disabled (stats.snapshot_ms = 0) or nothing has
+// been published yet.
+func (dp *Dataplane) Snapshot() (Snapshot, bool) {
+	dp.snapMu.Lock()
+	defer dp.snapMu.Unlock()
+
+	snap := dp.readSnapshot()
+	if snap == nil {
+		return Snapshot{}, false
+	}
+
+	out := Snapshot{
+		Generation:   uint64(snap.generation),
+		Timestamp:    time.Unix(0, int64(snap.timestamp_ns)),
+		Platform:     C.GoString(&snap.platform[0]),
+		Total:        countersFromC(&snap.total),
+		Latency:      statsFromC(&snap.total),
+		LatencySumNs: uint64(snap.total.latency.total_ns),
+		XDP: XDPStats{
+			Valid:          bool(snap.total.xdp.valid),
+			PacketsTotal:   uint64(snap.total.xdp.packets_total),
+			PacketsITO:     uint64(snap.total.xdp.packets_ito),
+			PacketsPassed:  uint64(snap.total.xdp.packets_passed),
+			PacketsDropped: uint64(snap.total.xdp.packets_dropped),
+			PacketsTX:      uint64(snap.total.xdp.packets_tx),
+			BytesTX:        uint64(snap.total.xdp.bytes_tx),
+		},
+	}
+
+	n := int(snap.num_workers)
+	if n > len(snap.workers) {
+		n = len(snap.workers)
+	}
+	out.Workers = make([]WorkerStats, n)
+	for i := 0; i < n; i++ {
+		w := &snap.workers[i]
+		out.Workers[i] = WorkerStats{
+			WorkerID: int(w.worker_id),
+			QueueID:  int(w.queue_id),
+			CPUID:    int(w.cpu_id),
+			NUMANode: int(w.numa_node),
+			Counters: countersFromC(&w.stats),
+		}
+	}
+
+	return out, true
+}
+
+// readSnapshot copies the published snapshot into dp.snapBuf, or returns nil
+// if there is none. The caller holds snapMu until it is done with the result.
+func (dp *Dataplane) readSnapshot() *C.reflector_snapshot_t {
+	if dp.snapBuf == nil {
+		dp.snapBuf = new(C.reflector_snapshot_t)
+	}
+	if C.reflector_read_snapshot(&dp.ctx, dp.snapBuf) < 0 {
+		return nil
+	}
+	return dp.snapBuf
+}
+
+func countersFromC(s *C.reflector_stats_t) Counters {
+	return Counters{
+		PacketsReceived:  uint64(s.packets_received),
+		PacketsReflected: uint64(s.packets_reflected),
+		BytesReceived:    uint64(s.bytes_received),
+		BytesReflected:   uint64(s.bytes_reflected),
+		PollTimeouts:     uint64(s.poll_timeout),
+		TxBackpressure:   uint64(s.err_tx_backpressure),
+		Signatures: map[string]uint64{
+			"probeot": uint64(s.sig_probeot_count),
+			"dataot":  uint64(s.sig_dataot_count),
+			"latency": uint64(s.sig_latency_count),
+			"rfc2544": uint64(s.sig_rfc2544_count),
+			"y1564":   uint64(s.sig_y1564_count),
+		},
+		Errors: map[string]uint64{
+			"invalid_mac":       uint64(s.err_invalid_mac),
+			"invalid_ethertype": uint64(s.err_invalid_ethertype),
+			"invalid_protocol":  uint64(s.err_invalid_protocol),
+			"invalid_signature": uint64(s.err_invalid_signature),
+			"too_short":         uint64(s.err_too_short),
+			"tx_failed":         uint64(s.err_tx_failed),
+			"nomem":             uint64(s.err_nomem),
+		},
+	}
+}
+
+func statsFromC(cStats *C.reflector_stats_t) Stats {
 	return Stats{
 		PacketsReceived:  uint64(cStats.packets_received),
 		PacketsReflected: uint64(cStats.packets_reflected),
@@ -188,6 +356,10 @@ func (dp *Dataplane) GetStats() Stats {
 		LatencyMin:       float64(cStats.latency.min_ns) / 1000.0,
 		LatencyAvg:       float64(cStats.latency.avg_ns) / 1000.0,
 		LatencyMax:       float64(cStats.latency.max_ns) / 1000.0,
+		LatencyP50:       float64(cStats.latency.p50_ns) / 1000.0,
+		LatencyP99:       float64(cStats.latency.p99_ns) / 1000.0,
+		LatencyP999:      float64(cStats.latency.p999_ns) / 1000.0,
+		LatencyP9999:     float64(cStats.latency.p9999_ns) / 1000.0,
 		LatencyCount:     uint64(cStats.latency.count),
 	}
 }
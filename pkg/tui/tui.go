@@ -176,12 +176,20 @@ func (a *App) updateStats() {
 	latText := ""
 	if stats.LatencyCount > 0 {
 		latText = fmt.Sprintf(
-			"[magenta]Min:[white]   %.2f µs\n"+
-				"[magenta]Avg:[white]   %.2f µs\n"+
-				"[magenta]Max:[white]   %.2f µs\n"+
-				"[magenta]Count:[white] %s",
+			"[magenta]Min:[white]    %.2f µs\n"+
+				"[magenta]Avg:[white]    %.2f µs\n"+
+				"[magenta]p50:[white]    %.2f µs\n"+
+				"[magenta]p99:[white]    %.2f µs\n"+
+				"[magenta]p99.9:[white]  %.2f µs\n"+
+				"[magenta]p99.99:[white] %.2f µs\n"+
+				"[magenta]Max:[white]    %.2f µs\n"+
+				"[magenta]Count:[white]  %s",
 			stats.LatencyMin,
 			stats.LatencyAvg,
+			stats.LatencyP50,
+			stats.LatencyP99,
+			stats.LatencyP999,
+			stats.LatencyP9999,
 			stats.LatencyMax,
 			formatNumber(stats.LatencyCount),
 		)
@@ -0,0 +1,190 @@
+/*
+ * metrics.go - Prometheus /metrics endpoint
+ *
+ * Renders the dataplane's published stats snapshot in the Prometheus text
+ * exposition format (0.0.4). Scrapes only copy the snapshot, so they never
+ * touch the workers' stats lines however often they arrive.
+ */
+
+package web
+
+import (
+	"bufio"
+	"fmt"
+	"net/http"
+	"sort"
+	"strconv"
+	"strings"
+	"time"
+
+	"github.com/krisarmstrong/reflector-native/pkg/dataplane"
+)
+
+// metricsWriter emits HELP/TYPE headers once per family, then samples
+type metricsWriter struct {
+	w *bufio.Writer
+}
+
+func (m *metricsWriter) family(name, typ, help string) {
+	fmt.Fprintf(m.w, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, typ)
+}
+
+func (m *metricsWriter) sample(name string, labels []string, value float64) {
+	m.w.WriteString(name)
+	if len(labels) > 0 {
+		m.w.WriteByte('{')
+		for i := 0; i+1 < len(labels); i += 2 {
+			if i > 0 {
+				m.w.WriteByte(',')
+			}
+			m.w.WriteString(labels[i])
+			m.w.WriteString(`="`)
+			m.w.WriteString(escapeLabel(labels[i+1]))
+			m.w.WriteByte('"')
+		}
+		m.w.WriteByte('}')
+	}
+	m.w.WriteByte(' ')
+	m.w.WriteString(strconv.FormatFloat(value, 'g', -1, 64))
+	m.w.WriteByte('\n')
+}
+
+var labelEscaper = strings.NewReplacer(`\`, `\\`, `"`, `\"`, "\n", `\n`)
+
+func escapeLabel(v string) string {
+	return labelEscaper.Replace(v)
+}
+
+func sortedKeys(m map[string]uint64) []string {
+	keys := make([]string, 0, len(m))
+	for k := range m {
+		keys = append(keys, k)
+	}
+	sort.Strings(keys)
+	return keys
+}
+
+// handleMetrics serves the latest snapshot in Prometheus text format
+func (s *Server) handleMetrics(w http.ResponseWriter, r *http.Request) {
+	if r.Method != http.MethodGet {
+		http.Error(w, "Method not allowed", http.StatusMethodNotAllowed)
+		return
+	}
+
+	snap, ok := s.dp.Snapshot()
+	if !ok {
+		http.Error(w, "stats snapshot not available (stats.snapshot_ms disabled or not yet published)",
+			http.StatusServiceUnavailable)
+		return
+	}
+
+	w.Header().Set("Content-Type", "text/plain; version=0.0.4; charset=utf-8")
+	bw := bufio.NewWriter(w)
+	defer bw.Flush()
+	writeMetrics(&metricsWriter{w: bw}, s.dp.Interface(), &snap)
+}
+
+func writeMetrics(m *metricsWriter, ifname string, snap *dataplane.Snapshot) {
+	m.family("reflector_info", "gauge", "Reflector instance information.")
+	m.sample("reflector_info", []string{"interface", ifname, "platform", snap.Platform}, 1)
+
+	m.family("reflector_snapshot_generation", "counter", "Stats snapshots published by the dataplane.")
+	m.sample("reflector_snapshot_generation", nil, float64(snap.Generation))
+
+	m.family("reflector_snapshot_timestamp_seconds", "gauge", "Unix time of the served snapshot.")
+	m.sample("reflector_snapshot_timestamp_seconds", nil,
+		float64(snap.Timestamp.UnixNano())/float64(time.Second))
+
+	m.family("reflector_snapshot_age_seconds", "gauge", "Age of the served snapshot.")
+	m.sample("reflector_snapshot_age_seconds", nil, time.Since(snap.Timestamp).Seconds())
+
+	m.family("reflector_workers", "gauge", "Number of dataplane workers.")
+	m.sample("reflector_workers", nil, float64(len(snap.Workers)))
+
+	perWorker := []struct {
+		name, help string
+		value      func(c *dataplane.Counters) uint64
+	}{
+		{"reflector_packets_received_total", "Packets received by the worker.",
+			func(c *dataplane.Counters) uint64 { return c.PacketsReceived }},
+		{"reflector_packets_reflected_total", "Packets reflected by the worker.",
+			func(c *dataplane.Counters) uint64 { return c.PacketsReflected }},
+		{"reflector_bytes_received_total", "Bytes received by the worker.",
+			func(c *dataplane.Counters) uint64 { return c.BytesReceived }},
+		{"reflector_bytes_reflected_total", "Bytes reflected by the worker.",
+			func(c *dataplane.Counters) uint64 { return c.BytesReflected }},
+		{"reflector_poll_timeouts_total", "Receive polls that timed out without packets.",
+			func(c *dataplane.Counters) uint64 { return c.PollTimeouts }},
+		{"reflector_tx_backpressure_total",
+			"TX drops after the bounded backlog wait (also counted in reflector_errors_total{category=\"tx_failed\"}).",
+			func(c *dataplane.Counters) uint64 { return c.TxBackpressure }},
+	}
+	for _, f := range perWorker {
+		m.family(f.name, "counter", f.help)
+		for i := range snap.Workers {
+			wk := &snap.Workers[i]
+			m.sample(f.name, workerLabels(wk), float64(f.value(&wk.Counters)))
+		}
+	}
+
+	m.family("reflector_signature_packets_total", "counter", "Reflected packets by ITO signature.")
+	for i := range snap.Workers {
+		wk := &snap.Workers[i]
+		for _, sig := range sortedKeys(wk.Signatures) {
+			labels := append(workerLabels(wk), "signature", sig)
+			m.sample("reflector_signature_packets_total", labels, float64(wk.Signatures[sig]))
+		}
+	}
+
+	m.family("reflector_errors_total", "counter", "Dropped or failed packets by error category.")
+	for i := range snap.Workers {
+		wk := &snap.Workers[i]
+		for _, cat := range sortedKeys(wk.Errors) {
+			labels := append(workerLabels(wk), "category", cat)
+			m.sample("reflector_errors_total", labels, float64(wk.Errors[cat]))
+		}
+	}
+
+	lat := &snap.Latency
+	m.family("reflector_latency_seconds", "summary", "Reflector dwell time (all workers).")
+	quantiles := []struct {
+		q  string
+		us float64
+	}{
+		{"0.5", lat.LatencyP50}, {"0.99", lat.LatencyP99},
+		{"0.999", lat.LatencyP999}, {"0.9999", lat.LatencyP9999},
+	}
+	for _, q := range quantiles {
+		m.sample("reflector_latency_seconds", []string{"quantile", q.q}, q.us/1e6)
+	}
+	m.sample("reflector_latency_seconds_sum", nil, float64(snap.LatencySumNs)/1e9)
+	m.sample("reflector_latency_seconds_count", nil, float64(lat.LatencyCount))
+
+	if !snap.XDP.Valid {
+		return
+	}
+	m.family("reflector_xdp_packets_total", "counter", "Packets seen by the XDP program, by verdict.")
+	xdp := []struct {
+		result string
+		value  uint64
+	}{
+		{"seen", snap.XDP.PacketsTotal},
+		{"matched", snap.XDP.PacketsITO},
+		{"passed", snap.XDP.PacketsPassed},
+		{"dropped", snap.XDP.PacketsDropped},
+		{"tx", snap.XDP.PacketsTX},
+	}
+	for _, x := range xdp {
+		m.sample("reflector_xdp_packets_total", []string{"result", x.result}, float64(x.value))
+	}
+	m.family("reflector_xdp_tx_bytes_total", "counter", "Bytes reflected in-kernel with XDP_TX.")
+	m.sample("reflector_xdp_tx_bytes_total", nil, float64(snap.XDP.BytesTX))
+}
+
+func workerLabels(wk *dataplane.WorkerStats) []string {
+	return []string{
+		"worker", strconv.Itoa(wk.WorkerID),
+		"queue", strconv.Itoa(wk.QueueID),
+		"cpu", strconv.Itoa(wk.CPUID),
+	}
+}
@@ -0,0 +1,162 @@
+/*
+ * metrics_test.go - Prometheus exposition rendering tests
+ */
+
+package web
+
+import (
+	"bufio"
+	"bytes"
+	"strings"
+	"testing"
+	"time"
+
+	"github.com/krisarmstrong/reflector-native/pkg/dataplane"
+)
+
+func testSnapshot() dataplane.Snapshot {
+	worker := func(id int, rx, tx, txFailed, backpressure uint64) dataplane.WorkerStats {
+		return dataplane.WorkerStats{
+			WorkerID: id,
+			QueueID:  id,
+			CPUID:    id + 2,
+			Counters: dataplane.Counters{
+				PacketsReceived:  rx,
+				PacketsReflected: tx,
+				BytesReceived:    rx * 64,
+				BytesReflected:   tx * 64,
+				TxBackpressure:   backpressure,
+				Signatures:       map[string]uint64{"probeot": tx, "dataot": 0},
+				Errors:           map[string]uint64{"tx_failed": txFailed, "too_short": 1},
+			},
+		}
+	}
+
+	return dataplane.Snapshot{
+		Generation: 42,
+		Timestamp:  time.Unix(1700000000, 500000000),
+		Platform:   "AF_PACKET",
+		Workers: []dataplane.WorkerStats{
+			worker(0, 1000, 990, 10, 4),
+			worker(1, 2000, 2000, 0, 0),
+		},
+		Latency: dataplane.Stats{
+			LatencyP50:   1.5,
+			LatencyP99:   4,
+			LatencyP999:  8,
+			LatencyP9999: 16,
+			LatencyCount: 2990,
+		},
+		LatencySumNs: 5980000,
+	}
+}
+
+func renderMetrics(t *testing.T, ifname string, snap *dataplane.Snapshot) string {
+	t.Helper()
+	var buf bytes.Buffer
+	bw := bufio.NewWriter(&buf)
+	writeMetrics(&metricsWriter{w: bw}, ifname, snap)
+	if err := bw.Flush(); err != nil {
+		t.Fatalf("flush: %v", err)
+	}
+	return buf.String()
+}
+
+func TestWriteMetricsSamples(t *testing.T) {
+	snap := testSnapshot()
+	out := renderMetrics(t, `eth"0`, &snap)
+
+	want := []string{
+		`reflector_info{interface="eth\"0",platform="AF_PACKET"} 1`,
+		`reflector_snapshot_generation 42`,
+		`reflector_snapshot_timestamp_seconds 1.7000000005e+09`,
+		`reflector_workers 2`,
+		`reflector_packets_received_total{worker="0",queue="0",cpu="2"} 1000`,
+		`reflector_packets_reflected_total{worker="1",queue="1",cpu="3"} 2000`,
+		`reflector_bytes_reflected_total{worker="0",queue="0",cpu="2"} 63360`,
+		`reflector_tx_backpressure_total{worker="0",queue="0",cpu="2"} 4`,
+		`reflector_signature_packets_total{worker="0",queue="0",cpu="2",signature="dataot"} 0`,
+		`reflector_signature_packets_total{worker="0",queue="0",cpu="2",signature="probeot"} 990`,
+		`reflector_errors_total{worker="0",queue="0",cpu="2",category="too_short"} 1`,
+		`reflector_errors_total{worker="0",queue="0",cpu="2",category="tx_failed"} 10`,
+		`reflector_latency_seconds{quantile="0.5"} 1.5e-06`,
+		`reflector_latency_seconds{quantile="0.9999"} 1.6e-05`,
+		`reflector_latency_seconds_sum 0.00598`,
+		`reflector_latency_seconds_count 2990`,
+	}
+	for _, line := range want {
+		if !strings.Contains(out, line+"\n") {
+			t.Errorf("missing sample %q", line)
+		}
+	}
+
+	// Backpressure drops are inside tx_failed; an error category would count them twice
+	if strings.Contains(out, `category="tx_backpressure"`) {
+		t.Errorf("tx_backpressure exported as an error category")
+	}
+	// XDP families only appear with valid XDP counters
+	if strings.Contains(out, "reflector_xdp_") {
+		t.Errorf("XDP families rendered without XDP stats")
+	}
+}
+
+func TestWriteMetricsFamilies(t *testing.T) {
+	snap := testSnapshot()
+	snap.XDP = dataplane.XDPStats{Valid: true, PacketsTotal: 10, PacketsTX: 7, BytesTX: 448}
+	out := renderMetrics(t, "eth0", &snap)
+
+	types := map[string]string{}
+	for _, line := range strings.Split(strings.TrimSuffix(out, "\n"), "\n") {
+		if strings.HasPrefix(line, "# TYPE ") {
+			f := strings.Fields(line)
+			if len(f) != 4 {
+				t.Fatalf("malformed TYPE line %q", line)
+			}
+			if _, dup := types[f[2]]; dup {
+				t.Errorf("family %s declared twice", f[2])
+			}
+			types[f[2]] = f[3]
+			continue
+		}
+		if strings.HasPrefix(line, "#") {
+			continue
+		}
+
+		// Every sample belongs to a family declared above it
+		name := line[:strings.IndexAny(line, "{ ")]
+		family := name
+		if _, ok := types[family]; !ok {
+			family = strings.TrimSuffix(strings.TrimSuffix(name, "_sum"), "_count")
+		}
+		if _, ok := types[family]; !ok {
+			t.Errorf("sample %q has no TYPE line", line)
+		}
+	}
+
+	wantTypes := map[string]string{
+		"reflector_info":                   "gauge",
+		"reflector_snapshot_generation":    "counter",
+		"reflector_workers":                "gauge",
+		"reflector_packets_received_total": "counter",
+		"reflector_tx_backpressure_total":  "counter",
+		"reflector_errors_total":           "counter",
+		"reflector_latency_seconds":        "summary",
+		"reflector_xdp_packets_total":      "counter",
+		"reflector_xdp_tx_bytes_total":     "counter",
+	}
+	for name, typ := range wantTypes {
+		if types[name] != typ {
+			t.Errorf("family %s: type %q, want %q", name, types[name], typ)
+		}
+	}
+
+	for _, line := range []string{
+		`reflector_xdp_packets_total{result="seen"} 10`,
+		`reflector_xdp_packets_total{result="tx"} 7`,
+		`reflector_xdp_tx_bytes_total 448`,
+	} {
+		if !strings.Contains(out, line+"\n") {
+			t.Errorf("missing sample %q", line)
+		}
+	}
+}
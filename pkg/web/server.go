@@ -1,7 +1,7 @@
 /*
  * server.go - Embedded web server for Reflector 2.0
  *
- * Serves the React UI and provides JSON API endpoints.
+ * Serves the React UI, JSON API endpoints and Prometheus metrics.
  */
 
 package web
@@ -51,6 +51,10 @@ type StatsResponse struct {
 		MinUs   float64 `json:"min_us"`
 		AvgUs   float64 `json:"avg_us"`
 		MaxUs   float64 `json:"max_us"`
+		P50Us   float64 `json:"p50_us"`
+		P99Us   float64 `json:"p99_us"`
+		P999Us  float64 `json:"p999_us"`
+		P9999Us float64 `json:"p9999_us"`
 		Count   uint64  `json:"count"`
 		Enabled bool    `json:"enabled"`
 	} `json:"latency"`
@@ -85,6 +89,7 @@ func New(dp *dataplane.Dataplane, port int) *Server {
 	s.mux.HandleFunc("/api/stats", s.handleStats)
 	s.mux.HandleFunc("/api/config", s.handleConfig)
 	s.mux.HandleFunc("/api/health", s.handleHealth)
+	s.mux.HandleFunc("/metrics", s.handleMetrics)
 
 	// Serve embedded React app
 	distFS, err := fs.Sub(reactApp, "dist")
@@ -141,6 +146,10 @@ func (s *Server) handleStats(w http.ResponseWriter, r *http.Request) {
 	resp.Latency.MinUs = stats.LatencyMin
 	resp.Latency.AvgUs = stats.LatencyAvg
 	resp.Latency.MaxUs = stats.LatencyMax
+	resp.Latency.P50Us = stats.LatencyP50
+	resp.Latency.P99Us = stats.LatencyP99
+	resp.Latency.P999Us = stats.LatencyP999
+	resp.Latency.P9999Us = stats.LatencyP9999
 	resp.Latency.Count = stats.LatencyCount
 	resp.Latency.Enabled = stats.LatencyCount > 0
 
@@ -4,14 +4,19 @@
 
 #define _GNU_SOURCE
 #include <errno.h>
+#include <stddef.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #ifndef __APPLE__
 #include <pthread.h>
-#include <sched.h>
 #else
 #include <dispatch/dispatch.h>
 #endif
@@ -19,6 +24,16 @@
 
 #include "platform_config.h"
 
+#ifdef ENABLE_HOT_PATH_PROFILE
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
 /* Forward declarations */
 #if HAVE_DPDK
 extern const platform_ops_t *get_dpdk_platform_ops(void);
@@ -32,10 +47,17 @@ extern const platform_ops_t *get_packet_platform_ops(void);
 #ifdef __APPLE__
 extern const platform_ops_t *get_bpf_platform_ops(void);
 #endif
+extern const platform_ops_t *get_vnic_platform_ops(void);
+
+static int snapshot_start(reflector_ctx_t *rctx);
+static void snapshot_stop(reflector_ctx_t *rctx);
 
 /* Global platform ops (set at runtime) */
 static const platform_ops_t *platform_ops = NULL;
 
+/* Histogram samples a stats batch can hold before it must flush */
+#define STATS_BATCH_LAT_SAMPLES (STATS_FLUSH_BATCHES * MAX_BATCH_SIZE)
+
 /* Batched statistics update structure (reduces cache line bouncing) */
 typedef struct {
 	uint64_t packets_received;
@@ -45,19 +67,36 @@ typedef struct {
 	uint64_t sig_probeot_count;
 	uint64_t sig_dataot_count;
 	uint64_t sig_latency_count;
+	uint64_t sig_rfc2544_count;
+	uint64_t sig_y1564_count;
 	uint64_t sig_unknown_count;
 	uint64_t err_tx_failed;
 	latency_stats_t latency_batch;
+#ifdef ENABLE_HOT_PATH_PROFILE
+	hot_path_profile_t profile;
+#endif
 	int batch_count;
+	/* Histogram bucket of each latency_batch sample; not cleared between flushes */
+	uint16_t lat_bucket[STATS_BATCH_LAT_SAMPLES];
 } stats_batch_t;
 
-/* Flush batched statistics to worker stats */
-static inline void flush_stats_batch(reflector_stats_t *stats, stats_batch_t *batch)
+/* Clear everything but lat_bucket (latency_batch.count says how much of it is live) */
+static inline void stats_batch_clear(stats_batch_t *batch)
 {
+	memset(batch, 0, offsetof(stats_batch_t, lat_bucket));
+}
+
+/* Flush batched statistics to worker stats (one seqlock-published update) */
+static inline void flush_stats_batch(worker_ctx_t *wctx, stats_batch_t *batch)
+{
+	reflector_stats_t *stats = &wctx->stats;
+
 	if (unlikely(batch->batch_count == 0)) {
 		return;
 	}
 
+	worker_stats_write_begin(wctx);
+
 	/* Flush accumulated counters */
 	stats->packets_received += batch->packets_received;
 	stats->packets_reflected += batch->packets_reflected;
@@ -68,11 +107,14 @@ static inline void flush_stats_batch(reflector_stats_t *stats, stats_batch_t *ba
 	stats->sig_probeot_count += batch->sig_probeot_count;
 	stats->sig_dataot_count += batch->sig_dataot_count;
 	stats->sig_latency_count += batch->sig_latency_count;
+	stats->sig_rfc2544_count += batch->sig_rfc2544_count;
+	stats->sig_y1564_count += batch->sig_y1564_count;
 	stats->sig_unknown_count += batch->sig_unknown_count;
 
 	/* Error counters */
 	stats->err_tx_failed += batch->err_tx_failed;
 	stats->tx_errors += batch->err_tx_failed;
+	stats->latency.rejected += batch->latency_batch.rejected;
 
 	/* Merge latency statistics if any were collected */
 	if (batch->latency_batch.count > 0) {
@@ -95,12 +137,281 @@ static inline void flush_stats_batch(reflector_stats_t *stats, stats_batch_t *ba
 
 		/* Recalculate average */
 		stats->latency.avg_ns = (double)stats->latency.total_ns / (double)stats->latency.count;
+
+		/* Distribution moves in the same update, so it always matches latency.count */
+		for (uint64_t i = 0; i < batch->latency_batch.count; i++) {
+			stats->latency_hist.buckets[batch->lat_bucket[i]]++;
+		}
+	}
+
+#ifdef ENABLE_HOT_PATH_PROFILE
+	if (batch->profile.bursts > 0) {
+		stats->profile.bursts += batch->profile.bursts;
+		stats->profile.packets += batch->profile.packets;
+		for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+			for (int e = 0; e < PROF_EVENT_COUNT; e++) {
+				stats->profile.counts[p][e] += batch->profile.counts[p][e];
+			}
+		}
+		stats->profile.events = batch->profile.events;
+		stats->profile.tsc_cycles = batch->profile.tsc_cycles;
+	}
+#endif
+
+	worker_stats_write_end(wctx);
+
+	/* Warn on this worker's first rejected latency sample (the count keeps going) */
+	if (unlikely(batch->latency_batch.rejected > 0 &&
+	             stats->latency.rejected == batch->latency_batch.rejected)) {
+		reflector_log(LOG_WARN,
+		              "Worker %d: latency samples with RX after TX rejected (RX and TX clocks "
+		              "disagree; check NTP steps or the NIC clock)",
+		              wctx->worker_id);
 	}
 
 	/* Reset batch */
-	memset(batch, 0, sizeof(*batch));
+	stats_batch_clear(batch);
+}
+
+/* Record one RX->TX sample (both stamps in the fast_clock_ns() domain) */
+static inline void record_latency(worker_ctx_t *wctx, stats_batch_t *batch, uint64_t rx_ns,
+                                  uint64_t tx_ns)
+{
+	/*
+	 * RX after TX: jitter between the clock domains counts as 0 ns; more means
+	 * the clocks disagree (NTP step, unsynced NIC clock) and is counted, not hidden
+	 */
+	if (unlikely(tx_ns < rx_ns)) {
+		if (rx_ns - tx_ns > LATENCY_CLOCK_SLACK_NS) {
+			batch->latency_batch.rejected++;
+			return;
+		}
+		rx_ns = tx_ns;
+	}
+	uint64_t latency_ns = tx_ns - rx_ns;
+
+	/* A full sample buffer publishes early (only reachable with unusual burst mixes) */
+	if (unlikely(batch->latency_batch.count >= STATS_BATCH_LAT_SAMPLES)) {
+		flush_stats_batch(wctx, batch);
+	}
+	batch->lat_bucket[batch->latency_batch.count] = (uint16_t)latency_hist_index(latency_ns);
+
+	batch->latency_batch.count++;
+	batch->latency_batch.total_ns += latency_ns;
+
+	if (batch->latency_batch.count == 1) {
+		batch->latency_batch.min_ns = latency_ns;
+		batch->latency_batch.max_ns = latency_ns;
+	} else {
+		if (latency_ns < batch->latency_batch.min_ns) {
+			batch->latency_batch.min_ns = latency_ns;
+		}
+		if (latency_ns > batch->latency_batch.max_ns) {
+			batch->latency_batch.max_ns = latency_ns;
+		}
+	}
+}
+
+#ifdef ENABLE_HOT_PATH_PROFILE
+/*
+ * Hot-path profiler
+ *
+ * Each worker opens its own counters with perf_event_open() and reads them
+ * from user space with rdpmc via the perf mmap page, so a phase boundary
+ * costs a few instructions and no system call. Counters the kernel will not
+ * expose to rdpmc are read with read() instead (about a microsecond each).
+ * Without PMU access (most VMs, perf_event_paranoid) cycles fall back to the
+ * TSC on x86 and the other events are left out.
+ */
+typedef struct {
+	bool enabled;
+	bool tsc_cycles;
+	uint32_t events; /* Bit per prof_event_t being counted */
+	int fd[PROF_EVENT_COUNT];
+	struct perf_event_mmap_page *page[PROF_EVENT_COUNT]; /* NULL: read() the fd */
+	uint64_t last[PROF_EVENT_COUNT];
+} prof_ctx_t;
+
+#ifdef __linux__
+static int prof_open_event(prof_event_t event, bool exclude_kernel)
+{
+	static const uint64_t configs[PROF_EVENT_COUNT] = {
+	    [PROF_EVENT_CYCLES] = PERF_COUNT_HW_CPU_CYCLES,
+	    [PROF_EVENT_INSTRUCTIONS] = PERF_COUNT_HW_INSTRUCTIONS,
+	    [PROF_EVENT_CACHE_MISSES] = PERF_COUNT_HW_CACHE_MISSES,
+	};
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = configs[event];
+	attr.exclude_kernel = exclude_kernel;
+	attr.exclude_hv = 1;
+
+	/* This thread, any CPU */
+	return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+static void prof_open(prof_ctx_t *prof, const worker_ctx_t *wctx)
+{
+	memset(prof, 0, sizeof(*prof));
+	for (int e = 0; e < PROF_EVENT_COUNT; e++) {
+		prof->fd[e] = -1;
+	}
+	if (!wctx->config->profile_hot_path) {
+		return;
+	}
+	prof->enabled = true;
+
+	int rdpmc_events = 0;
+#ifdef __linux__
+	/* Kernel time matters for the recv/send phases; fall back to user-only */
+	bool exclude_kernel = false;
+	for (int e = 0; e < PROF_EVENT_COUNT; e++) {
+		prof->fd[e] = prof_open_event((prof_event_t)e, exclude_kernel);
+		if (prof->fd[e] < 0 && (errno == EACCES || errno == EPERM) && !exclude_kernel) {
+			exclude_kernel = true;
+			prof->fd[e] = prof_open_event((prof_event_t)e, exclude_kernel);
+		}
+		if (prof->fd[e] < 0) {
+			continue;
+		}
+		prof->events |= 1U << e;
+
+#if defined(__x86_64__) || defined(__i386__)
+		void *page = mmap(NULL, (size_t)sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED,
+		                  prof->fd[e], 0);
+		if (page != MAP_FAILED) {
+			prof->page[e] = page;
+			if (prof->page[e]->cap_user_rdpmc) {
+				rdpmc_events++;
+			}
+		}
+#endif
+	}
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+	if (!(prof->events & (1U << PROF_EVENT_CYCLES))) {
+		prof->tsc_cycles = true;
+		prof->events |= 1U << PROF_EVENT_CYCLES;
+	}
+#endif
+
+	int pmu_events = __builtin_popcount(prof->events) - (prof->tsc_cycles ? 1 : 0);
+	reflector_log(LOG_INFO, "Worker %d hot-path profile: %d PMU counter(s), %d via rdpmc%s",
+	              wctx->worker_id, pmu_events, rdpmc_events,
+	              prof->tsc_cycles ? ", cycles from TSC" : "");
+	if (prof->events == 0) {
+		reflector_log(LOG_WARN, "Worker %d: no counters available, profiling disabled",
+		              wctx->worker_id);
+		prof->enabled = false;
+	}
+}
+
+static void prof_close(prof_ctx_t *prof)
+{
+	for (int e = 0; e < PROF_EVENT_COUNT; e++) {
+#ifdef __linux__
+		if (prof->page[e]) {
+			munmap(prof->page[e], (size_t)sysconf(_SC_PAGESIZE));
+		}
+#endif
+		if (prof->fd[e] >= 0) {
+			close(prof->fd[e]);
+		}
+	}
+}
+
+static inline uint64_t prof_read_event(const prof_ctx_t *prof, int e)
+{
+#if defined(__linux__) && (defined(__x86_64__) || defined(__i386__))
+	const struct perf_event_mmap_page *pc = prof->page[e];
+	if (likely(pc && pc->cap_user_rdpmc)) {
+		uint32_t seq;
+		uint64_t count;
+		do {
+			seq = __atomic_load_n(&pc->lock, __ATOMIC_ACQUIRE);
+			uint32_t idx = pc->index;
+			count = pc->offset;
+			if (likely(idx != 0)) {
+				/* Sign-extend the pmc_width-bit hardware counter */
+				int shift = 64 - pc->pmc_width;
+				count += (uint64_t)(((int64_t)__rdpmc((int)idx - 1) << shift) >> shift);
+			}
+			__atomic_signal_fence(__ATOMIC_SEQ_CST);
+		} while (__atomic_load_n(&pc->lock, __ATOMIC_ACQUIRE) != seq);
+		return count;
+	}
+#endif
+	uint64_t count = 0;
+	if (prof->fd[e] >= 0 && read(prof->fd[e], &count, sizeof(count)) != sizeof(count)) {
+		count = 0;
+	}
+#if defined(__x86_64__) || defined(__i386__)
+	if (e == PROF_EVENT_CYCLES && prof->tsc_cycles) {
+		count = __rdtsc();
+	}
+#endif
+	return count;
+}
+
+static inline void prof_read(const prof_ctx_t *prof, uint64_t *out)
+{
+	for (int e = 0; e < PROF_EVENT_COUNT; e++) {
+		if (prof->events & (1U << e)) {
+			out[e] = prof_read_event(prof, e);
+		}
+	}
 }
 
+/* Close the current phase: charge counter deltas since the last mark to it */
+static inline void prof_phase(prof_ctx_t *prof, hot_path_profile_t *acc, prof_phase_t phase)
+{
+	uint64_t now[PROF_EVENT_COUNT] = {0};
+
+	prof_read(prof, now);
+	for (int e = 0; e < PROF_EVENT_COUNT; e++) {
+		acc->counts[phase][e] += now[e] - prof->last[e];
+		prof->last[e] = now[e];
+	}
+}
+
+static inline void prof_burst(const prof_ctx_t *prof, hot_path_profile_t *acc, int pkts)
+{
+	acc->bursts++;
+	acc->packets += (uint64_t)pkts;
+	acc->events = prof->events;
+	acc->tsc_cycles = prof->tsc_cycles;
+}
+
+#define PROF_BEGIN(prof)                                                                           \
+	do {                                                                                           \
+		if (unlikely((prof)->enabled)) {                                                           \
+			prof_read(prof, (prof)->last);                                                         \
+		}                                                                                          \
+	} while (0)
+#define PROF_PHASE(prof, acc, phase)                                                               \
+	do {                                                                                           \
+		if (unlikely((prof)->enabled)) {                                                           \
+			prof_phase(prof, acc, phase);                                                          \
+		}                                                                                          \
+	} while (0)
+#define PROF_BURST(prof, acc, pkts)                                                                \
+	do {                                                                                           \
+		if (unlikely((prof)->enabled)) {                                                           \
+			prof_burst(prof, acc, pkts);                                                           \
+		}                                                                                          \
+	} while (0)
+#else
+/* Compiled out: no code, no argument evaluation (like DEBUG_LOG) */
+#define PROF_BEGIN(prof) ((void)0)
+#define PROF_PHASE(prof, acc, phase) ((void)0)
+#define PROF_BURST(prof, acc, pkts) ((void)0)
+#endif
+
 /* Worker main loop with batched statistics */
 #ifdef __APPLE__
 static void worker_loop(worker_ctx_t *wctx)
@@ -111,10 +422,32 @@ static void *worker_thread(void *arg)
 #ifndef __APPLE__
 	worker_ctx_t *wctx = (worker_ctx_t *)arg;
 #endif
-	packet_t pkts_rx[BATCH_SIZE];
-	packet_t pkts_tx[BATCH_SIZE];
+	/* Zeroed once: backends that never chain buffers leave extra_len at 0 */
+	packet_t pkts_rx[MAX_BATCH_SIZE] = {0};
+	packet_t pkts_tx[MAX_BATCH_SIZE];
+	packet_t pkts_rel[MAX_BATCH_SIZE];
 	int num_tx;
+	int num_rel;
 	stats_batch_t stats_batch = {0};
+	burst_ctl_t burst;
+	const bool measure_latency = wctx->config->measure_latency;
+	const bool latency_per_packet = measure_latency && wctx->config->latency_per_packet;
+	/* Mode and checksum setting are fixed for the worker's lifetime */
+	const classify_reflect_fn_t classify_reflect =
+	    classify_reflect_select(wctx->config->reflect_mode, wctx->config->software_checksum);
+	/* Adaptive idle: spin while traffic flows, sleep in wait_rx once it stops */
+	const uint32_t idle_spin = wctx->config->idle_spin_polls >= 0
+	                               ? (uint32_t)wctx->config->idle_spin_polls
+	                               : IDLE_SPIN_POLLS;
+	const bool can_sleep = !wctx->config->busy_poll && platform_ops->wait_rx != NULL;
+	uint32_t idle_polls = 0;
+
+	burst_ctl_init(&burst, wctx->config->batch_size, wctx->config->adaptive_batch);
+
+#ifdef ENABLE_HOT_PATH_PROFILE
+	prof_ctx_t prof;
+	prof_open(&prof, wctx);
+#endif
 
 	/* Set CPU affinity if specified */
 	if (wctx->cpu_id >= 0) {
@@ -124,120 +457,161 @@ static void *worker_thread(void *arg)
 		CPU_SET(wctx->cpu_id, &cpuset);
 		pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
 #endif
-		reflector_log(LOG_DEBUG, "Worker %d pinned to CPU %d", wctx->worker_id, wctx->cpu_id);
+		/* Keep the worker's own allocations (stack, lazily faulted buffers) local */
+		if (wctx->numa_node >= 0) {
+			set_thread_numa_node(wctx->numa_node);
+		}
+		reflector_log(LOG_DEBUG, "Worker %d pinned to CPU %d (node %d)", wctx->worker_id,
+		              wctx->cpu_id, wctx->numa_node);
 	}
 
-	reflector_log(LOG_INFO, "Worker %d started (queue %d)", wctx->worker_id, wctx->queue_id);
+	reflector_log(LOG_INFO, "Worker %d started (queue %d, burst %d-%d)", wctx->worker_id,
+	              wctx->queue_id, burst.min, burst.max);
 
 	while (wctx->running) {
+		/* Reset requested by the control thread: only the owner writes stats */
+		if (unlikely(wctx->stats_reset)) {
+			stats_batch_clear(&stats_batch);
+			worker_stats_write_begin(wctx);
+			memset(&wctx->stats, 0, sizeof(wctx->stats));
+			worker_stats_write_end(wctx);
+			__atomic_store_n(&wctx->stats_reset, false, __ATOMIC_RELEASE);
+		}
+
 		/* Receive batch */
-		int rcvd = platform_ops->recv_batch(wctx, pkts_rx, BATCH_SIZE);
+		PROF_BEGIN(&prof);
+		int rcvd = platform_ops->recv_batch(wctx, pkts_rx, burst.size);
 		if (rcvd <= 0) {
+			if (idle_polls < idle_spin) {
+				/* Going idle: publish pending counters rather than holding them */
+				if (++idle_polls == idle_spin) {
+					flush_stats_batch(wctx, &stats_batch);
+				}
+				cpu_relax();
+			} else if (can_sleep) {
+				flush_stats_batch(wctx, &stats_batch); /* No-op once flushed */
+				if (platform_ops->wait_rx(wctx, wctx->config->poll_timeout_ms) == 0) {
+					worker_stats_write_begin(wctx);
+					wctx->stats.poll_timeout++;
+					worker_stats_write_end(wctx);
+				}
+			}
 			continue;
 		}
+		idle_polls = 0; /* Traffic: straight back to spinning */
+		burst_ctl_update(&burst, rcvd);
 
 		/* Accumulate RX stats in local batch */
 		stats_batch.packets_received += (uint64_t)rcvd;
 		for (int i = 0; i < rcvd; i++) {
-			stats_batch.bytes_received += pkts_rx[i].len;
+			stats_batch.bytes_received += pkts_rx[i].len + pkts_rx[i].extra_len;
 		}
 
-		/* Process and reflect ITO packets */
+		/*
+		 * Stamp packets the backend could not timestamp (no kernel/NIC RX
+		 * time) with a single clock read for the whole burst.
+		 */
+		if (measure_latency) {
+			uint64_t rx_now = fast_clock_ns();
+			for (int i = 0; i < rcvd; i++) {
+				if (pkts_rx[i].timestamp == 0) {
+					pkts_rx[i].timestamp = rx_now;
+				}
+			}
+		}
+		PROF_PHASE(&prof, &stats_batch.profile, PROF_PHASE_RECV);
+
+		/* Classify and reflect ITO packets in one parse (fused kernel) */
 		num_tx = 0;
+		num_rel = 0;
 		for (int i = 0; i < rcvd; i++) {
-			/* Prefetch next packet to hide memory latency */
 			if (i + 1 < rcvd) {
 				PREFETCH_READ(pkts_rx[i + 1].data);
 			}
-
-			if (is_ito_packet(pkts_rx[i].data, pkts_rx[i].len, wctx->config)) {
+			sig_type_t sig = classify_reflect(pkts_rx[i].data, pkts_rx[i].len, wctx->config);
+			if (sig != SIG_TYPE_UNKNOWN) {
 				/* Accumulate signature stats in local batch */
-				ito_sig_type_t sig_type = get_ito_signature_type(pkts_rx[i].data, pkts_rx[i].len);
-				switch (sig_type) {
-				case ITO_SIG_TYPE_PROBEOT:
+				switch (sig) {
+				case SIG_TYPE_PROBEOT:
 					stats_batch.sig_probeot_count++;
 					break;
-				case ITO_SIG_TYPE_DATAOT:
+				case SIG_TYPE_DATAOT:
 					stats_batch.sig_dataot_count++;
 					break;
-				case ITO_SIG_TYPE_LATENCY:
+				case SIG_TYPE_LATENCY:
 					stats_batch.sig_latency_count++;
 					break;
+				case SIG_TYPE_RFC2544:
+					stats_batch.sig_rfc2544_count++;
+					break;
+				case SIG_TYPE_Y1564:
+					stats_batch.sig_y1564_count++;
+					break;
 				default:
 					stats_batch.sig_unknown_count++;
 					break;
 				}
 
-				/* Reflect in-place with configurable mode and optional software checksums */
-				reflect_packet_with_mode(pkts_rx[i].data, pkts_rx[i].len,
-				                         wctx->config->reflect_mode,
-				                         wctx->config->software_checksum);
-
-				/* Accumulate latency stats in local batch if enabled */
-				if (wctx->config->measure_latency) {
-					uint64_t tx_time = get_timestamp_ns();
-					uint64_t latency_ns = tx_time - pkts_rx[i].timestamp;
-
-					/* Update batch latency stats */
-					stats_batch.latency_batch.count++;
-					stats_batch.latency_batch.total_ns += latency_ns;
-
-					if (stats_batch.latency_batch.count == 1) {
-						stats_batch.latency_batch.min_ns = latency_ns;
-						stats_batch.latency_batch.max_ns = latency_ns;
-					} else {
-						if (latency_ns < stats_batch.latency_batch.min_ns) {
-							stats_batch.latency_batch.min_ns = latency_ns;
-						}
-						if (latency_ns > stats_batch.latency_batch.max_ns) {
-							stats_batch.latency_batch.max_ns = latency_ns;
-						}
-					}
+				/* Per-packet mode: one clock read at reflect time */
+				if (unlikely(latency_per_packet)) {
+					record_latency(wctx, &stats_batch, pkts_rx[i].timestamp, fast_clock_ns());
 				}
 
 				/* Add to TX batch (stats counted after successful send) */
 				pkts_tx[num_tx++] = pkts_rx[i];
 			} else {
-				/* Not ITO packet, release buffer */
-				if (platform_ops->release_batch) {
-					platform_ops->release_batch(wctx, &pkts_rx[i], 1);
-				}
+				/* Not ITO packet: released below with the rest of the burst's rejects */
+				pkts_rel[num_rel++] = pkts_rx[i];
+			}
+		}
+		PROF_PHASE(&prof, &stats_batch.profile, PROF_PHASE_CLASSIFY);
+
+		if (num_rel > 0 && platform_ops->release_batch) {
+			platform_ops->release_batch(wctx, pkts_rel, num_rel);
+		}
+		PROF_PHASE(&prof, &stats_batch.profile, PROF_PHASE_RELEASE);
+
+		/* Burst mode: one TX-side clock read shared by every reflected packet */
+		if (measure_latency && !latency_per_packet && num_tx > 0) {
+			uint64_t tx_now = fast_clock_ns();
+			for (int i = 0; i < num_tx; i++) {
+				record_latency(wctx, &stats_batch, pkts_tx[i].timestamp, tx_now);
 			}
 		}
 
-		/* Send reflected packets */
+		/* Send reflected packets (the backend owns them from here on) */
 		if (num_tx > 0) {
 			int sent = platform_ops->send_batch(wctx, pkts_tx, num_tx);
 			if (sent < 0) {
-				/* Track TX failures in batch */
-				stats_batch.err_tx_failed += (uint64_t)num_tx;
-			} else if (sent > 0) {
-				/* Count ONLY successfully sent packets */
-				for (int i = 0; i < sent; i++) {
-					stats_batch.packets_reflected++;
-					stats_batch.bytes_reflected += pkts_tx[i].len;
-				}
-				/*
-				 * Release transmitted buffers back to platform
-				 * - AF_PACKET: Returns RX frames to kernel (packets were copied)
-				 * - AF_XDP: Triggers CQ polling to recycle UMEM buffers (zero-copy)
-				 * - macOS BPF: No-op (packets are copied, no buffer management)
-				 */
-				if (platform_ops->release_batch) {
-					platform_ops->release_batch(wctx, pkts_tx, sent);
-				}
+				sent = 0;
+			}
+			/* Count ONLY packets the backend accepted for transmission */
+			for (int i = 0; i < sent; i++) {
+				stats_batch.packets_reflected++;
+				stats_batch.bytes_reflected += pkts_tx[i].len + pkts_tx[i].extra_len;
 			}
+			/* The rest were dropped and recycled by the backend */
+			stats_batch.err_tx_failed += (uint64_t)(num_tx - sent);
 		}
+		PROF_PHASE(&prof, &stats_batch.profile, PROF_PHASE_SEND);
+		PROF_BURST(&prof, &stats_batch.profile, rcvd);
 
-		/* Flush batch to worker stats every BATCH_SIZE packets or periodically */
+		/* Flush batch to worker stats every STATS_FLUSH_BATCHES bursts */
 		stats_batch.batch_count++;
 		if (unlikely(stats_batch.batch_count >= STATS_FLUSH_BATCHES)) {
-			flush_stats_batch(&wctx->stats, &stats_batch);
+			flush_stats_batch(wctx, &stats_batch);
+			/* Keep kernel/NIC realtime stamps aligned with the fast clock */
+			if (measure_latency && wctx->worker_id == 0) {
+				fast_clock_resync();
+			}
 		}
 	}
 
 	/* Final flush before exiting */
-	flush_stats_batch(&wctx->stats, &stats_batch);
+	flush_stats_batch(wctx, &stats_batch);
+#ifdef ENABLE_HOT_PATH_PROFILE
+	prof_close(&prof);
+#endif
 
 	reflector_log(LOG_INFO, "Worker %d stopped", wctx->worker_id);
 #ifndef __APPLE__
@@ -245,6 +619,19 @@ static void *worker_thread(void *arg)
 #endif
 }
 
+/* Keep num_workers within 1..MAX_WORKERS (snapshots, DPDK pools are sized for it) */
+static void clamp_num_workers(reflector_config_t *config)
+{
+	if (config->num_workers > MAX_WORKERS) {
+		reflector_log(LOG_WARN, "Capping num_workers from %d to %d", config->num_workers,
+		              MAX_WORKERS);
+		config->num_workers = MAX_WORKERS;
+	}
+	if (config->num_workers < 1) {
+		config->num_workers = 1;
+	}
+}
+
 /* Initialize reflector */
 int reflector_init(reflector_ctx_t *rctx, const char *ifname)
 {
@@ -255,6 +642,9 @@ int reflector_init(reflector_ctx_t *rctx, const char *ifname)
 
 	memset(rctx, 0, sizeof(*rctx));
 
+	/* Calibrate the latency clock once, before any worker runs */
+	fast_clock_init();
+
 	/* Set defaults */
 #ifdef __APPLE__
 	strlcpy(rctx->config.ifname, ifname, MAX_IFNAME_LEN);
@@ -265,9 +655,13 @@ int reflector_init(reflector_ctx_t *rctx, const char *ifname)
 	rctx->config.frame_size = FRAME_SIZE;
 	rctx->config.num_frames = NUM_FRAMES;
 	rctx->config.batch_size = BATCH_SIZE;
+	rctx->config.adaptive_batch = false; /* Fixed bursts of batch_size */
 	rctx->config.poll_timeout_ms = 100;
+	rctx->config.idle_spin_polls = IDLE_SPIN_POLLS;
 	rctx->config.cpu_affinity = -1;         /* Auto: use IRQ affinity */
 	rctx->config.use_huge_pages = false;    /* Disabled by default */
+	rctx->config.shared_umem = false;       /* One UMEM per AF_XDP queue */
+	rctx->config.block_timeout_ms = PACKET_BLOCK_TIMEOUT_MS;
 	rctx->config.software_checksum = false; /* Use NIC offload by default */
 
 	/* ITO packet filtering defaults */
@@ -277,6 +671,19 @@ int reflector_init(reflector_ctx_t *rctx, const char *ifname)
 	rctx->config.oui[1] = NETALLY_OUI_BYTE1;
 	rctx->config.oui[2] = NETALLY_OUI_BYTE2;
 	rctx->config.reflect_mode = REFLECT_MODE_ALL; /* Full reflection by default */
+	rctx->config.enable_ipv6 = true;              /* Dual-stack by default */
+	rctx->config.enable_vlan = true;              /* Accept 802.1Q / QinQ tagged frames */
+
+	/* In-memory virtual NIC: no interface to look up, one worker unless configured */
+	if (is_vnic_ifname(ifname)) {
+		const uint8_t vnic_mac[6] = VNIC_MAC_ADDR;
+		memcpy(rctx->config.mac, vnic_mac, 6);
+		rctx->config.num_workers = 1;
+		platform_ops = get_vnic_platform_ops();
+		reflector_log(LOG_INFO, "Reflector initialized on %s (%d workers, platform: %s)", ifname,
+		              rctx->config.num_workers, platform_ops->name);
+		return 0;
+	}
 
 	/* Get interface info */
 	rctx->config.ifindex = get_interface_index(ifname);
@@ -393,6 +800,7 @@ int reflector_init(reflector_ctx_t *rctx, const char *ifname)
 #ifdef __linux__
 	int num_queues = get_num_rx_queues(ifname);
 	rctx->config.num_workers = num_queues;
+	clamp_num_workers(&rctx->config);
 #else
 	rctx->config.num_workers = 1;
 #endif
@@ -406,8 +814,16 @@ int reflector_init(reflector_ctx_t *rctx, const char *ifname)
 /* Start reflector workers */
 int reflector_start(reflector_ctx_t *rctx)
 {
+	/* Callers may have set config.num_workers directly */
+	clamp_num_workers(&rctx->config);
 	rctx->num_workers = rctx->config.num_workers;
-	rctx->workers = calloc((size_t)rctx->num_workers, sizeof(worker_ctx_t));
+	/* Cache-line aligned so no two workers' stats share a line */
+	void *workers = NULL;
+	if (posix_memalign(&workers, CACHE_LINE_SIZE, (size_t)rctx->num_workers * sizeof(worker_ctx_t)) ==
+	    0) {
+		memset(workers, 0, (size_t)rctx->num_workers * sizeof(worker_ctx_t));
+		rctx->workers = workers;
+	}
 	rctx->platform_contexts = calloc((size_t)rctx->num_workers, sizeof(platform_ctx_t *));
 #ifdef __APPLE__
 	rctx->worker_queues = calloc((size_t)rctx->num_workers, sizeof(dispatch_queue_t));
@@ -434,15 +850,25 @@ int reflector_start(reflector_ctx_t *rctx)
 
 	rctx->running = true;
 
+	/* Place workers; platform state allocated below prefers the NIC's node */
+	int nic_node = get_nic_numa_node(rctx->config.ifname);
+	int worker_cpus[MAX_WORKERS];
+	plan_worker_cpus(&rctx->config, nic_node, rctx->num_workers, worker_cpus);
+	if (nic_node >= 0) {
+		set_thread_numa_node(nic_node);
+	}
+
 	/* Initialize and start workers */
 	for (int i = 0; i < rctx->num_workers; i++) {
 		worker_ctx_t *wctx = &rctx->workers[i];
 		wctx->worker_id = i;
 		wctx->queue_id = i;
-		/* Use explicit CPU affinity if configured, otherwise auto-detect from IRQ */
-		wctx->cpu_id = (rctx->config.cpu_affinity >= 0)
-		                   ? rctx->config.cpu_affinity
-		                   : get_queue_cpu_affinity(rctx->config.ifname, i);
+		wctx->cpu_id = worker_cpus[i];
+		wctx->numa_node = wctx->cpu_id >= 0 ? get_cpu_numa_node(wctx->cpu_id) : -1;
+		if (nic_node >= 0 && wctx->numa_node >= 0 && wctx->numa_node != nic_node) {
+			reflector_log(LOG_WARN, "Worker %d on CPU %d (node %d) is remote to %s (node %d)", i,
+			              wctx->cpu_id, wctx->numa_node, rctx->config.ifname, nic_node);
+		}
 		wctx->config = &rctx->config;
 		wctx->running = true;
 
@@ -555,8 +981,9 @@ int reflector_start(reflector_ctx_t *rctx)
 
 		rctx->platform_contexts[i] = wctx->pctx;
 
-		/* Drop privileges after socket/interface initialization (first worker only) */
-		if (i == 0) {
+		/* Drop privileges after socket/interface initialization (first worker only;
+		 * the virtual NIC opened nothing privileged) */
+		if (i == 0 && !is_vnic_ifname(rctx->config.ifname)) {
 			if (drop_privileges() < 0) {
 				reflector_log(LOG_WARN, "Failed to drop privileges (continuing anyway)");
 				/* Continue - not fatal for functionality */
@@ -597,6 +1024,16 @@ int reflector_start(reflector_ctx_t *rctx)
 #endif
 	}
 
+	if (nic_node >= 0) {
+		set_thread_numa_node(-1); /* Control thread: back to local allocation */
+	}
+
+	/* Snapshots are an observability aid: run without them rather than fail */
+	int snap_ret = snapshot_start(rctx);
+	if (snap_ret < 0) {
+		reflector_log(LOG_WARN, "Stats snapshot publishing disabled: %s", strerror(-snap_ret));
+	}
+
 	reflector_log(LOG_INFO, "Reflector started with %d workers", rctx->num_workers);
 	return 0;
 }
@@ -625,6 +1062,9 @@ void reflector_stop(reflector_ctx_t *rctx)
 		}
 #endif
 
+		/* Final snapshot while the workers' stats and backends still exist */
+		snapshot_stop(rctx);
+
 		/* Cleanup platform contexts */
 		for (int i = 0; i < rctx->num_workers; i++) {
 			if (platform_ops && platform_ops->cleanup) {
@@ -667,86 +1107,457 @@ void reflector_cleanup(reflector_ctx_t *rctx)
 	if (rctx->running) {
 		reflector_stop(rctx);
 	}
+
+	free(rctx->snapshot);
+	free(rctx->snapshot_staging);
+	rctx->snapshot = NULL;
+	rctx->snapshot_staging = NULL;
 }
 
-/* Atomic load helper for 64-bit values (thread-safe stats reading) */
-#define ATOMIC_LOAD64(x) __atomic_load_n(&(x), __ATOMIC_RELAXED)
+/* Bucket upper bounds can overshoot the largest sample actually seen */
+static uint64_t latency_percentile_clamped(const latency_hist_t *hist, double percentile,
+                                           uint64_t max_ns)
+{
+	uint64_t v = latency_hist_percentile(hist, percentile);
+	return v < max_ns ? v : max_ns;
+}
 
-/* Get aggregated statistics (thread-safe) */
-void reflector_get_stats(const reflector_ctx_t *rctx, reflector_stats_t *stats)
+/*
+ * Consistent copy of one worker's stats: retry while the worker is mid-update
+ * (odd sequence) or published a new update during the copy.
+ */
+static void worker_stats_snapshot(const worker_ctx_t *wctx, reflector_stats_t *out)
 {
-	memset(stats, 0, sizeof(*stats));
+	uint32_t seq_begin, seq_end;
 
-	for (int i = 0; i < rctx->num_workers; i++) {
-		const reflector_stats_t *ws = &rctx->workers[i].stats;
-
-		/* Basic packet counters - use atomic loads for thread safety */
-		stats->packets_received += ATOMIC_LOAD64(ws->packets_received);
-		stats->packets_reflected += ATOMIC_LOAD64(ws->packets_reflected);
-		stats->packets_dropped += ATOMIC_LOAD64(ws->packets_dropped);
-		stats->bytes_received += ATOMIC_LOAD64(ws->bytes_received);
-		stats->bytes_reflected += ATOMIC_LOAD64(ws->bytes_reflected);
-
-		/* Per-signature counters */
-		stats->sig_probeot_count += ATOMIC_LOAD64(ws->sig_probeot_count);
-		stats->sig_dataot_count += ATOMIC_LOAD64(ws->sig_dataot_count);
-		stats->sig_latency_count += ATOMIC_LOAD64(ws->sig_latency_count);
-		stats->sig_unknown_count += ATOMIC_LOAD64(ws->sig_unknown_count);
-
-		/* Error counters */
-		stats->err_invalid_mac += ATOMIC_LOAD64(ws->err_invalid_mac);
-		stats->err_invalid_ethertype += ATOMIC_LOAD64(ws->err_invalid_ethertype);
-		stats->err_invalid_protocol += ATOMIC_LOAD64(ws->err_invalid_protocol);
-		stats->err_invalid_signature += ATOMIC_LOAD64(ws->err_invalid_signature);
-		stats->err_too_short += ATOMIC_LOAD64(ws->err_too_short);
-		stats->err_tx_failed += ATOMIC_LOAD64(ws->err_tx_failed);
-		stats->err_nomem += ATOMIC_LOAD64(ws->err_nomem);
-
-		/* Legacy error counters */
-		stats->rx_invalid += ATOMIC_LOAD64(ws->rx_invalid);
-		stats->rx_nomem += ATOMIC_LOAD64(ws->rx_nomem);
-		stats->tx_errors += ATOMIC_LOAD64(ws->tx_errors);
-
-		/* Aggregate latency statistics */
-		uint64_t lat_count = ATOMIC_LOAD64(ws->latency.count);
-		if (lat_count > 0) {
-			stats->latency.count += lat_count;
-			stats->latency.total_ns += ATOMIC_LOAD64(ws->latency.total_ns);
-
-			uint64_t lat_min = ATOMIC_LOAD64(ws->latency.min_ns);
-			uint64_t lat_max = ATOMIC_LOAD64(ws->latency.max_ns);
-
-			/* Update min/max across all workers */
-			if (stats->latency.count == lat_count) {
-				/* First worker with latency data */
+	do {
+		seq_begin = __atomic_load_n(&wctx->stats_seq, __ATOMIC_ACQUIRE);
+		if (seq_begin & 1) {
+			sched_yield();
+			continue;
+		}
+		memcpy(out, &wctx->stats, sizeof(*out));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		seq_end = __atomic_load_n(&wctx->stats_seq, __ATOMIC_RELAXED);
+		if (seq_begin == seq_end) {
+			return;
+		}
+	} while (true);
+}
+
+/* Add one worker's counters to an aggregate */
+static void stats_accumulate(reflector_stats_t *stats, const reflector_stats_t *ws)
+{
+	/* Basic packet counters */
+	stats->packets_received += ws->packets_received;
+	stats->packets_reflected += ws->packets_reflected;
+	stats->packets_dropped += ws->packets_dropped;
+	stats->bytes_received += ws->bytes_received;
+	stats->bytes_reflected += ws->bytes_reflected;
+
+	/* Per-signature counters */
+	stats->sig_probeot_count += ws->sig_probeot_count;
+	stats->sig_dataot_count += ws->sig_dataot_count;
+	stats->sig_latency_count += ws->sig_latency_count;
+	stats->sig_rfc2544_count += ws->sig_rfc2544_count;
+	stats->sig_y1564_count += ws->sig_y1564_count;
+	stats->sig_unknown_count += ws->sig_unknown_count;
+
+	/* Error counters */
+	stats->err_invalid_mac += ws->err_invalid_mac;
+	stats->err_invalid_ethertype += ws->err_invalid_ethertype;
+	stats->err_invalid_protocol += ws->err_invalid_protocol;
+	stats->err_invalid_signature += ws->err_invalid_signature;
+	stats->err_too_short += ws->err_too_short;
+	stats->err_tx_failed += ws->err_tx_failed;
+	stats->err_tx_backpressure += ws->err_tx_backpressure;
+	stats->err_nomem += ws->err_nomem;
+
+	/* Legacy error counters */
+	stats->rx_invalid += ws->rx_invalid;
+	stats->rx_nomem += ws->rx_nomem;
+	stats->tx_errors += ws->tx_errors;
+	stats->poll_timeout += ws->poll_timeout;
+	stats->latency.rejected += ws->latency.rejected;
+
+	/* Aggregate latency statistics */
+	uint64_t lat_count = ws->latency.count;
+	if (lat_count > 0) {
+		stats->latency.count += lat_count;
+		stats->latency.total_ns += ws->latency.total_ns;
+
+		uint64_t lat_min = ws->latency.min_ns;
+		uint64_t lat_max = ws->latency.max_ns;
+
+		/* Update min/max across all workers */
+		if (stats->latency.count == lat_count) {
+			/* First worker with latency data */
+			stats->latency.min_ns = lat_min;
+			stats->latency.max_ns = lat_max;
+		} else {
+			if (lat_min < stats->latency.min_ns) {
 				stats->latency.min_ns = lat_min;
+			}
+			if (lat_max > stats->latency.max_ns) {
 				stats->latency.max_ns = lat_max;
-			} else {
-				if (lat_min < stats->latency.min_ns) {
-					stats->latency.min_ns = lat_min;
-				}
-				if (lat_max > stats->latency.max_ns) {
-					stats->latency.max_ns = lat_max;
-				}
 			}
 		}
 	}
 
-	/* Calculate average latency */
+	latency_hist_merge(&stats->latency_hist, &ws->latency_hist);
+
+	/* Hot-path profile (all zero unless built with ENABLE_HOT_PATH_PROFILE) */
+	if (ws->profile.bursts > 0) {
+		stats->profile.bursts += ws->profile.bursts;
+		stats->profile.packets += ws->profile.packets;
+		for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+			for (int e = 0; e < PROF_EVENT_COUNT; e++) {
+				stats->profile.counts[p][e] += ws->profile.counts[p][e];
+			}
+		}
+		stats->profile.events |= ws->profile.events;
+		stats->profile.tsc_cycles |= ws->profile.tsc_cycles;
+	}
+}
+
+/* Derive averages and percentiles once every worker has been accumulated */
+static void stats_finish(reflector_stats_t *stats)
+{
+	/* Calculate average latency and percentiles */
 	if (stats->latency.count > 0) {
-		stats->latency.avg_ns = (double)stats->latency.total_ns / (double)stats->latency.count;
+		latency_stats_t *lat = &stats->latency;
+		const latency_hist_t *hist = &stats->latency_hist;
+
+		lat->avg_ns = (double)lat->total_ns / (double)lat->count;
+
+		lat->p50_ns = latency_percentile_clamped(hist, 50.0, lat->max_ns);
+		lat->p99_ns = latency_percentile_clamped(hist, 99.0, lat->max_ns);
+		lat->p999_ns = latency_percentile_clamped(hist, 99.9, lat->max_ns);
+		lat->p9999_ns = latency_percentile_clamped(hist, 99.99, lat->max_ns);
 	}
 }
 
+/* Get aggregated statistics (thread-safe, consistent per worker) */
+void reflector_get_stats(const reflector_ctx_t *rctx, reflector_stats_t *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+
+	for (int i = 0; i < rctx->num_workers; i++) {
+		reflector_stats_t snap;
+		worker_stats_snapshot(&rctx->workers[i], &snap);
+		stats_accumulate(stats, &snap);
+
+		/* Backend-held counters (e.g. packets reflected in-kernel via XDP_TX) */
+		if (platform_ops && platform_ops->get_stats) {
+			platform_ops->get_stats(&rctx->workers[i], stats);
+		}
+	}
+
+	stats_finish(stats);
+}
+
 /* Reset statistics */
 void reflector_reset_stats(reflector_ctx_t *rctx)
 {
 	for (int i = 0; i < rctx->num_workers; i++) {
-		memset(&rctx->workers[i].stats, 0, sizeof(reflector_stats_t));
+		worker_ctx_t *wctx = &rctx->workers[i];
+
+		if (wctx->running) {
+			/* The worker owns its stats: ask it to clear them and wait (bounded) */
+			__atomic_store_n(&wctx->stats_reset, true, __ATOMIC_RELEASE);
+			for (int spins = 0; spins < 1000 && wctx->running &&
+			                    __atomic_load_n(&wctx->stats_reset, __ATOMIC_ACQUIRE);
+			     spins++) {
+				usleep(1000);
+			}
+		} else {
+			memset(&wctx->stats, 0, sizeof(reflector_stats_t));
+		}
+		if (platform_ops && platform_ops->reset_stats) {
+			platform_ops->reset_stats(wctx);
+		}
 	}
 	memset(&rctx->global_stats, 0, sizeof(reflector_stats_t));
 }
 
+/* ========================================================================
+ * Stats Snapshot Publishing
+ * ======================================================================== */
+
+#define SNAPSHOT_SLEEP_SLICE_MS 50 /* Longest the publisher delays reflector_stop() */
+
+/*
+ * Create and map the shared-memory stats segment. A segment left behind by a
+ * crashed run is unlinked first, so readers still holding it see a frozen
+ * copy rather than a layout changing under them.
+ */
+static int stats_shm_open(reflector_ctx_t *rctx)
+{
+	snprintf(rctx->shm_name, sizeof(rctx->shm_name), REFLECTOR_SHM_PREFIX "%s",
+	         rctx->config.ifname);
+	shm_unlink(rctx->shm_name);
+
+	/* World-readable: monitoring agents need not run as root */
+	int fd = shm_open(rctx->shm_name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0) {
+		return -errno;
+	}
+
+	void *map = MAP_FAILED;
+	int err = 0;
+	if (ftruncate(fd, sizeof(reflector_shm_t)) < 0) {
+		err = errno;
+	} else {
+		map = mmap(NULL, sizeof(reflector_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		err = errno;
+	}
+	close(fd);
+	if (map == MAP_FAILED) {
+		shm_unlink(rctx->shm_name);
+		return -err;
+	}
+
+	/* ftruncate zero-fills: magic stays 0 until the header is complete */
+	reflector_shm_t *shm = map;
+	reflector_shm_header_t *hdr = &shm->header;
+	hdr->version = REFLECTOR_SHM_VERSION;
+	hdr->header_size = sizeof(reflector_shm_header_t);
+	hdr->record_size = sizeof(reflector_shm_record_t);
+	hdr->stats_size = sizeof(reflector_stats_t);
+	hdr->max_workers = MAX_WORKERS;
+	hdr->interval_ms = (uint32_t)rctx->config.snapshot_interval_ms;
+	hdr->running = 1;
+	hdr->pid = (int32_t)getpid();
+	snprintf(hdr->ifname, sizeof(hdr->ifname), "%s", rctx->config.ifname);
+	snprintf(hdr->platform, sizeof(hdr->platform), "%s",
+	         platform_ops && platform_ops->name ? platform_ops->name : "unknown");
+	__atomic_store_n(&hdr->magic, REFLECTOR_SHM_MAGIC, __ATOMIC_RELEASE);
+
+	rctx->shm = shm;
+	return 0;
+}
+
+/* Mark the segment stopped, unmap and unlink it */
+static void stats_shm_close(reflector_ctx_t *rctx)
+{
+	if (!rctx->shm) {
+		return;
+	}
+	__atomic_store_n(&rctx->shm->header.running, 0, __ATOMIC_RELEASE);
+	munmap(rctx->shm, sizeof(reflector_shm_t));
+	shm_unlink(rctx->shm_name);
+	rctx->shm = NULL;
+}
+
+static void stats_shm_write_record(reflector_shm_record_t *rec, int worker_id, int queue_id,
+                                   int cpu_id, uint64_t timestamp_ns,
+                                   const reflector_stats_t *stats)
+{
+	__atomic_store_n(&rec->seq, rec->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	rec->worker_id = worker_id;
+	rec->queue_id = queue_id;
+	rec->cpu_id = cpu_id;
+	rec->timestamp_ns = timestamp_ns;
+	memcpy(&rec->stats, stats, sizeof(*stats));
+	__atomic_store_n(&rec->seq, rec->seq + 1, __ATOMIC_RELEASE);
+}
+
+/* Mirror a snapshot into the segment (publisher only) */
+static void stats_shm_publish(reflector_shm_t *shm, const reflector_snapshot_t *snap)
+{
+	stats_shm_write_record(&shm->total, -1, -1, -1, snap->timestamp_ns, &snap->total);
+	for (int i = 0; i < snap->num_workers && i < MAX_WORKERS; i++) {
+		const worker_snapshot_t *ws = &snap->workers[i];
+		stats_shm_write_record(&shm->workers[i], ws->worker_id, ws->queue_id, ws->cpu_id,
+		                       snap->timestamp_ns, &ws->stats);
+	}
+	__atomic_store_n(&shm->header.num_workers, (uint32_t)snap->num_workers, __ATOMIC_RELAXED);
+	__atomic_store_n(&shm->header.generation, snap->generation, __ATOMIC_RELEASE);
+}
+
+void reflector_publish_snapshot(reflector_ctx_t *rctx)
+{
+	reflector_snapshot_t *stage = rctx->snapshot_staging;
+	if (!stage || !rctx->workers) {
+		return;
+	}
+
+	/* One publisher at a time; a concurrent call simply skips */
+	if (__atomic_exchange_n(&rctx->snapshot_publishing, true, __ATOMIC_ACQUIRE)) {
+		return;
+	}
+
+	/* Build the new snapshot off to the side: readers only see the final copy */
+	memset(&stage->total, 0, sizeof(stage->total));
+	/* reflector_start() caps num_workers; the count must match the entries filled */
+	stage->num_workers = rctx->num_workers < MAX_WORKERS ? rctx->num_workers : MAX_WORKERS;
+	snprintf(stage->platform, sizeof(stage->platform), "%s",
+	         platform_ops && platform_ops->name ? platform_ops->name : "unknown");
+
+	for (int i = 0; i < stage->num_workers; i++) {
+		const worker_ctx_t *wctx = &rctx->workers[i];
+		worker_snapshot_t *ws = &stage->workers[i];
+
+		ws->worker_id = wctx->worker_id;
+		ws->queue_id = wctx->queue_id;
+		ws->cpu_id = wctx->cpu_id;
+		ws->numa_node = wctx->numa_node;
+		worker_stats_snapshot(wctx, &ws->stats);
+		stats_accumulate(&stage->total, &ws->stats);
+
+		if (platform_ops && platform_ops->get_stats) {
+			platform_ops->get_stats(wctx, &stage->total);
+		}
+	}
+	stats_finish(&stage->total);
+
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	stage->timestamp_ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+	stage->generation = rctx->snapshot->generation + 1;
+
+	/* Seqlock-publish: odd while copying, readers retry */
+	__atomic_store_n(&rctx->snapshot_seq, rctx->snapshot_seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy(rctx->snapshot, stage, sizeof(*stage));
+	__atomic_store_n(&rctx->snapshot_seq, rctx->snapshot_seq + 1, __ATOMIC_RELEASE);
+
+	if (rctx->shm) {
+		stats_shm_publish(rctx->shm, stage);
+	}
+
+	__atomic_store_n(&rctx->snapshot_publishing, false, __ATOMIC_RELEASE);
+}
+
+int reflector_read_snapshot(const reflector_ctx_t *rctx, reflector_snapshot_t *snap)
+{
+	if (!rctx->snapshot) {
+		return -EAGAIN;
+	}
+
+	uint32_t seq_begin, seq_end;
+	do {
+		seq_begin = __atomic_load_n(&rctx->snapshot_seq, __ATOMIC_ACQUIRE);
+		if (seq_begin & 1) {
+			sched_yield();
+			continue;
+		}
+		memcpy(snap, rctx->snapshot, sizeof(*snap));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		seq_end = __atomic_load_n(&rctx->snapshot_seq, __ATOMIC_RELAXED);
+	} while ((seq_begin & 1) || seq_begin != seq_end);
+
+	return snap->generation > 0 ? 0 : -EAGAIN;
+}
+
+#ifndef __APPLE__
+static void *snapshot_thread(void *arg)
+{
+	reflector_ctx_t *rctx = arg;
+	const int interval_ms = rctx->config.snapshot_interval_ms;
+
+	while (rctx->snapshot_running) {
+		reflector_publish_snapshot(rctx);
+		for (int slept = 0; slept < interval_ms && rctx->snapshot_running;
+		     slept += SNAPSHOT_SLEEP_SLICE_MS) {
+			int ms = interval_ms - slept;
+			usleep((useconds_t)(ms < SNAPSHOT_SLEEP_SLICE_MS ? ms : SNAPSHOT_SLEEP_SLICE_MS) *
+			       1000);
+		}
+	}
+	return NULL;
+}
+#endif
+
+/* Allocate the snapshot buffers and start publishing (no-op when disabled) */
+static int snapshot_start(reflector_ctx_t *rctx)
+{
+	if (rctx->config.stats_shm && rctx->config.snapshot_interval_ms <= 0) {
+		rctx->config.snapshot_interval_ms = REFLECTOR_SHM_DEFAULT_INTERVAL_MS;
+	}
+	if (rctx->config.snapshot_interval_ms <= 0) {
+		return 0;
+	}
+
+	if (!rctx->snapshot) {
+		rctx->snapshot = calloc(1, sizeof(reflector_snapshot_t));
+		rctx->snapshot_staging = calloc(1, sizeof(reflector_snapshot_t));
+		if (!rctx->snapshot || !rctx->snapshot_staging) {
+			free(rctx->snapshot);
+			free(rctx->snapshot_staging);
+			rctx->snapshot = NULL;
+			rctx->snapshot_staging = NULL;
+			return -ENOMEM;
+		}
+	}
+
+	if (rctx->config.stats_shm) {
+		int ret = stats_shm_open(rctx);
+		if (ret < 0) {
+			reflector_log(LOG_WARN, "Stats shared memory %s disabled: %s", rctx->shm_name,
+			              strerror(-ret));
+		} else {
+			reflector_log(LOG_INFO, "Stats shared memory: %s", rctx->shm_name);
+		}
+	}
+
+	rctx->snapshot_running = true;
+#ifdef __APPLE__
+	uint64_t interval_ns = (uint64_t)rctx->config.snapshot_interval_ms * NSEC_PER_MSEC;
+	rctx->snapshot_queue = dispatch_queue_create("com.reflector.snapshot", DISPATCH_QUEUE_SERIAL);
+	if (rctx->snapshot_queue) {
+		rctx->snapshot_timer =
+		    dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, rctx->snapshot_queue);
+	}
+	if (!rctx->snapshot_timer) {
+		rctx->snapshot_running = false;
+		stats_shm_close(rctx);
+		return -ENOMEM;
+	}
+	dispatch_source_set_timer(rctx->snapshot_timer, dispatch_time(DISPATCH_TIME_NOW, 0),
+	                          interval_ns, interval_ns / 10);
+	dispatch_source_set_event_handler(rctx->snapshot_timer, ^{
+	  reflector_publish_snapshot(rctx);
+	});
+	dispatch_resume(rctx->snapshot_timer);
+#else
+	if (pthread_create(&rctx->snapshot_tid, NULL, snapshot_thread, rctx) != 0) {
+		rctx->snapshot_running = false;
+		stats_shm_close(rctx);
+		return -EAGAIN;
+	}
+#endif
+	reflector_log(LOG_INFO, "Publishing stats snapshots every %d ms",
+	              rctx->config.snapshot_interval_ms);
+	return 0;
+}
+
+/* Stop publishing and leave a final snapshot behind (workers must still exist) */
+static void snapshot_stop(reflector_ctx_t *rctx)
+{
+	if (!rctx->snapshot_running) {
+		return;
+	}
+	rctx->snapshot_running = false;
+
+#ifdef __APPLE__
+	dispatch_source_cancel(rctx->snapshot_timer);
+	/* Drain a handler already in flight */
+	dispatch_sync(rctx->snapshot_queue, ^{
+	});
+	dispatch_release(rctx->snapshot_timer);
+	dispatch_release(rctx->snapshot_queue);
+	rctx->snapshot_timer = NULL;
+	rctx->snapshot_queue = NULL;
+#else
+	pthread_join(rctx->snapshot_tid, NULL);
+#endif
+
+	reflector_publish_snapshot(rctx);
+	stats_shm_close(rctx);
+}
+
 /* Set configuration */
 int reflector_set_config(reflector_ctx_t *rctx, const reflector_config_t *config)
 {
@@ -762,14 +1573,16 @@ int reflector_set_config(reflector_ctx_t *rctx, const reflector_config_t *config
 
 	memcpy(&rctx->config, config, sizeof(reflector_config_t));
 
-	/* Cap num_workers to reasonable maximum */
-	if (rctx->config.num_workers > MAX_WORKERS) {
-		reflector_log(LOG_WARN, "Capping num_workers from %d to %d", rctx->config.num_workers,
-		              MAX_WORKERS);
-		rctx->config.num_workers = MAX_WORKERS;
+	clamp_num_workers(&rctx->config);
+
+	/* Worker stack arrays are sized for MAX_BATCH_SIZE */
+	if (rctx->config.batch_size > MAX_BATCH_SIZE) {
+		reflector_log(LOG_WARN, "Capping batch_size from %d to %d", rctx->config.batch_size,
+		              MAX_BATCH_SIZE);
+		rctx->config.batch_size = MAX_BATCH_SIZE;
 	}
-	if (rctx->config.num_workers < 1) {
-		rctx->config.num_workers = 1;
+	if (rctx->config.batch_size < 1) {
+		rctx->config.batch_size = BATCH_SIZE;
 	}
 
 	return 0;
@@ -43,10 +43,17 @@ void print_stats_text(const reflector_stats_t *stats, double elapsed)
 		       stats->sig_dataot_count, stats->sig_latency_count);
 	}
 
+	/* TX drops, with the share lost to a full TX backlog */
+	if (stats->err_tx_failed > 0) {
+		printf(" | TX failed: %" PRIu64 " (backpressure %" PRIu64 ")", stats->err_tx_failed,
+		       stats->err_tx_backpressure);
+	}
+
 	/* Show latency if measured */
 	if (stats->latency.count > 0) {
-		printf(" | Latency: %.1f/%.1f/%.1f us (min/avg/max)", stats->latency.min_ns / 1000.0,
-		       stats->latency.avg_ns / 1000.0, stats->latency.max_ns / 1000.0);
+		printf(" | Latency: %.1f/%.1f/%.1f/%.1f us (min/avg/p99/max)",
+		       stats->latency.min_ns / 1000.0, stats->latency.avg_ns / 1000.0,
+		       stats->latency.p99_ns / 1000.0, stats->latency.max_ns / 1000.0);
 	}
 
 	printf("   ");
@@ -61,7 +68,28 @@ void print_usage(const char *prog)
 	fprintf(stderr, "  --json              Output statistics in JSON format\n");
 	fprintf(stderr, "  --csv               Output statistics in CSV format\n");
 	fprintf(stderr, "  --latency           Enable latency measurements\n");
+	fprintf(stderr, "  --latency-per-packet  Read the clock per packet (default: once per burst)\n");
+	fprintf(stderr, "  --hw-timestamp      Use NIC RX timestamps (PHC calibrated at start)\n");
 	fprintf(stderr, "  --stats-interval N  Statistics update interval in seconds (default: 10)\n");
+	fprintf(stderr, "  --shm               Publish live stats in shared memory %s<interface>\n",
+	        REFLECTOR_SHM_PREFIX);
+	fprintf(stderr, "  --snapshot-ms N     Stats snapshot period in ms (default with --shm: %d)\n",
+	        REFLECTOR_SHM_DEFAULT_INTERVAL_MS);
+	fprintf(stderr, "  --busy-poll         Workers always spin, never sleep when idle\n");
+#ifdef ENABLE_HOT_PATH_PROFILE
+	fprintf(stderr, "  --profile           Count cycles per worker-loop phase (PMU/rdpmc)\n");
+#endif
+	fprintf(stderr, "  --idle-spin N       Empty polls before an idle worker sleeps (default: %d)\n",
+	        IDLE_SPIN_POLLS);
+	fprintf(stderr, "  --batch N           RX burst size, 1-%d (default: %d)\n", MAX_BATCH_SIZE,
+	        BATCH_SIZE);
+	fprintf(stderr, "  --adaptive-batch    Adapt bursts to load, up to --batch\n");
+	fprintf(stderr, "  --block-timeout MS  AF_PACKET V3 block retire timeout (default: %d)\n",
+	        PACKET_BLOCK_TIMEOUT_MS);
+	fprintf(stderr, "\nCPU Placement (Linux):\n");
+	fprintf(stderr, "  --cpus LIST         Pin workers to these CPUs in order, e.g. 2-5,8\n");
+	fprintf(stderr, "  --avoid-smt         Auto placement: one worker per physical core\n");
+	fprintf(stderr, "  --avoid-irq-cpus    Auto placement: keep workers off the queues' IRQ CPUs\n");
 	fprintf(stderr, "\nPacket Filtering Options:\n");
 	fprintf(stderr, "  --port N            ITO UDP port to match (default: 3842, 0 = any)\n");
 	fprintf(stderr, "  --no-oui-filter     Disable source MAC OUI filtering\n");
@@ -72,6 +100,14 @@ void print_usage(const char *prog)
 	fprintf(stderr, "                        mac    = Ethernet MAC only\n");
 	fprintf(stderr, "                        mac-ip = MAC + IP addresses\n");
 	fprintf(stderr, "                        all    = MAC + IP + UDP ports\n");
+	fprintf(stderr, "  --sw-checksum       Fix up IP/UDP checksums (NIC offload with --dpdk)\n");
+#if HAVE_AF_XDP
+	fprintf(stderr, "  --xdp-tx            Reflect in the XDP program (XDP_TX), bypassing userspace\n");
+	fprintf(stderr, "  --shared-umem       Share one hugepage-backed UMEM across all AF_XDP queues\n");
+	fprintf(stderr, "  --huge-pages        Back the AF_XDP UMEM with huge pages\n");
+	fprintf(stderr, "  --frame-size N      AF_XDP UMEM frame size: 2048 or 4096 (default: 4096)\n");
+	fprintf(stderr, "  --umem-frames N     AF_XDP UMEM frames per queue (default: 4096)\n");
+#endif
 	fprintf(stderr, "\nSignature Filter:\n");
 	fprintf(stderr, "  --sig FILTER        Which signatures to accept (default: all)\n");
 	fprintf(stderr, "                        all     = All known signatures\n");
@@ -83,7 +119,17 @@ void print_usage(const char *prog)
 	fprintf(stderr, "\nDPDK Options (100G line-rate mode):\n");
 	fprintf(stderr, "  --dpdk              Use DPDK instead of AF_XDP (requires NIC binding)\n");
 	fprintf(stderr, "  --dpdk-args ARGS    Pass arguments to DPDK EAL (e.g., \"--lcores=1-4\")\n");
+	fprintf(stderr, "  --dpdk-mtu N        Port MTU, e.g. 9000 for jumbo (default: device)\n");
 #endif
+	fprintf(stderr, "\nVirtual NIC (interface \"%s\": in-memory, no NIC or root needed):\n",
+	        VNIC_IFNAME);
+	fprintf(stderr, "  --vnic-pcap FILE    Replay frames from FILE (default: synthetic PROBEOT)\n");
+	fprintf(stderr, "  --vnic-write FILE   Capture reflected frames to FILE (default: count)\n");
+	fprintf(stderr, "  --vnic-count N      Frames to inject per worker (default: unlimited)\n");
+	fprintf(stderr, "  --vnic-size N       Synthetic frame length in bytes (default: 64)\n");
+	fprintf(stderr, "  --vnic-workers N    Worker threads, 1-%d (default: 1)\n", MAX_WORKERS);
+	fprintf(stderr, "  --vnic-tx-ring N    Bounded TX ring of N frames (default: unbounded)\n");
+	fprintf(stderr, "  --vnic-tx-stall     TX ring never completes (needs --vnic-tx-ring)\n");
 	fprintf(stderr, "\n  -h, --help          Show this help message\n");
 }
 
@@ -105,6 +151,20 @@ int main(int argc, char **argv)
 	const char *ifname = argv[1];
 	bool verbose = false;
 	bool measure_latency = false;
+	bool latency_per_packet = false;
+	bool hw_timestamps = false;
+	int worker_cpus[MAX_WORKERS] = {0};
+	int num_worker_cpus = 0;
+	bool avoid_smt = false;
+	bool avoid_irq_cpus = false;
+	bool busy_poll = false;
+	bool profile_hot_path = false;
+	bool stats_shm = false;
+	int snapshot_interval_ms = 0;
+	int idle_spin_polls = IDLE_SPIN_POLLS;
+	int batch_size = BATCH_SIZE;
+	bool adaptive_batch = false;
+	int block_timeout_ms = PACKET_BLOCK_TIMEOUT_MS;
 
 	/* ITO packet filtering defaults */
 	uint16_t ito_port = ITO_UDP_PORT; /* Default port 3842 */
@@ -113,10 +173,24 @@ int main(int argc, char **argv)
 	uint8_t oui[3] = {NETALLY_OUI_BYTE0, NETALLY_OUI_BYTE1, NETALLY_OUI_BYTE2};
 	reflect_mode_t reflect_mode = REFLECT_MODE_ALL;
 	sig_filter_t sig_filter = SIG_FILTER_ALL; /* Accept all signatures by default */
+	bool xdp_tx = false;
+	bool software_checksum = false;
+	char *vnic_rx_pcap = NULL;
+	char *vnic_tx_pcap = NULL;
+	uint64_t vnic_rx_count = 0;
+	int vnic_frame_len = 0;
+	int vnic_workers = 0;
+	uint32_t vnic_tx_ring = 0;
+	bool vnic_tx_stall = false;
+	bool shared_umem = false;
+	bool huge_pages = false;
+	int frame_size = 0;  /* 0 = default */
+	int umem_frames = 0; /* 0 = default */
 
 #if HAVE_DPDK
 	bool use_dpdk = false;
 	char *dpdk_args = NULL;
+	int dpdk_mtu = 0;
 #endif
 
 	/* Parse options */
@@ -129,6 +203,95 @@ int main(int argc, char **argv)
 			g_stats_format = STATS_FORMAT_CSV;
 		} else if (strcmp(argv[i], "--latency") == 0) {
 			measure_latency = true;
+		} else if (strcmp(argv[i], "--latency-per-packet") == 0) {
+			measure_latency = true;
+			latency_per_packet = true;
+		} else if (strcmp(argv[i], "--hw-timestamp") == 0) {
+			measure_latency = true;
+			hw_timestamps = true;
+		} else if (strcmp(argv[i], "--cpus") == 0) {
+			if (i + 1 < argc) {
+				num_worker_cpus = parse_cpu_list(argv[++i], worker_cpus, MAX_WORKERS);
+				if (num_worker_cpus < 0) {
+					fprintf(stderr, "Invalid CPU list: %s (e.g. 0-3,8; at most %d CPUs)\n",
+					        argv[i], MAX_WORKERS);
+					return 1;
+				}
+			} else {
+				fprintf(stderr, "Missing value for --cpus\n");
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--avoid-smt") == 0) {
+			avoid_smt = true;
+		} else if (strcmp(argv[i], "--avoid-irq-cpus") == 0) {
+			avoid_irq_cpus = true;
+		} else if (strcmp(argv[i], "--busy-poll") == 0) {
+			busy_poll = true;
+		} else if (strcmp(argv[i], "--profile") == 0) {
+#ifdef ENABLE_HOT_PATH_PROFILE
+			profile_hot_path = true;
+#else
+			fprintf(stderr, "--profile needs a build with PROFILE=1\n");
+			return 1;
+#endif
+		} else if (strcmp(argv[i], "--shm") == 0) {
+			stats_shm = true;
+		} else if (strcmp(argv[i], "--snapshot-ms") == 0) {
+			if (i + 1 < argc) {
+				char *endptr;
+				long val = strtol(argv[++i], &endptr, 10);
+				if (*endptr != '\0' || val < 1 || val > 3600000) {
+					fprintf(stderr, "Invalid snapshot period: %s (must be 1-3600000 ms)\n",
+					        argv[i]);
+					return 1;
+				}
+				snapshot_interval_ms = (int)val;
+			} else {
+				fprintf(stderr, "Missing value for --snapshot-ms\n");
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--idle-spin") == 0) {
+			if (i + 1 < argc) {
+				char *endptr;
+				long val = strtol(argv[++i], &endptr, 10);
+				if (*endptr != '\0' || val < 0 || val > INT_MAX) {
+					fprintf(stderr, "Invalid idle spin count: %s\n", argv[i]);
+					return 1;
+				}
+				idle_spin_polls = (int)val;
+			} else {
+				fprintf(stderr, "Missing value for --idle-spin\n");
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--batch") == 0) {
+			if (i + 1 < argc) {
+				char *endptr;
+				long val = strtol(argv[++i], &endptr, 10);
+				if (*endptr != '\0' || val < 1 || val > MAX_BATCH_SIZE) {
+					fprintf(stderr, "Invalid batch size: %s (must be 1-%d)\n", argv[i],
+					        MAX_BATCH_SIZE);
+					return 1;
+				}
+				batch_size = (int)val;
+			} else {
+				fprintf(stderr, "Missing value for --batch\n");
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--adaptive-batch") == 0) {
+			adaptive_batch = true;
+		} else if (strcmp(argv[i], "--block-timeout") == 0) {
+			if (i + 1 < argc) {
+				char *endptr;
+				long val = strtol(argv[++i], &endptr, 10);
+				if (*endptr != '\0' || val < 0 || val > 1000) {
+					fprintf(stderr, "Invalid block timeout: %s (must be 0-1000 ms)\n", argv[i]);
+					return 1;
+				}
+				block_timeout_ms = (int)val;
+			} else {
+				fprintf(stderr, "Missing value for --block-timeout\n");
+				return 1;
+			}
 		} else if (strcmp(argv[i], "--stats-interval") == 0) {
 			if (i + 1 < argc) {
 				char *endptr;
@@ -212,9 +375,111 @@ int main(int argc, char **argv)
 				fprintf(stderr, "Missing value for --sig\n");
 				return 1;
 			}
+		} else if (strcmp(argv[i], "--sw-checksum") == 0) {
+			software_checksum = true;
+		} else if (strcmp(argv[i], "--vnic-pcap") == 0 || strcmp(argv[i], "--vnic-write") == 0) {
+			if (i + 1 < argc) {
+				if (strcmp(argv[i], "--vnic-pcap") == 0) {
+					vnic_rx_pcap = argv[++i];
+				} else {
+					vnic_tx_pcap = argv[++i];
+				}
+			} else {
+				fprintf(stderr, "Missing value for %s\n", argv[i]);
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--vnic-count") == 0) {
+			if (i + 1 < argc) {
+				char *endptr;
+				unsigned long long val = strtoull(argv[++i], &endptr, 10);
+				if (*endptr != '\0' || argv[i][0] == '-') {
+					fprintf(stderr, "Invalid frame count: %s\n", argv[i]);
+					return 1;
+				}
+				vnic_rx_count = (uint64_t)val;
+			} else {
+				fprintf(stderr, "Missing value for --vnic-count\n");
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--vnic-size") == 0) {
+			if (i + 1 < argc) {
+				char *endptr;
+				long val = strtol(argv[++i], &endptr, 10);
+				if (*endptr != '\0' || val < MIN_ITO_PACKET_LEN || val > 16384) {
+					fprintf(stderr, "Invalid frame length: %s (%d-16384)\n", argv[i],
+					        MIN_ITO_PACKET_LEN);
+					return 1;
+				}
+				vnic_frame_len = (int)val;
+			} else {
+				fprintf(stderr, "Missing value for --vnic-size\n");
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--vnic-workers") == 0) {
+			if (i + 1 < argc) {
+				char *endptr;
+				long val = strtol(argv[++i], &endptr, 10);
+				if (*endptr != '\0' || val < 1 || val > MAX_WORKERS) {
+					fprintf(stderr, "Invalid worker count: %s (1-%d)\n", argv[i], MAX_WORKERS);
+					return 1;
+				}
+				vnic_workers = (int)val;
+			} else {
+				fprintf(stderr, "Missing value for --vnic-workers\n");
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--vnic-tx-ring") == 0) {
+			if (i + 1 < argc) {
+				char *endptr;
+				long val = strtol(argv[++i], &endptr, 10);
+				if (*endptr != '\0' || val < 1 || val > UINT32_MAX) {
+					fprintf(stderr, "Invalid TX ring size: %s\n", argv[i]);
+					return 1;
+				}
+				vnic_tx_ring = (uint32_t)val;
+			} else {
+				fprintf(stderr, "Missing value for --vnic-tx-ring\n");
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--vnic-tx-stall") == 0) {
+			vnic_tx_stall = true;
 		} else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
 			print_usage(argv[0]);
 			return 0;
+#if HAVE_AF_XDP
+		} else if (strcmp(argv[i], "--xdp-tx") == 0) {
+			xdp_tx = true;
+		} else if (strcmp(argv[i], "--shared-umem") == 0) {
+			shared_umem = true;
+		} else if (strcmp(argv[i], "--huge-pages") == 0) {
+			huge_pages = true;
+		} else if (strcmp(argv[i], "--frame-size") == 0) {
+			if (i + 1 < argc) {
+				char *endptr;
+				long val = strtol(argv[++i], &endptr, 10);
+				if (*endptr != '\0' || (val != 2048 && val != 4096)) {
+					fprintf(stderr, "Invalid frame size: %s (must be 2048 or 4096)\n", argv[i]);
+					return 1;
+				}
+				frame_size = (int)val;
+			} else {
+				fprintf(stderr, "Missing value for --frame-size\n");
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--umem-frames") == 0) {
+			if (i + 1 < argc) {
+				char *endptr;
+				long val = strtol(argv[++i], &endptr, 10);
+				if (*endptr != '\0' || val <= 0 || val > 1L << 20) {
+					fprintf(stderr, "Invalid UMEM frame count: %s\n", argv[i]);
+					return 1;
+				}
+				umem_frames = (int)val;
+			} else {
+				fprintf(stderr, "Missing value for --umem-frames\n");
+				return 1;
+			}
+#endif
 #if HAVE_DPDK
 		} else if (strcmp(argv[i], "--dpdk") == 0) {
 			use_dpdk = true;
@@ -225,6 +490,19 @@ int main(int argc, char **argv)
 				fprintf(stderr, "Missing value for --dpdk-args\n");
 				return 1;
 			}
+		} else if (strcmp(argv[i], "--dpdk-mtu") == 0) {
+			if (i + 1 < argc) {
+				char *endptr;
+				long val = strtol(argv[++i], &endptr, 10);
+				if (*endptr != '\0' || val < 68 || val > 65535) {
+					fprintf(stderr, "Invalid MTU: %s\n", argv[i]);
+					return 1;
+				}
+				dpdk_mtu = (int)val;
+			} else {
+				fprintf(stderr, "Missing value for --dpdk-mtu\n");
+				return 1;
+			}
 #endif
 		} else {
 			fprintf(stderr, "Unknown option: %s\n", argv[i]);
@@ -251,8 +529,24 @@ int main(int argc, char **argv)
 
 	/* Configure options */
 	g_rctx.config.measure_latency = measure_latency;
+	g_rctx.config.latency_per_packet = latency_per_packet;
+	g_rctx.config.hw_timestamps = hw_timestamps;
 	g_rctx.config.stats_format = g_stats_format;
 	g_rctx.config.stats_interval_sec = g_stats_interval;
+	g_rctx.config.busy_poll = busy_poll;
+	g_rctx.config.profile_hot_path = profile_hot_path;
+	g_rctx.config.stats_shm = stats_shm;
+	g_rctx.config.snapshot_interval_ms = snapshot_interval_ms;
+	g_rctx.config.idle_spin_polls = idle_spin_polls;
+	g_rctx.config.batch_size = batch_size;
+	g_rctx.config.adaptive_batch = adaptive_batch;
+	g_rctx.config.block_timeout_ms = block_timeout_ms;
+
+	/* Worker placement */
+	memcpy(g_rctx.config.worker_cpus, worker_cpus, sizeof(worker_cpus));
+	g_rctx.config.num_worker_cpus = num_worker_cpus;
+	g_rctx.config.avoid_smt_siblings = avoid_smt;
+	g_rctx.config.avoid_irq_cpus = avoid_irq_cpus;
 
 	/* ITO filtering options */
 	g_rctx.config.ito_port = ito_port;
@@ -261,10 +555,30 @@ int main(int argc, char **argv)
 	memcpy(g_rctx.config.oui, oui, 3);
 	g_rctx.config.reflect_mode = reflect_mode;
 	g_rctx.config.sig_filter = sig_filter;
+	g_rctx.config.xdp_tx = xdp_tx;
+	g_rctx.config.software_checksum = software_checksum;
+	g_rctx.config.vnic_rx_pcap = vnic_rx_pcap;
+	g_rctx.config.vnic_tx_pcap = vnic_tx_pcap;
+	g_rctx.config.vnic_rx_count = vnic_rx_count;
+	g_rctx.config.vnic_frame_len = vnic_frame_len;
+	g_rctx.config.vnic_tx_ring = vnic_tx_ring;
+	g_rctx.config.vnic_tx_stall = vnic_tx_stall;
+	if (vnic_workers > 0 && is_vnic_ifname(ifname)) {
+		g_rctx.config.num_workers = vnic_workers;
+	}
+	g_rctx.config.shared_umem = shared_umem;
+	g_rctx.config.use_huge_pages = huge_pages;
+	if (frame_size > 0) {
+		g_rctx.config.frame_size = frame_size;
+	}
+	if (umem_frames > 0) {
+		g_rctx.config.num_frames = umem_frames;
+	}
 
 #if HAVE_DPDK
 	g_rctx.config.use_dpdk = use_dpdk;
 	g_rctx.config.dpdk_args = dpdk_args;
+	g_rctx.config.dpdk_mtu = dpdk_mtu;
 #endif
 
 	if (reflector_start(&g_rctx) < 0) {
@@ -276,7 +590,9 @@ int main(int argc, char **argv)
 	if (g_stats_format == STATS_FORMAT_TEXT) {
 		printf("Reflector running... Press Ctrl-C to stop\n");
 		if (measure_latency) {
-			printf("Latency measurement: ENABLED\n");
+			printf("Latency measurement: ENABLED (clock: %s, %s%s)\n", fast_clock_source(),
+			       latency_per_packet ? "per packet" : "per burst",
+			       hw_timestamps ? ", NIC RX timestamps" : "");
 		}
 		printf("\n");
 	}
@@ -344,10 +660,37 @@ int main(int argc, char **argv)
 			printf("  Min latency:       %.2f us\n", final_stats.latency.min_ns / 1000.0);
 			printf("  Avg latency:       %.2f us\n", final_stats.latency.avg_ns / 1000.0);
 			printf("  Max latency:       %.2f us\n", final_stats.latency.max_ns / 1000.0);
+			printf("  p50 / p99:         %.2f / %.2f us\n", final_stats.latency.p50_ns / 1000.0,
+			       final_stats.latency.p99_ns / 1000.0);
+			printf("  p99.9 / p99.99:    %.2f / %.2f us\n", final_stats.latency.p999_ns / 1000.0,
+			       final_stats.latency.p9999_ns / 1000.0);
+		}
+		if (measure_latency && final_stats.latency.rejected > 0) {
+			printf("  Rejected samples:  %" PRIu64 " (RX stamp after TX)\n",
+			       final_stats.latency.rejected);
+		}
+		if (final_stats.profile.packets > 0) {
+			const hot_path_profile_t *prof = &final_stats.profile;
+			printf("\nHot-Path Profile (per packet, %s cycles):\n",
+			       prof->tsc_cycles ? "TSC" : "PMU");
+			for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+				printf("  %-9s %8.1f cycles", prof_phase_name((prof_phase_t)p),
+				       (double)prof->counts[p][PROF_EVENT_CYCLES] / prof->packets);
+				if (prof->events & (1U << PROF_EVENT_INSTRUCTIONS)) {
+					printf(" %8.1f instructions",
+					       (double)prof->counts[p][PROF_EVENT_INSTRUCTIONS] / prof->packets);
+				}
+				if (prof->events & (1U << PROF_EVENT_CACHE_MISSES)) {
+					printf(" %6.3f cache misses",
+					       (double)prof->counts[p][PROF_EVENT_CACHE_MISSES] / prof->packets);
+				}
+				printf("\n");
+			}
 		}
 		if (final_stats.tx_errors > 0 || final_stats.rx_invalid > 0) {
 			printf("\nErrors:\n");
 			printf("  TX errors:         %" PRIu64 "\n", final_stats.tx_errors);
+			printf("    backpressure:    %" PRIu64 "\n", final_stats.err_tx_backpressure);
 			printf("  RX invalid:        %" PRIu64 "\n", final_stats.rx_invalid);
 		}
 	} else {
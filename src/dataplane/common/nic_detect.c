@@ -192,6 +192,33 @@ int get_nic_speed(const char *ifname)
 #endif
 }
 
+/*
+ * Get the NUMA node the NIC is attached to from sysfs
+ */
+int get_nic_numa_node(const char *ifname)
+{
+#ifdef __linux__
+	char path[256];
+	char buf[32];
+
+	if (!ifname || ifname[0] == '\0') {
+		return -1;
+	}
+
+	snprintf(path, sizeof(path), "/sys/class/net/%s/device/numa_node", ifname);
+	if (read_sysfs_str(path, buf, sizeof(buf)) < 0) {
+		return -1;
+	}
+
+	/* Kernel reports -1 on single-node systems and for virtual devices */
+	int node = atoi(buf);
+	return node >= 0 ? node : -1;
+#else
+	(void)ifname;
+	return -1;
+#endif
+}
+
 /*
  * Detect NIC capabilities and print recommendations
  */
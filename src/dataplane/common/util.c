@@ -7,8 +7,10 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 
+#include <ctype.h>
 #include <errno.h>
 #include <grp.h>
+#include <inttypes.h>
 #include <pwd.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -34,7 +36,18 @@
 
 #ifdef __linux__
 #include <linux/ethtool.h>
+#include <linux/mempolicy.h>
 #include <linux/sockios.h>
+
+#include <sys/syscall.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
 #endif
 
 #ifdef __APPLE__
@@ -218,22 +231,202 @@ int get_num_rx_queues(const char *ifname)
 #endif
 }
 
+/*
+ * Parse a CPU list in sysfs/taskset syntax ("0-3,8,10-11")
+ * Returns number of CPUs written to cpus, or -EINVAL if the list is malformed
+ * or names more than max_cpus CPUs.
+ */
+int parse_cpu_list(const char *list, int *cpus, int max_cpus)
+{
+	int n = 0;
+	const char *p = list;
+
+	if (!list) {
+		return -EINVAL;
+	}
+
+	while (*p && !isspace((unsigned char)*p)) {
+		char *end;
+		long first = strtol(p, &end, 10);
+		if (end == p || first < 0 || first >= PLACEMENT_MAX_CPUS) {
+			return -EINVAL;
+		}
+		long last = first;
+		p = end;
+		if (*p == '-') {
+			p++;
+			last = strtol(p, &end, 10);
+			if (end == p || last < first || last >= PLACEMENT_MAX_CPUS) {
+				return -EINVAL;
+			}
+			p = end;
+		}
+		for (long cpu = first; cpu <= last; cpu++) {
+			if (n >= max_cpus) {
+				return -EINVAL;
+			}
+			cpus[n++] = (int)cpu;
+		}
+		if (*p == ',') {
+			p++;
+			if (!*p) {
+				return -EINVAL;
+			}
+		} else if (*p && !isspace((unsigned char)*p)) {
+			return -EINVAL;
+		}
+	}
+
+	return n > 0 ? n : -EINVAL;
+}
+
+/*
+ * Does a /proc/interrupts IRQ name belong to an interface's RX queue? The
+ * interface name must be a whole token (start of name or after a non-alnum,
+ * followed by '-' or ':'), so eth1 doesn't match eth10-TxRx-0 or veth1-rx-0.
+ * mlx5 names carry the PCI address instead: "mlx5_comp<q>@pci:<bdf>".
+ */
+bool irq_name_matches_queue(const char *name, const char *ifname, const char *bdf, int queue_id)
+{
+	char suffix_dash[16], suffix_us[16], mlx5[32];
+	size_t name_len = strlen(name);
+	size_t if_len = strlen(ifname);
+
+	snprintf(suffix_dash, sizeof(suffix_dash), "-%d", queue_id);
+	snprintf(suffix_us, sizeof(suffix_us), "_%d", queue_id);
+	snprintf(mlx5, sizeof(mlx5), "comp%d@", queue_id);
+
+	if (bdf && bdf[0] && strstr(name, mlx5) && strstr(name, bdf)) {
+		return true;
+	}
+
+	size_t sfx_len = strlen(suffix_dash);
+	if (if_len == 0 || name_len <= sfx_len ||
+	    (strcmp(name + name_len - sfx_len, suffix_dash) != 0 &&
+	     strcmp(name + name_len - sfx_len, suffix_us) != 0)) {
+		return false;
+	}
+
+	for (const char *p = strstr(name, ifname); p; p = strstr(p + 1, ifname)) {
+		bool starts = p == name || !isalnum((unsigned char)p[-1]);
+		bool ends = p[if_len] == '-' || p[if_len] == ':';
+		if (starts && ends) {
+			return true;
+		}
+	}
+	return false;
+}
+
+#ifdef __linux__
+/* Read a CPU list file from sysfs/procfs; returns count or -1 */
+static int read_cpu_list_file(const char *path, int *cpus, int max_cpus)
+{
+	char buf[1024];
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		return -1;
+	}
+	char *line = fgets(buf, sizeof(buf), f);
+	fclose(f);
+	if (!line) {
+		return -1;
+	}
+	int n = parse_cpu_list(buf, cpus, max_cpus);
+	return n > 0 ? n : -1;
+}
+
+/*
+ * Find the IRQ serving an RX queue by its /proc/interrupts name. Drivers name
+ * them "<ifname>-TxRx-<q>" (ixgbe/i40e/ice), "<ifname>-rx-<q>", or
+ * "mlx5_comp<q>@pci:<bdf>" (mlx5, which doesn't use the interface name).
+ */
+static int get_queue_irq(const char *ifname, int queue_id)
+{
+	char path[256], link[256], line[1024];
+	const char *bdf = NULL;
+	int irq = -1;
+
+	snprintf(path, sizeof(path), "/sys/class/net/%s/device", ifname);
+	ssize_t len = readlink(path, link, sizeof(link) - 1);
+	if (len > 0) {
+		link[len] = '\0';
+		const char *slash = strrchr(link, '/');
+		bdf = slash ? slash + 1 : link;
+	}
+
+	FILE *f = fopen("/proc/interrupts", "r");
+	if (!f) {
+		return -1;
+	}
+
+	while (irq < 0 && fgets(line, sizeof(line), f)) {
+		char *colon = strchr(line, ':');
+		if (!colon) {
+			continue;
+		}
+
+		/* IRQ name is the last whitespace-separated field */
+		char *name_end = line + strlen(line);
+		while (name_end > colon && isspace((unsigned char)name_end[-1])) {
+			*--name_end = '\0';
+		}
+		char *name = name_end;
+		while (name > colon && !isspace((unsigned char)name[-1])) {
+			name--;
+		}
+
+		if (irq_name_matches_queue(name, ifname, bdf, queue_id)) {
+			char *end;
+			long val = strtol(line, &end, 10);
+			if (end != line && end == colon) {
+				irq = (int)val;
+			}
+		}
+	}
+
+	fclose(f);
+	return irq;
+}
+
+/* First CPU in an IRQ's affinity list, or -1 */
+static int get_irq_cpu(int irq)
+{
+	char path[64];
+	int cpus[PLACEMENT_MAX_CPUS];
+
+	snprintf(path, sizeof(path), "/proc/irq/%d/smp_affinity_list", irq);
+	return read_cpu_list_file(path, cpus, PLACEMENT_MAX_CPUS) > 0 ? cpus[0] : -1;
+}
+
+/* True if cpu is not the first hardware thread of its core */
+static bool cpu_is_smt_secondary(int cpu)
+{
+	char path[128];
+	int siblings[PLACEMENT_MAX_CPUS];
+
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list",
+	         cpu);
+	int n = read_cpu_list_file(path, siblings, PLACEMENT_MAX_CPUS);
+	return n > 1 && siblings[0] != cpu;
+}
+#endif
+
 /*
  * Get CPU affinity for a specific queue
  * Returns -1 if unable to determine
  *
- * On Linux, this reads /proc/irq/<irq>/smp_affinity to find which CPU
- * handles the IRQ for this queue. This is a best-effort heuristic.
+ * On Linux, this finds the queue's IRQ in /proc/interrupts and returns the
+ * first CPU of /proc/irq/<irq>/smp_affinity_list, falling back to
+ * round-robin when the IRQ can't be identified (virtual NICs, veth).
  */
 int get_queue_cpu_affinity(const char *ifname, int queue_id)
 {
 #ifdef __linux__
-	/*
-	 * Use simple round-robin CPU assignment for queue affinity.
-	 * For production use with IRQ affinity tuning, parse /proc/irq
-	 * or use ethtool --show-rxfh-indir to get actual queue-to-CPU mapping.
-	 */
-	(void)ifname;
+	int irq = get_queue_irq(ifname, queue_id);
+	int cpu = irq >= 0 ? get_irq_cpu(irq) : -1;
+	if (cpu >= 0) {
+		return cpu;
+	}
 	return queue_id % sysconf(_SC_NPROCESSORS_ONLN);
 #else
 	(void)ifname;
@@ -242,6 +435,275 @@ int get_queue_cpu_affinity(const char *ifname, int queue_id)
 #endif
 }
 
+/*
+ * Get the NUMA node a CPU belongs to
+ * Returns -1 if unknown (non-NUMA kernel, offline CPU, non-Linux)
+ */
+int get_cpu_numa_node(int cpu)
+{
+#ifdef __linux__
+	char path[64];
+	int node = -1;
+
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+	DIR *dir = opendir(path);
+	if (!dir) {
+		return -1;
+	}
+	struct dirent *de;
+	while ((de = readdir(dir)) != NULL) {
+		if (strncmp(de->d_name, "node", 4) == 0 && isdigit((unsigned char)de->d_name[4])) {
+			node = atoi(de->d_name + 4);
+			break;
+		}
+	}
+	closedir(dir);
+	return node;
+#else
+	(void)cpu;
+	return -1;
+#endif
+}
+
+/*
+ * Prefer allocations made by the calling thread on a NUMA node
+ * node < 0 restores the default (local) policy. Returns 0 or -errno.
+ */
+int set_thread_numa_node(int node)
+{
+#ifdef __linux__
+	unsigned long mask[PLACEMENT_MAX_CPUS / (8 * sizeof(unsigned long))] = {0};
+	const unsigned long bits = 8 * sizeof(mask[0]);
+	long ret;
+
+	if (node < 0) {
+		ret = syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+	} else if ((unsigned long)node < bits * (sizeof(mask) / sizeof(mask[0]))) {
+		mask[node / bits] = 1UL << (node % bits);
+		ret = syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, 8 * sizeof(mask));
+	} else {
+		return -EINVAL;
+	}
+	return ret == 0 ? 0 : -errno;
+#else
+	(void)node;
+	return -ENOTSUP;
+#endif
+}
+
+/*
+ * Build the worker -> CPU map
+ *
+ * Order of precedence:
+ *   1. cfg->worker_cpus (--cpus): worker i runs on entry i (wrapping)
+ *   2. cfg->cpu_affinity >= 0: consecutive CPUs starting there
+ *   3. Automatic: CPUs on the NIC's node (all CPUs if none qualify), minus SMT
+ *      secondaries and IRQ cores when asked. A worker takes its queue's IRQ
+ *      CPU when that is a candidate, so RX softirq and the worker share L1/L2;
+ *      otherwise the next unused candidate.
+ * Returns 0, or -1 if placement is not supported (cpus[] all set to -1).
+ */
+int plan_worker_cpus(const reflector_config_t *cfg, int nic_node, int num_workers, int *cpus)
+{
+#ifdef __linux__
+	long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nprocs < 1) {
+		nprocs = 1;
+	}
+
+	if (cfg->num_worker_cpus > 0) {
+		for (int i = 0; i < num_workers; i++) {
+			cpus[i] = cfg->worker_cpus[i % cfg->num_worker_cpus];
+		}
+		return 0;
+	}
+
+	if (cfg->cpu_affinity >= 0) {
+		for (int i = 0; i < num_workers; i++) {
+			cpus[i] = (int)((cfg->cpu_affinity + i) % nprocs);
+		}
+		return 0;
+	}
+
+	int online[PLACEMENT_MAX_CPUS];
+	int num_online = read_cpu_list_file("/sys/devices/system/cpu/online", online,
+	                                    PLACEMENT_MAX_CPUS);
+	if (num_online <= 0) {
+		num_online = nprocs < PLACEMENT_MAX_CPUS ? (int)nprocs : PLACEMENT_MAX_CPUS;
+		for (int c = 0; c < num_online; c++) {
+			online[c] = c;
+		}
+	}
+
+	/* IRQ CPU of each worker's queue (-1 = unknown, or no memory to look) */
+	int *irq_cpu = calloc((size_t)num_workers, sizeof(*irq_cpu));
+	for (int i = 0; irq_cpu && i < num_workers; i++) {
+		int irq = get_queue_irq(cfg->ifname, i);
+		irq_cpu[i] = irq >= 0 ? get_irq_cpu(irq) : -1;
+	}
+
+	int cand[PLACEMENT_MAX_CPUS];
+	int num_cand = 0;
+	for (int c = 0; c < num_online; c++) {
+		int cpu = online[c];
+		if (nic_node >= 0 && get_cpu_numa_node(cpu) != nic_node) {
+			continue;
+		}
+		if (cfg->avoid_smt_siblings && cpu_is_smt_secondary(cpu)) {
+			continue;
+		}
+		if (cfg->avoid_irq_cpus) {
+			bool is_irq = false;
+			for (int i = 0; irq_cpu && i < num_workers; i++) {
+				is_irq |= irq_cpu[i] == cpu;
+			}
+			if (is_irq) {
+				continue;
+			}
+		}
+		cand[num_cand++] = cpu;
+	}
+	if (num_cand == 0) {
+		reflector_log(LOG_WARN, "No CPUs match the placement constraints, using all online CPUs");
+		memcpy(cand, online, (size_t)num_online * sizeof(cand[0]));
+		num_cand = num_online;
+	}
+
+	bool used[PLACEMENT_MAX_CPUS] = {false};
+	int next = 0;
+	for (int i = 0; i < num_workers; i++) {
+		int pick = -1;
+
+		if (irq_cpu && irq_cpu[i] >= 0 && !cfg->avoid_irq_cpus) {
+			for (int c = 0; c < num_cand; c++) {
+				if (cand[c] == irq_cpu[i] && !used[c]) {
+					pick = c;
+					break;
+				}
+			}
+		}
+		for (int tries = 0; pick < 0 && tries < num_cand; tries++) {
+			int c = (next + tries) % num_cand;
+			if (!used[c]) {
+				pick = c;
+				next = c + 1;
+			}
+		}
+		if (pick < 0) {
+			pick = i % num_cand; /* More workers than candidates: share */
+		}
+
+		used[pick] = true;
+		cpus[i] = cand[pick];
+	}
+	free(irq_cpu);
+	return 0;
+#else
+	(void)cfg;
+	(void)nic_node;
+	for (int i = 0; i < num_workers; i++) {
+		cpus[i] = -1;
+	}
+	return -1;
+#endif
+}
+
+/*
+ * Burst size controller: fixed at batch_size, or adaptive starting from the
+ * floor (an idle reflector should answer its first probe with minimal delay).
+ */
+void burst_ctl_init(burst_ctl_t *bc, int batch_size, bool adaptive)
+{
+	if (batch_size < 1) {
+		batch_size = BATCH_SIZE;
+	} else if (batch_size > MAX_BATCH_SIZE) {
+		batch_size = MAX_BATCH_SIZE;
+	}
+
+	bc->max = batch_size;
+	bc->min = adaptive && batch_size > ADAPTIVE_BATCH_MIN ? ADAPTIVE_BATCH_MIN : batch_size;
+	bc->size = bc->min;
+	bc->light_bursts = 0;
+}
+
+/*
+ * TX backlog (see tx_backlog_t). The queue is a power-of-two ring, so a flush
+ * submits at most two contiguous runs.
+ */
+uint32_t tx_backlog_flush(worker_ctx_t *wctx, tx_backlog_t *bl, const tx_ring_ops_t *ops)
+{
+	uint32_t submitted = 0;
+
+	while (bl->count > 0) {
+		uint32_t run = TX_BACKLOG_SIZE - bl->head;
+		if (run > bl->count) {
+			run = bl->count;
+		}
+		uint32_t n = ops->submit(wctx, &bl->pkts[bl->head], run);
+		bl->head = (bl->head + n) & TX_BACKLOG_MASK;
+		bl->count -= n;
+		submitted += n;
+		if (n < run) {
+			break;
+		}
+	}
+	return submitted;
+}
+
+int tx_backlog_send(worker_ctx_t *wctx, tx_backlog_t *bl, const tx_ring_ops_t *ops,
+                    const packet_t *pkts, int n)
+{
+	/* Older frames first; new ones go straight to the ring only if none are left */
+	tx_backlog_flush(wctx, bl, ops);
+
+	int accepted = 0;
+	if (bl->count == 0) {
+		accepted = (int)ops->submit(wctx, pkts, (uint32_t)n);
+	}
+
+	/* Queue the remainder; with the backlog full, wait (bounded) for the ring to drain */
+	uint64_t deadline = 0;
+	while (accepted < n) {
+		if (bl->count < TX_BACKLOG_SIZE) {
+			bl->pkts[(bl->head + bl->count) & TX_BACKLOG_MASK] = pkts[accepted++];
+			bl->count++;
+			continue;
+		}
+
+		uint64_t now = fast_clock_ns();
+		if (deadline == 0) {
+			deadline = now + TX_BACKLOG_WAIT_NS;
+		} else if (now >= deadline) {
+			break;
+		}
+		ops->reclaim(wctx);
+		tx_backlog_flush(wctx, bl, ops);
+	}
+
+	/* Past the wait budget: drop the rest */
+	if (unlikely(accepted < n)) {
+		for (int i = accepted; i < n; i++) {
+			ops->drop(wctx, &pkts[i]);
+		}
+		worker_stats_write_begin(wctx);
+		wctx->stats.err_tx_backpressure += (uint64_t)(n - accepted);
+		worker_stats_write_end(wctx);
+	}
+
+	return accepted;
+}
+
+uint32_t tx_backlog_drop_all(worker_ctx_t *wctx, tx_backlog_t *bl, const tx_ring_ops_t *ops)
+{
+	uint32_t dropped = bl->count;
+
+	for (; bl->count > 0; bl->count--) {
+		ops->drop(wctx, &bl->pkts[bl->head]);
+		bl->head = (bl->head + 1) & TX_BACKLOG_MASK;
+	}
+	return dropped;
+}
+
 /*
  * Get high-resolution timestamp in nanoseconds
  */
@@ -254,6 +716,274 @@ uint64_t get_timestamp_ns(void)
 	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
 }
 
+/*
+ * Fast clock: invariant TSC (x86-64) or the generic timer (aarch64), scaled to
+ * nanoseconds with a mult/shift pair calibrated against CLOCK_MONOTONIC. A
+ * read is one counter load plus a multiply (no vDSO seqlock), which makes per-burst
+ * (and optionally per-packet) latency stamping affordable at line rate.
+ */
+#define FAST_CLOCK_SHIFT 32
+#define FAST_CLOCK_CALIBRATE_NS 20000000ULL /* 20 ms calibration window */
+
+static struct {
+	bool counter_ok;     /* Counter is usable; otherwise fall back to clock_gettime */
+	uint64_t base_ticks; /* Counter value at base_ns */
+	uint64_t base_ns;    /* CLOCK_MONOTONIC at base_ticks */
+	uint64_t mult;       /* ns = (ticks * mult) >> FAST_CLOCK_SHIFT */
+	uint64_t hz;         /* Calibrated counter frequency */
+	const char *source;
+	int64_t realtime_offset_ns; /* CLOCK_REALTIME - fast clock (see fast_clock_resync) */
+} fast_clock = {.source = "clock_gettime"};
+
+static inline uint64_t fast_clock_ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#elif defined(__aarch64__)
+	uint64_t ticks;
+	__asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+	return ticks;
+#else
+	return 0;
+#endif
+}
+
+static uint64_t realtime_ns(void)
+{
+	struct timespec ts;
+	if (clock_gettime(CLOCK_REALTIME, &ts) < 0) {
+		return 0;
+	}
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Sample the counter and CLOCK_MONOTONIC as a tight pair: take the counter on
+ * both sides of clock_gettime and keep the narrowest of a few attempts, so a
+ * preemption in between does not skew calibration.
+ */
+static void fast_clock_sample(uint64_t *ticks, uint64_t *ns)
+{
+	uint64_t best_window = UINT64_MAX;
+
+	for (int i = 0; i < 8; i++) {
+		uint64_t t0 = fast_clock_ticks();
+		uint64_t now = get_timestamp_ns();
+		uint64_t t1 = fast_clock_ticks();
+		if (t1 - t0 < best_window) {
+			best_window = t1 - t0;
+			*ticks = t0 + (t1 - t0) / 2;
+			*ns = now;
+		}
+	}
+}
+
+static bool fast_clock_counter_supported(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	/* CPUID 0x80000007 EDX bit 8: TSC is invariant across P/C-states */
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+		return false;
+	}
+	return (edx & (1u << 8)) != 0;
+#elif defined(__aarch64__)
+	return true; /* Generic timer is architecturally constant-rate */
+#else
+	return false;
+#endif
+}
+
+/*
+ * Calibrate the fast clock (call once before starting workers)
+ */
+int fast_clock_init(void)
+{
+	if (fast_clock.counter_ok) {
+		return 0;
+	}
+
+	if (!fast_clock_counter_supported()) {
+		reflector_log(LOG_INFO, "Fast clock: no invariant counter, using clock_gettime");
+		fast_clock_resync();
+		return -ENOTSUP;
+	}
+
+	uint64_t t0 = 0, ns0 = 0, t1 = 0, ns1 = 0;
+	fast_clock_sample(&t0, &ns0);
+	struct timespec delay = {.tv_sec = 0, .tv_nsec = (long)FAST_CLOCK_CALIBRATE_NS};
+	nanosleep(&delay, NULL);
+	fast_clock_sample(&t1, &ns1);
+
+	if (t1 <= t0 || ns1 <= ns0) {
+		reflector_log(LOG_WARN, "Fast clock: calibration failed, using clock_gettime");
+		fast_clock_resync();
+		return -EIO;
+	}
+
+	uint64_t hz = (uint64_t)(((unsigned __int128)(t1 - t0) * 1000000000ULL) / (ns1 - ns0));
+#if defined(__aarch64__)
+	/* The architected frequency is exact; prefer it when firmware set it */
+	uint64_t cntfrq;
+	__asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(cntfrq));
+	if (cntfrq != 0) {
+		hz = cntfrq;
+	}
+#endif
+	if (hz == 0) {
+		fast_clock_resync();
+		return -EIO;
+	}
+
+	fast_clock.hz = hz;
+	fast_clock.mult = (uint64_t)((1000000000ULL << FAST_CLOCK_SHIFT) / hz);
+	fast_clock.base_ticks = t1;
+	fast_clock.base_ns = ns1;
+#if defined(__aarch64__)
+	fast_clock.source = "cntvct";
+#else
+	fast_clock.source = "tsc";
+#endif
+	fast_clock.counter_ok = true;
+	fast_clock_resync();
+
+	reflector_log(LOG_INFO, "Fast clock: %s at %.3f MHz", fast_clock.source, (double)hz / 1e6);
+	return 0;
+}
+
+/*
+ * Read the fast clock (nanoseconds, CLOCK_MONOTONIC epoch)
+ */
+uint64_t fast_clock_ns(void)
+{
+	if (unlikely(!fast_clock.counter_ok)) {
+		return get_timestamp_ns();
+	}
+	uint64_t delta = fast_clock_ticks() - fast_clock.base_ticks;
+	return fast_clock.base_ns +
+	       (uint64_t)(((unsigned __int128)delta * fast_clock.mult) >> FAST_CLOCK_SHIFT);
+}
+
+/*
+ * Re-measure the CLOCK_REALTIME offset used by fast_clock_from_realtime()
+ */
+void fast_clock_resync(void)
+{
+	uint64_t before = fast_clock_ns();
+	uint64_t real = realtime_ns();
+	uint64_t after = fast_clock_ns();
+	int64_t offset = (int64_t)(real - (before + (after - before) / 2));
+	__atomic_store_n(&fast_clock.realtime_offset_ns, offset, __ATOMIC_RELAXED);
+}
+
+/*
+ * Convert a CLOCK_REALTIME timestamp (e.g. a kernel or PHC-synced NIC stamp)
+ */
+uint64_t fast_clock_from_realtime(uint64_t realtime_ns)
+{
+	return realtime_ns -
+	       (uint64_t)__atomic_load_n(&fast_clock.realtime_offset_ns, __ATOMIC_RELAXED);
+}
+
+#define PHC_CALIBRATE_TRIES 5
+
+/* Dynamic POSIX clock of an open /dev/ptpN */
+#define PHC_FD_TO_CLOCKID(fd) ((~(clockid_t)(fd) << 3) | 3)
+
+/*
+ * Open the PHC behind an interface and measure its offset
+ */
+int phc_clock_open(phc_clock_t *phc, const char *ifname)
+{
+	memset(phc, 0, sizeof(*phc));
+	phc->fd = -1;
+
+#ifdef __linux__
+	struct ethtool_ts_info info;
+	struct ifreq ifr;
+
+	int sock = socket(AF_INET, SOCK_DGRAM, 0);
+	if (sock < 0) {
+		return -errno;
+	}
+	memset(&info, 0, sizeof(info));
+	info.cmd = ETHTOOL_GET_TS_INFO;
+	memset(&ifr, 0, sizeof(ifr));
+	SAFE_STRNCPY(ifr.ifr_name, ifname, IFNAMSIZ);
+	ifr.ifr_data = (char *)&info;
+	int ret = ioctl(sock, SIOCETHTOOL, &ifr) < 0 ? -errno : 0;
+	close(sock);
+	if (ret < 0) {
+		return ret;
+	}
+	if (info.phc_index < 0) {
+		return -ENODEV;
+	}
+
+	char path[32];
+	snprintf(path, sizeof(path), "/dev/ptp%d", info.phc_index);
+	phc->fd = open(path, O_RDONLY);
+	if (phc->fd < 0) {
+		return -errno;
+	}
+	phc->active = true;
+	phc_clock_resync(phc);
+
+	reflector_log(LOG_DEBUG, "%s: PHC %s, %+" PRId64 " ns from the fast clock", ifname, path,
+	              phc->offset_ns);
+	return 0;
+#else
+	(void)ifname;
+	return -ENOTSUP;
+#endif
+}
+
+void phc_clock_close(phc_clock_t *phc)
+{
+	if (phc->active) {
+		close(phc->fd);
+		phc->active = false;
+		phc->fd = -1;
+	}
+}
+
+/*
+ * Re-measure the PHC offset: the read with the narrowest fast clock window
+ * bounds the error by half that window. A failed read keeps the old offset.
+ */
+void phc_clock_resync(phc_clock_t *phc)
+{
+#ifdef __linux__
+	uint64_t best_window = UINT64_MAX;
+
+	for (int i = 0; i < PHC_CALIBRATE_TRIES; i++) {
+		struct timespec ts;
+		uint64_t before = fast_clock_ns();
+		if (clock_gettime(PHC_FD_TO_CLOCKID(phc->fd), &ts) != 0) {
+			break;
+		}
+		uint64_t after = fast_clock_ns();
+		uint64_t phc_ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+
+		if (after - before < best_window) {
+			best_window = after - before;
+			phc->offset_ns = (int64_t)(phc_ns - (before + best_window / 2));
+			phc->synced_phc_ns = phc_ns;
+		}
+	}
+#else
+	(void)phc;
+#endif
+}
+
+/*
+ * Name of the fast clock source
+ */
+const char *fast_clock_source(void)
+{
+	return fast_clock.source;
+}
+
 /*
  * Set interface promiscuous mode
  */
@@ -19,12 +19,21 @@
 
 #include <errno.h>
 #include <rte_common.h>
+#include <rte_cpuflags.h>
+#include <rte_cycles.h>
 #include <rte_eal.h>
 #include <rte_ethdev.h>
 #include <rte_ether.h>
+#include <rte_flow.h>
+#include <rte_ip.h>
 #include <rte_lcore.h>
 #include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
 #include <rte_mempool.h>
+#include <rte_net.h>
+#include <rte_pause.h>
+#include <rte_power_intrinsics.h>
+#include <rte_udp.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -36,28 +45,57 @@
 #define DPDK_MBUF_CACHE 256
 #define DPDK_RX_DESC 1024
 #define DPDK_TX_DESC 1024
-#define DPDK_MAX_PKT_BURST 64
+#define DPDK_MAX_PKT_BURST MAX_BATCH_SIZE
+#define DPDK_CLOCK_CALIBRATE_US 10000 /* Device clock vs fast clock calibration */
+#define DPDK_IDLE_PAUSE_US 10         /* Idle pause-spin when the CPU can't monitor */
+#define DPDK_JUMBO_OVERHEAD (RTE_ETHER_HDR_LEN + RTE_ETHER_CRC_LEN + 2 * RTE_VLAN_HLEN)
+
+/*
+ * TX backlog: mbufs rte_eth_tx_burst() could not take yet (descriptor ring
+ * full). They are retried in FIFO order before new packets; when the backlog
+ * is full, send_batch retries for up to DPDK_TX_WAIT_US before dropping.
+ */
+#define DPDK_TX_BACKLOG_SIZE (2 * MAX_BATCH_SIZE) /* Power of two */
+#define DPDK_TX_BACKLOG_MASK (DPDK_TX_BACKLOG_SIZE - 1)
+#define DPDK_TX_WAIT_US 50
 
 /* Platform context (per-worker) */
 struct platform_ctx {
 	uint16_t port_id;
 	uint16_t queue_id;
-	struct rte_mempool *mbuf_pool;
+	struct rte_mempool *mbuf_pool; /* This queue's pool (NIC socket) */
 	struct rte_mbuf *rx_mbufs[DPDK_MAX_PKT_BURST];
 	struct rte_mbuf *tx_mbufs[DPDK_MAX_PKT_BURST];
-	int pending_rx;  /* Number of mbufs in rx_mbufs awaiting release */
-	bool is_primary; /* Worker 0 owns EAL/port initialization */
+	int pending_rx;         /* Number of mbufs in rx_mbufs awaiting release */
+	bool is_primary;        /* Worker 0 owns EAL/port initialization */
+	bool thread_registered; /* Worker thread has an EAL lcore id (mempool cache) */
+
+	/* TX backlog ring (see DPDK_TX_BACKLOG_SIZE) */
+	struct rte_mbuf *tx_backlog[DPDK_TX_BACKLOG_SIZE];
+	uint32_t tx_backlog_head; /* Oldest queued mbuf */
+	uint32_t tx_backlog_count;
 };
 
 /* Shared state (initialized by worker 0) */
 static struct {
 	bool initialized;
 	uint16_t port_id;
-	struct rte_mempool *mbuf_pool;
+	struct rte_mempool *mbuf_pools[MAX_WORKERS]; /* One per queue, on the NIC's socket */
 	uint16_t num_rx_queues;
 	uint16_t num_tx_queues;
 	struct rte_ether_addr mac_addr;
-} dpdk_shared = {.initialized = false};
+	bool power_monitor; /* CPU supports rte_power_monitor (UMWAIT/WFE) */
+
+	/* NIC RX timestamps (RTE_ETH_RX_OFFLOAD_TIMESTAMP), see dpdk_setup_rx_timestamp() */
+	bool rx_timestamp;
+	int ts_offset;       /* mbuf dynfield holding the device clock value */
+	uint64_t ts_flag;    /* ol_flags bit set when the dynfield is valid */
+	uint64_t ts_ns_mult; /* ns = (ticks * ts_ns_mult) >> 32 */
+
+	/* Hardware offloads, see dpdk_setup_flow_rules() / dpdk_tx_cksum_offload() */
+	bool hw_filter; /* rte_flow rules steer reflector traffic, drop the rest */
+	bool tx_cksum;  /* NIC fills IP/UDP checksums of reflected frames */
+} dpdk_shared = {.initialized = false, .ts_offset = -1};
 
 /* Port configuration */
 static struct rte_eth_conf port_conf = {
@@ -113,6 +151,239 @@ static int parse_eal_args(const char *dpdk_args, char **argv, int max_args)
 	return argc;
 }
 
+/*
+ * Request NIC RX timestamps (before rte_eth_dev_configure). The device clock
+ * is not in any host time domain, so dpdk_calibrate_rx_clock() later measures
+ * its rate and each burst converts packet ages against one clock read.
+ */
+static void dpdk_setup_rx_timestamp(const struct rte_eth_dev_info *dev_info)
+{
+	if (!(dev_info->rx_offload_capa & RTE_ETH_RX_OFFLOAD_TIMESTAMP)) {
+		reflector_log(LOG_WARN, "NIC has no RX timestamp offload, using software stamps");
+		return;
+	}
+
+	int ret = rte_mbuf_dyn_rx_timestamp_register(&dpdk_shared.ts_offset, &dpdk_shared.ts_flag);
+	if (ret < 0) {
+		reflector_log(LOG_WARN, "Failed to register mbuf timestamp field: %s",
+		              rte_strerror(rte_errno));
+		return;
+	}
+
+	port_conf.rxmode.offloads |= RTE_ETH_RX_OFFLOAD_TIMESTAMP;
+	dpdk_shared.rx_timestamp = true;
+}
+
+/*
+ * Measure the device clock rate against the fast clock (after port start)
+ */
+static void dpdk_calibrate_rx_clock(uint16_t port_id)
+{
+	uint64_t c0, c1;
+
+	if (!dpdk_shared.rx_timestamp) {
+		return;
+	}
+
+	uint64_t t0 = fast_clock_ns();
+	if (rte_eth_read_clock(port_id, &c0) < 0) {
+		goto fail;
+	}
+	rte_delay_us_sleep(DPDK_CLOCK_CALIBRATE_US);
+	uint64_t t1 = fast_clock_ns();
+	if (rte_eth_read_clock(port_id, &c1) < 0 || c1 <= c0 || t1 <= t0) {
+		goto fail;
+	}
+
+	uint64_t hz = (uint64_t)(((unsigned __int128)(c1 - c0) * 1000000000ULL) / (t1 - t0));
+	if (hz == 0) {
+		goto fail;
+	}
+	dpdk_shared.ts_ns_mult = (1000000000ULL << 32) / hz;
+	reflector_log(LOG_INFO, "NIC RX timestamps enabled (device clock %.3f MHz)", (double)hz / 1e6);
+	return;
+
+fail:
+	reflector_log(LOG_WARN, "Cannot read NIC clock, using software RX stamps");
+	dpdk_shared.rx_timestamp = false;
+}
+
+/*
+ * Configure the port MTU (before rte_eth_dev_configure). The mbuf data room
+ * grows to hold a whole frame in one segment when the NIC accepts buffers that
+ * large; scatter RX / multi-segment TX are enabled as well so a driver that
+ * still chains segments is handled (see dpdk_platform_recv_batch).
+ */
+static int dpdk_setup_jumbo(int mtu, const struct rte_eth_dev_info *dev_info,
+                            uint32_t *data_room)
+{
+	if (mtu <= 0) {
+		return 0;
+	}
+	if ((uint32_t)mtu < dev_info->min_mtu || (uint32_t)mtu > dev_info->max_mtu) {
+		reflector_log(LOG_ERROR, "MTU %d outside device range %u-%u", mtu, dev_info->min_mtu,
+		              dev_info->max_mtu);
+		return -1;
+	}
+	port_conf.rxmode.mtu = (uint32_t)mtu;
+
+	uint32_t frame_room = RTE_PKTMBUF_HEADROOM + (uint32_t)mtu + DPDK_JUMBO_OVERHEAD;
+	if (frame_room > *data_room && frame_room <= UINT16_MAX &&
+	    frame_room - RTE_PKTMBUF_HEADROOM <= dev_info->max_rx_pktlen) {
+		*data_room = frame_room;
+	}
+	if (dev_info->rx_offload_capa & RTE_ETH_RX_OFFLOAD_SCATTER) {
+		port_conf.rxmode.offloads |= RTE_ETH_RX_OFFLOAD_SCATTER;
+	}
+	if (dev_info->tx_offload_capa & RTE_ETH_TX_OFFLOAD_MULTI_SEGS) {
+		port_conf.txmode.offloads |= RTE_ETH_TX_OFFLOAD_MULTI_SEGS;
+	}
+	if (*data_room < frame_room && !(port_conf.rxmode.offloads & RTE_ETH_RX_OFFLOAD_SCATTER)) {
+		reflector_log(LOG_ERROR, "MTU %d needs scatter RX, which the NIC does not offer", mtu);
+		return -1;
+	}
+
+	reflector_log(LOG_INFO, "DPDK MTU %d: %s", mtu,
+	              *data_room >= frame_room ? "single-segment mbufs" : "chained mbufs (scatter RX)");
+	return 0;
+}
+
+/*
+ * Spread the RSS redirection table evenly over every worker queue (some PMDs
+ * start with only part of the table populated or skewed to queue 0)
+ */
+static void dpdk_setup_reta(uint16_t port_id, uint16_t reta_size, int num_queues)
+{
+	if (num_queues <= 1 || reta_size == 0) {
+		return;
+	}
+
+	uint16_t groups = (reta_size + RTE_ETH_RETA_GROUP_SIZE - 1) / RTE_ETH_RETA_GROUP_SIZE;
+	struct rte_eth_rss_reta_entry64 *reta = calloc(groups, sizeof(*reta));
+	if (reta == NULL) {
+		return;
+	}
+	for (uint16_t i = 0; i < reta_size; i++) {
+		reta[i / RTE_ETH_RETA_GROUP_SIZE].mask |= 1ULL << (i % RTE_ETH_RETA_GROUP_SIZE);
+		reta[i / RTE_ETH_RETA_GROUP_SIZE].reta[i % RTE_ETH_RETA_GROUP_SIZE] =
+		    (uint16_t)(i % num_queues);
+	}
+
+	int ret = rte_eth_dev_rss_reta_update(port_id, reta, reta_size);
+	if (ret < 0) {
+		reflector_log(LOG_WARN, "Failed to program RSS table: %s (using device default)",
+		              rte_strerror(-ret));
+	}
+	free(reta);
+}
+
+/*
+ * Hardware classification with rte_flow. Frames that can be reflector traffic
+ * (UDP to ito_port, IPv4/IPv6, untagged/VLAN/QinQ as configured, with the
+ * dst MAC / source OUI filters folded into the Ethernet item) are spread over
+ * the worker queues by RSS; everything else is dropped by the NIC before it
+ * costs a descriptor or a poll. The core still classifies every frame, so a
+ * NIC that rejects any rule just keeps the software-only path.
+ */
+static bool dpdk_setup_flow_rules(uint16_t port_id, const reflector_config_t *cfg, int num_queues)
+{
+	struct rte_flow_error err = {0};
+	struct rte_flow_attr attr = {.ingress = 1, .priority = 0};
+
+	uint16_t *queues = calloc((size_t)num_queues, sizeof(*queues));
+	if (queues == NULL) {
+		return false;
+	}
+	for (int q = 0; q < num_queues; q++) {
+		queues[q] = (uint16_t)q;
+	}
+	struct rte_flow_action_rss rss = {
+	    .types = port_conf.rx_adv_conf.rss_conf.rss_hf,
+	    .queue_num = (uint32_t)num_queues,
+	    .queue = queues,
+	};
+	struct rte_flow_action_queue queue = {.index = 0};
+	struct rte_flow_action steer[2] = {{.type = RTE_FLOW_ACTION_TYPE_END}};
+	if (num_queues > 1) {
+		steer[0] = (struct rte_flow_action){.type = RTE_FLOW_ACTION_TYPE_RSS, .conf = &rss};
+	} else {
+		steer[0] = (struct rte_flow_action){.type = RTE_FLOW_ACTION_TYPE_QUEUE, .conf = &queue};
+	}
+
+	struct rte_flow_item_eth eth_spec = {0};
+	struct rte_flow_item_eth eth_mask = {0};
+	bool eth_match = cfg->filter_dst_mac || cfg->filter_oui;
+	if (cfg->filter_dst_mac) {
+		eth_spec.dst = dpdk_shared.mac_addr;
+		memset(eth_mask.dst.addr_bytes, 0xff, RTE_ETHER_ADDR_LEN);
+	}
+	if (cfg->filter_oui) {
+		memcpy(eth_spec.src.addr_bytes, cfg->oui, 3);
+		memset(eth_mask.src.addr_bytes, 0xff, 3);
+	}
+
+	struct rte_flow_item_udp udp_spec = {.hdr.dst_port = rte_cpu_to_be_16(cfg->ito_port)};
+	struct rte_flow_item_udp udp_mask = {.hdr.dst_port = RTE_BE16(0xffff)};
+	bool udp_match = cfg->ito_port != 0;
+
+	int max_depth = cfg->enable_vlan ? MAX_VLAN_DEPTH : 0;
+	int num_rules = 0;
+	for (int v6 = 0; v6 <= (cfg->enable_ipv6 ? 1 : 0); v6++) {
+		for (int depth = 0; depth <= max_depth; depth++) {
+			struct rte_flow_item pattern[MAX_VLAN_DEPTH + 4];
+			int n = 0;
+			pattern[n++] = (struct rte_flow_item){
+			    .type = RTE_FLOW_ITEM_TYPE_ETH,
+			    .spec = eth_match ? &eth_spec : NULL,
+			    .mask = eth_match ? &eth_mask : NULL,
+			};
+			for (int t = 0; t < depth; t++) {
+				pattern[n++] = (struct rte_flow_item){.type = RTE_FLOW_ITEM_TYPE_VLAN};
+			}
+			pattern[n++] = (struct rte_flow_item){
+			    .type = v6 ? RTE_FLOW_ITEM_TYPE_IPV6 : RTE_FLOW_ITEM_TYPE_IPV4,
+			};
+			pattern[n++] = (struct rte_flow_item){
+			    .type = RTE_FLOW_ITEM_TYPE_UDP,
+			    .spec = udp_match ? &udp_spec : NULL,
+			    .mask = udp_match ? &udp_mask : NULL,
+			};
+			pattern[n++] = (struct rte_flow_item){.type = RTE_FLOW_ITEM_TYPE_END};
+
+			if (rte_flow_create(port_id, &attr, pattern, steer, &err) == NULL) {
+				goto fail;
+			}
+			num_rules++;
+		}
+	}
+
+	/* Lower priority catch-all: drop in hardware */
+	attr.priority = 1;
+	struct rte_flow_item any[] = {
+	    {.type = RTE_FLOW_ITEM_TYPE_ETH},
+	    {.type = RTE_FLOW_ITEM_TYPE_END},
+	};
+	struct rte_flow_action drop[] = {
+	    {.type = RTE_FLOW_ACTION_TYPE_DROP},
+	    {.type = RTE_FLOW_ACTION_TYPE_END},
+	};
+	if (rte_flow_create(port_id, &attr, any, drop, &err) == NULL) {
+		goto fail;
+	}
+
+	reflector_log(LOG_INFO, "DPDK hardware filter: %d steering rules (UDP dst %s), rest dropped",
+	              num_rules, udp_match ? "ito_port" : "any");
+	free(queues);
+	return true;
+
+fail:
+	reflector_log(LOG_WARN, "Hardware flow filtering unavailable (%s); classifying in software",
+	              err.message ? err.message : rte_strerror(rte_errno));
+	rte_flow_flush(port_id, &err);
+	free(queues);
+	return false;
+}
+
 /*
  * Initialize DPDK EAL and port (called by worker 0 only)
  */
@@ -158,7 +429,11 @@ static int dpdk_init_eal_and_port(reflector_ctx_t *rctx, int num_queues)
 
 	reflector_log(LOG_INFO, "DPDK port %u: %s", port_id, dev_info.driver_name);
 
-	/* Adjust queue count based on device limits */
+	/* Adjust queue count based on device limits (and mbuf_pools[]) */
+	if (num_queues > MAX_WORKERS) {
+		num_queues = MAX_WORKERS;
+		reflector_log(LOG_WARN, "Limiting to %d queues (MAX_WORKERS)", num_queues);
+	}
 	if ((uint16_t)num_queues > dev_info.max_rx_queues) {
 		num_queues = dev_info.max_rx_queues;
 		reflector_log(LOG_WARN, "Limiting to %d RX queues (device max)", num_queues);
@@ -168,15 +443,59 @@ static int dpdk_init_eal_and_port(reflector_ctx_t *rctx, int num_queues)
 		reflector_log(LOG_WARN, "Limiting to %d TX queues (device max)", num_queues);
 	}
 
-	/* Create mempool for packet buffers */
-	dpdk_shared.mbuf_pool =
-	    rte_pktmbuf_pool_create("mbuf_pool", DPDK_NUM_MBUFS * num_queues, DPDK_MBUF_CACHE, 0,
-	                            RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
-	if (dpdk_shared.mbuf_pool == NULL) {
-		reflector_log(LOG_ERROR, "Failed to create mbuf pool: %s", rte_strerror(rte_errno));
+	/* Jumbo frames: size mbufs so one segment holds a full frame when possible */
+	uint32_t data_room = RTE_MBUF_DEFAULT_BUF_SIZE;
+	if (dpdk_setup_jumbo(rctx->config.dpdk_mtu, &dev_info, &data_room) < 0) {
 		return -1;
 	}
 
+	/*
+	 * One mempool per queue on the NIC's socket: each is filled by that
+	 * queue's RX and drained by its TX completions, both on the same worker,
+	 * so pools are never shared across cores or pulled across sockets.
+	 */
+	int socket = rte_eth_dev_socket_id(port_id);
+	if (socket < 0) {
+		socket = (int)rte_socket_id();
+	}
+	for (int q = 0; q < num_queues; q++) {
+		char name[RTE_MEMPOOL_NAMESIZE];
+		snprintf(name, sizeof(name), "mbuf_pool_q%d", q);
+		dpdk_shared.mbuf_pools[q] = rte_pktmbuf_pool_create(
+		    name, DPDK_NUM_MBUFS, DPDK_MBUF_CACHE, 0, (uint16_t)data_room, socket);
+		if (dpdk_shared.mbuf_pools[q] == NULL) {
+			reflector_log(LOG_ERROR, "Failed to create mbuf pool for queue %d: %s", q,
+			              rte_strerror(rte_errno));
+			return -1;
+		}
+	}
+	reflector_log(LOG_INFO, "DPDK mempools: %d x %d mbufs (%u B data room) on socket %d",
+	              num_queues, DPDK_NUM_MBUFS, data_room, socket);
+
+	if (rctx->config.measure_latency && rctx->config.hw_timestamps) {
+		dpdk_setup_rx_timestamp(&dev_info);
+	}
+
+	/* RSS over every queue, limited to the hash types the NIC offers */
+	if (num_queues > 1) {
+		port_conf.rx_adv_conf.rss_conf.rss_hf &= dev_info.flow_type_rss_offloads;
+	} else {
+		port_conf.rxmode.mq_mode = RTE_ETH_MQ_RX_NONE;
+		port_conf.rx_adv_conf.rss_conf.rss_hf = 0;
+	}
+
+	/* software_checksum asks for fixed-up checksums: let the NIC compute them */
+	const uint64_t cksum_offloads = RTE_ETH_TX_OFFLOAD_IPV4_CKSUM | RTE_ETH_TX_OFFLOAD_UDP_CKSUM;
+	dpdk_shared.tx_cksum = rctx->config.software_checksum &&
+	                       (dev_info.tx_offload_capa & cksum_offloads) == cksum_offloads;
+	if (dpdk_shared.tx_cksum) {
+		port_conf.txmode.offloads |= cksum_offloads;
+	}
+	if (rctx->config.software_checksum) {
+		reflector_log(LOG_INFO, "DPDK checksums: %s",
+		              dpdk_shared.tx_cksum ? "NIC TX offload" : "software (no NIC offload)");
+	}
+
 	/* Configure the port */
 	ret = rte_eth_dev_configure(port_id, num_queues, num_queues, &port_conf);
 	if (ret < 0) {
@@ -195,14 +514,13 @@ static int dpdk_init_eal_and_port(reflector_ctx_t *rctx, int num_queues)
 
 	/* Setup RX and TX queues */
 	for (int q = 0; q < num_queues; q++) {
-		ret = rte_eth_rx_queue_setup(port_id, q, nb_rxd, rte_eth_dev_socket_id(port_id), NULL,
-		                             dpdk_shared.mbuf_pool);
+		ret = rte_eth_rx_queue_setup(port_id, q, nb_rxd, socket, NULL, dpdk_shared.mbuf_pools[q]);
 		if (ret < 0) {
 			reflector_log(LOG_ERROR, "Failed to setup RX queue %d: %s", q, rte_strerror(-ret));
 			return -1;
 		}
 
-		ret = rte_eth_tx_queue_setup(port_id, q, nb_txd, rte_eth_dev_socket_id(port_id), NULL);
+		ret = rte_eth_tx_queue_setup(port_id, q, nb_txd, socket, NULL);
 		if (ret < 0) {
 			reflector_log(LOG_ERROR, "Failed to setup TX queue %d: %s", q, rte_strerror(-ret));
 			return -1;
@@ -216,6 +534,8 @@ static int dpdk_init_eal_and_port(reflector_ctx_t *rctx, int num_queues)
 		/* Continue anyway - might work for direct traffic */
 	}
 
+	dpdk_setup_reta(port_id, dev_info.reta_size, num_queues);
+
 	/* Start the port */
 	ret = rte_eth_dev_start(port_id);
 	if (ret < 0) {
@@ -223,6 +543,15 @@ static int dpdk_init_eal_and_port(reflector_ctx_t *rctx, int num_queues)
 		return -1;
 	}
 
+	dpdk_calibrate_rx_clock(port_id);
+
+	/* Idle workers can sleep on an RX descriptor address (see dpdk_platform_wait_rx) */
+	struct rte_cpu_intrinsics intrinsics;
+	rte_cpu_get_intrinsics_support(&intrinsics);
+	dpdk_shared.power_monitor = intrinsics.power_monitor != 0;
+	reflector_log(LOG_INFO, "DPDK idle wait: %s",
+	              dpdk_shared.power_monitor ? "power monitor (UMWAIT/WFE)" : "rte_pause spin");
+
 	/* Get MAC address */
 	ret = rte_eth_macaddr_get(port_id, &dpdk_shared.mac_addr);
 	if (ret < 0) {
@@ -230,6 +559,8 @@ static int dpdk_init_eal_and_port(reflector_ctx_t *rctx, int num_queues)
 		return -1;
 	}
 
+	dpdk_shared.hw_filter = dpdk_setup_flow_rules(port_id, &rctx->config, num_queues);
+
 	/* Store shared state */
 	dpdk_shared.port_id = port_id;
 	dpdk_shared.num_rx_queues = num_queues;
@@ -288,10 +619,18 @@ int dpdk_platform_init(reflector_ctx_t *rctx, worker_ctx_t *wctx)
 		pctx->is_primary = false;
 	}
 
+	/* Workers past the device's queue count have no queue (or pool) to attach to */
+	if (wctx->queue_id >= dpdk_shared.num_rx_queues) {
+		reflector_log(LOG_ERROR, "DPDK worker %d: queue %d exceeds the %u configured queues",
+		              wctx->worker_id, wctx->queue_id, dpdk_shared.num_rx_queues);
+		free(pctx);
+		return -1;
+	}
+
 	/* Attach to queue */
 	pctx->port_id = dpdk_shared.port_id;
 	pctx->queue_id = wctx->queue_id;
-	pctx->mbuf_pool = dpdk_shared.mbuf_pool;
+	pctx->mbuf_pool = dpdk_shared.mbuf_pools[pctx->queue_id];
 	pctx->pending_rx = 0;
 
 	wctx->pctx = pctx;
@@ -313,17 +652,26 @@ void dpdk_platform_cleanup(worker_ctx_t *wctx)
 		return;
 	}
 
-	/* Free any pending RX mbufs */
-	for (int i = 0; i < pctx->pending_rx; i++) {
-		if (pctx->rx_mbufs[i] != NULL) {
-			rte_pktmbuf_free(pctx->rx_mbufs[i]);
-		}
+	/*
+	 * Free queued TX mbufs. RX mbufs were all handed to the core, which
+	 * returned each through send_batch or release_batch.
+	 */
+	while (pctx->tx_backlog_count > 0) {
+		rte_pktmbuf_free(pctx->tx_backlog[pctx->tx_backlog_head]);
+		pctx->tx_backlog_head = (pctx->tx_backlog_head + 1) & DPDK_TX_BACKLOG_MASK;
+		pctx->tx_backlog_count--;
 	}
 
 	/* Only worker 0 stops the port and cleans up EAL */
 	if (pctx->is_primary) {
 		reflector_log(LOG_DEBUG, "DPDK primary worker stopping port %u", pctx->port_id);
 
+		if (dpdk_shared.hw_filter) {
+			struct rte_flow_error err;
+			rte_flow_flush(pctx->port_id, &err);
+			dpdk_shared.hw_filter = false;
+		}
+
 		int ret = rte_eth_dev_stop(pctx->port_id);
 		if (ret < 0) {
 			reflector_log(LOG_WARN, "Failed to stop port: %s", rte_strerror(-ret));
@@ -344,6 +692,66 @@ void dpdk_platform_cleanup(worker_ctx_t *wctx)
 	wctx->pctx = NULL;
 }
 
+/*
+ * Hand a reflected frame's checksums to the NIC. rte_net_get_ptype() walks
+ * VLAN/QinQ and IPv6 extension headers for l2_len/l3_len; the offload API
+ * wants the IPv4 header checksum cleared and the UDP field seeded with the
+ * pseudo-header sum. An IPv4 UDP checksum of zero ("none") stays zero, as in
+ * software checksum mode.
+ */
+static inline void dpdk_tx_cksum_offload(struct rte_mbuf *mb)
+{
+	struct rte_net_hdr_lens hdr_lens;
+	uint32_t ptype =
+	    rte_net_get_ptype(mb, &hdr_lens, RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK | RTE_PTYPE_L4_MASK);
+	if ((ptype & RTE_PTYPE_L4_MASK) != RTE_PTYPE_L4_UDP) {
+		return;
+	}
+
+	mb->l2_len = hdr_lens.l2_len;
+	mb->l3_len = hdr_lens.l3_len;
+	struct rte_udp_hdr *udp =
+	    rte_pktmbuf_mtod_offset(mb, struct rte_udp_hdr *, mb->l2_len + mb->l3_len);
+
+	if (RTE_ETH_IS_IPV4_HDR(ptype)) {
+		struct rte_ipv4_hdr *ip = rte_pktmbuf_mtod_offset(mb, struct rte_ipv4_hdr *, mb->l2_len);
+		mb->ol_flags |= RTE_MBUF_F_TX_IPV4 | RTE_MBUF_F_TX_IP_CKSUM;
+		ip->hdr_checksum = 0;
+		if (udp->dgram_cksum != 0) {
+			mb->ol_flags |= RTE_MBUF_F_TX_UDP_CKSUM;
+			udp->dgram_cksum = rte_ipv4_phdr_cksum(ip, mb->ol_flags);
+		}
+	} else if (RTE_ETH_IS_IPV6_HDR(ptype)) {
+		struct rte_ipv6_hdr *ip6 = rte_pktmbuf_mtod_offset(mb, struct rte_ipv6_hdr *, mb->l2_len);
+		mb->ol_flags |= RTE_MBUF_F_TX_IPV6 | RTE_MBUF_F_TX_UDP_CKSUM;
+		udp->dgram_cksum = rte_ipv6_phdr_cksum(ip6, mb->ol_flags);
+	}
+}
+
+/*
+ * Retry queued TX mbufs in FIFO order (the backlog may wrap: two bursts)
+ */
+static uint32_t dpdk_flush_tx_backlog(struct platform_ctx *pctx)
+{
+	uint32_t sent = 0;
+
+	while (pctx->tx_backlog_count > 0) {
+		uint32_t run = DPDK_TX_BACKLOG_SIZE - pctx->tx_backlog_head;
+		if (run > pctx->tx_backlog_count) {
+			run = pctx->tx_backlog_count;
+		}
+		uint16_t n = rte_eth_tx_burst(pctx->port_id, pctx->queue_id,
+		                              &pctx->tx_backlog[pctx->tx_backlog_head], (uint16_t)run);
+		pctx->tx_backlog_head = (pctx->tx_backlog_head + n) & DPDK_TX_BACKLOG_MASK;
+		pctx->tx_backlog_count -= n;
+		sent += n;
+		if (n < run) {
+			break; /* Descriptor ring full */
+		}
+	}
+	return sent;
+}
+
 /*
  * Receive a batch of packets
  */
@@ -352,10 +760,24 @@ int dpdk_platform_recv_batch(worker_ctx_t *wctx, packet_t *pkts, int max_pkts)
 	struct platform_ctx *pctx = (struct platform_ctx *)wctx->pctx;
 	uint16_t nb_rx;
 
+	/* Give the worker an lcore id so mempool alloc/free go through its per-lcore cache */
+	if (unlikely(!pctx->thread_registered)) {
+		pctx->thread_registered = true;
+		if (rte_lcore_id() == LCORE_ID_ANY && rte_thread_register() < 0) {
+			reflector_log(LOG_WARN, "Worker %d not registered with EAL (no mempool cache): %s",
+			              wctx->worker_id, rte_strerror(rte_errno));
+		}
+	}
+
 	if (max_pkts > DPDK_MAX_PKT_BURST) {
 		max_pkts = DPDK_MAX_PKT_BURST;
 	}
 
+	/* Keep draining queued TX even when no new traffic arrives */
+	if (unlikely(pctx->tx_backlog_count > 0)) {
+		dpdk_flush_tx_backlog(pctx);
+	}
+
 	/* Receive packets */
 	nb_rx = rte_eth_rx_burst(pctx->port_id, pctx->queue_id, pctx->rx_mbufs, max_pkts);
 
@@ -363,15 +785,42 @@ int dpdk_platform_recv_batch(worker_ctx_t *wctx, packet_t *pkts, int max_pkts)
 		return 0;
 	}
 
-	/* Map mbufs to packet_t array */
+	/*
+	 * Map mbufs to packet_t array. The core may only touch contiguous bytes,
+	 * so a chained (scattered jumbo) mbuf exposes its first segment, which
+	 * always holds the headers and signature; the other segments go back out
+	 * untouched with the chain and are counted through extra_len. Address/port
+	 * swaps keep the L4 checksum valid, and a software UDP checksum is skipped
+	 * when the datagram is not all there.
+	 */
 	for (uint16_t i = 0; i < nb_rx; i++) {
 		struct rte_mbuf *mb = pctx->rx_mbufs[i];
 		pkts[i].data = rte_pktmbuf_mtod(mb, uint8_t *);
-		pkts[i].len = rte_pktmbuf_pkt_len(mb);
+		pkts[i].len = rte_pktmbuf_data_len(mb);
+		pkts[i].extra_len = rte_pktmbuf_pkt_len(mb) - rte_pktmbuf_data_len(mb);
 		pkts[i].addr = (uint64_t)(uintptr_t)mb; /* Store mbuf pointer for release */
+		pkts[i].timestamp = 0; /* Core stamps the burst unless the NIC did */
+	}
 
-		if (wctx->config->measure_latency) {
-			pkts[i].timestamp = get_timestamp_ns();
+	/*
+	 * NIC RX timestamps: one device clock read per burst turns each packet's
+	 * device timestamp into an age, subtracted from one fast clock read.
+	 */
+	if (dpdk_shared.rx_timestamp && wctx->config->measure_latency) {
+		uint64_t dev_now;
+		uint64_t now = fast_clock_ns();
+		if (rte_eth_read_clock(pctx->port_id, &dev_now) == 0) {
+			for (uint16_t i = 0; i < nb_rx; i++) {
+				struct rte_mbuf *mb = pctx->rx_mbufs[i];
+				if (!(mb->ol_flags & dpdk_shared.ts_flag)) {
+					continue;
+				}
+				uint64_t ts =
+				    *RTE_MBUF_DYNFIELD(mb, dpdk_shared.ts_offset, rte_mbuf_timestamp_t *);
+				uint64_t age_ticks = dev_now > ts ? dev_now - ts : 0;
+				pkts[i].timestamp =
+				    now - (uint64_t)(((unsigned __int128)age_ticks * dpdk_shared.ts_ns_mult) >> 32);
+			}
 		}
 	}
 
@@ -379,46 +828,83 @@ int dpdk_platform_recv_batch(worker_ctx_t *wctx, packet_t *pkts, int max_pkts)
 	return nb_rx;
 }
 
+void dpdk_platform_release_batch(worker_ctx_t *wctx, packet_t *pkts, int num_pkts);
+
 /*
- * Send a batch of packets
+ * Send a batch of packets. Whatever the TX descriptor ring cannot take is
+ * queued in the backlog (the mbufs stay owned by this worker) instead of
+ * being freed; only a full backlog that does not drain within DPDK_TX_WAIT_US
+ * drops packets, counted as err_tx_backpressure.
  */
 int dpdk_platform_send_batch(worker_ctx_t *wctx, packet_t *pkts, int num_pkts)
 {
 	struct platform_ctx *pctx = (struct platform_ctx *)wctx->pctx;
-	struct rte_mbuf *tx_mbufs[DPDK_MAX_PKT_BURST];
-	uint16_t nb_tx;
 
-	if (num_pkts <= 0 || num_pkts > DPDK_MAX_PKT_BURST) {
+	if (num_pkts <= 0) {
+		return 0;
+	}
+	if (unlikely(num_pkts > DPDK_MAX_PKT_BURST)) {
+		/* send_batch owns the mbufs even when it cannot send them */
+		dpdk_platform_release_batch(wctx, pkts, num_pkts);
 		return 0;
 	}
 
 	/* The packets were already reflected in-place by the core loop.
 	 * We just need to send the mbufs back out. */
 	for (int i = 0; i < num_pkts; i++) {
-		tx_mbufs[i] = (struct rte_mbuf *)(uintptr_t)pkts[i].addr;
+		pctx->tx_mbufs[i] = (struct rte_mbuf *)(uintptr_t)pkts[i].addr;
+		if (dpdk_shared.tx_cksum) {
+			dpdk_tx_cksum_offload(pctx->tx_mbufs[i]);
+		}
+	}
+
+	/* Older packets first; new ones go straight out only if nothing is queued */
+	dpdk_flush_tx_backlog(pctx);
+	int accepted = 0;
+	if (pctx->tx_backlog_count == 0) {
+		accepted = rte_eth_tx_burst(pctx->port_id, pctx->queue_id, pctx->tx_mbufs,
+		                            (uint16_t)num_pkts);
 	}
 
-	/* Transmit */
-	nb_tx = rte_eth_tx_burst(pctx->port_id, pctx->queue_id, tx_mbufs, num_pkts);
+	/* Queue the remainder; with the backlog full, retry (bounded) until it drains */
+	uint64_t deadline = 0;
+	while (accepted < num_pkts) {
+		if (pctx->tx_backlog_count < DPDK_TX_BACKLOG_SIZE) {
+			uint32_t slot =
+			    (pctx->tx_backlog_head + pctx->tx_backlog_count) & DPDK_TX_BACKLOG_MASK;
+			pctx->tx_backlog[slot] = pctx->tx_mbufs[accepted++];
+			pctx->tx_backlog_count++;
+			continue;
+		}
 
-	/* Free any packets that couldn't be sent */
-	if (unlikely(nb_tx < (uint16_t)num_pkts)) {
-		for (uint16_t i = nb_tx; i < (uint16_t)num_pkts; i++) {
-			rte_pktmbuf_free(tx_mbufs[i]);
+		uint64_t now = rte_get_tsc_cycles();
+		if (deadline == 0) {
+			deadline = now + rte_get_tsc_hz() / 1000000 * DPDK_TX_WAIT_US;
+		} else if (now >= deadline) {
+			break;
 		}
+		dpdk_flush_tx_backlog(pctx);
+	}
+
+	/* Past the wait budget: drop the rest */
+	if (unlikely(accepted < num_pkts)) {
+		rte_pktmbuf_free_bulk(&pctx->tx_mbufs[accepted], (unsigned int)(num_pkts - accepted));
+		worker_stats_write_begin(wctx);
+		wctx->stats.err_tx_backpressure += (uint64_t)(num_pkts - accepted);
+		worker_stats_write_end(wctx);
 	}
 
-	return nb_tx;
+	return accepted;
 }
 
 /*
- * Release a batch of packets (free mbufs that weren't sent)
+ * Release received packets that will not be sent (free their mbufs)
  */
 void dpdk_platform_release_batch(worker_ctx_t *wctx, packet_t *pkts, int num_pkts)
 {
 	(void)wctx; /* Unused */
 
-	/* Free mbufs for packets that weren't transmitted */
+	/* Free mbufs for packets that were never handed to send_batch */
 	for (int i = 0; i < num_pkts; i++) {
 		struct rte_mbuf *mb = (struct rte_mbuf *)(uintptr_t)pkts[i].addr;
 		if (mb != NULL) {
@@ -427,6 +913,40 @@ void dpdk_platform_release_batch(worker_ctx_t *wctx, packet_t *pkts, int num_pkt
 	}
 }
 
+/*
+ * Idle wait: arm a monitor on the queue's next RX descriptor and sleep in
+ * UMWAIT (x86 WAITPKG) / WFE until the NIC writes it or the deadline passes.
+ * Without monitor support (CPU or driver), pause-spin for a few microseconds
+ * so the core at least backs off.
+ */
+int dpdk_platform_wait_rx(worker_ctx_t *wctx, int timeout_ms)
+{
+	struct platform_ctx *pctx = wctx->pctx;
+	const uint64_t hz = rte_get_tsc_hz();
+	const uint64_t deadline = rte_get_tsc_cycles() + hz / 1000 * (uint64_t)timeout_ms;
+
+	/* Queued TX keeps the worker awake */
+	if (pctx->tx_backlog_count > 0) {
+		dpdk_flush_tx_backlog(pctx);
+		return 1;
+	}
+
+	if (dpdk_shared.power_monitor) {
+		struct rte_power_monitor_cond pmc;
+		if (rte_eth_get_monitor_addr(pctx->port_id, pctx->queue_id, &pmc) == 0 &&
+		    rte_power_monitor(&pmc, deadline) == 0) {
+			/* Woken before the deadline: most likely a descriptor write */
+			return rte_get_tsc_cycles() < deadline ? 1 : 0;
+		}
+	}
+
+	const uint64_t pause_end = rte_get_tsc_cycles() + hz / 1000000 * DPDK_IDLE_PAUSE_US;
+	while (rte_get_tsc_cycles() < pause_end) {
+		rte_pause();
+	}
+	return 1;
+}
+
 /* Platform operations structure */
 static const platform_ops_t dpdk_platform_ops = {
     .name = "Linux DPDK (100G line-rate)",
@@ -435,6 +955,7 @@ static const platform_ops_t dpdk_platform_ops = {
     .recv_batch = dpdk_platform_recv_batch,
     .send_batch = dpdk_platform_send_batch,
     .release_batch = dpdk_platform_release_batch,
+    .wait_rx = dpdk_platform_wait_rx,
 };
 
 /*
@@ -13,15 +13,20 @@
  */
 
 #include "reflector.h"
+#include "xdp_maps.h"
 
 #include <linux/if_link.h>
 #include <linux/if_xdp.h>
 
+#include <linux/mempolicy.h>
+
 #include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/syscall.h>
 
 #include <errno.h>
 #include <poll.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -39,8 +44,71 @@ static int g_mac_map_fd = -1;
 static int g_sig_map_fd = -1;
 static int g_stats_map_fd = -1;
 static int g_prog_fd = -1;
+static bool g_rx_meta = false; /* xdp_filter_ito_rxts loaded (frames carry xdp_rx_meta) */
 static volatile int g_bpf_init_done = 0; /* Memory barrier for init synchronization */
 
+/*
+ * UMEM frame ownership. Every frame is in exactly one state; transitions are
+ * made explicitly by the datapath so a frame that is lost or returned twice
+ * shows up in the allocator counters instead of silently shrinking the pool.
+ *
+ *   FREE --replenish--> FILL --recv_batch--> APP --send_batch--> TX --CQ--> FREE
+ *                                             |
+ *                                             +--release_batch / TX drop--> FREE
+ */
+enum xdp_frame_state {
+	XDP_FRAME_FREE = 0, /* On the allocator free stack */
+	XDP_FRAME_FILL,     /* Posted to the fill queue (kernel owns it) */
+	XDP_FRAME_APP,      /* Received, held by the worker */
+	XDP_FRAME_TX,       /* In the TX ring or TX backlog, awaiting completion */
+	XDP_FRAME_STATE_COUNT
+};
+
+static const char *const xdp_frame_state_names[XDP_FRAME_STATE_COUNT] = {"free", "fill", "app",
+                                                                          "tx"};
+
+/*
+ * Shared UMEM (--shared-umem): one hugepage-backed region serves every queue.
+ * The first worker creates it and its socket uses the UMEM's own fill and
+ * completion rings; later workers bind with XDP_SHARED_UMEM and get their own
+ * per-queue rings. Free frames sit in per-worker caches (the allocator free
+ * stack) and migrate between workers through a mutex-protected pool that is
+ * only touched XDP_FRAME_POOL_BATCH frames at a time. Workers are set up and
+ * torn down on the control thread, so only the pool needs the lock.
+ */
+#define XDP_SHARED_FRAMES_PER_QUEUE 1024 /* Region = queues x this (>= num_frames) */
+#define XDP_SHARED_FILL_FRAMES 512       /* Per-queue fill target (power of two) */
+#define XDP_FRAME_CACHE_SIZE 1024        /* Per-worker free frame cache */
+#define XDP_FRAME_POOL_BATCH 256         /* Frames moved per pool refill/spill */
+
+static struct {
+	pthread_mutex_t lock; /* Protects pool/pool_count */
+	struct xsk_umem *umem;
+	void *buffer;
+	uint64_t size;
+	uint32_t num_frames;
+	uint8_t *state; /* Per-frame enum xdp_frame_state; a frame has one owner at a time */
+	uint64_t *pool; /* Free frames not cached by any worker */
+	uint32_t pool_count;
+	uint32_t page_kb;
+	int users;
+} g_shared_umem = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+/* Smallest private UMEM whose TX share still fits ring + backlog + one batch */
+#define XDP_MIN_FRAMES 2048
+
+/* UMEM and ring geometry for one socket, derived from the config */
+struct xdp_geometry {
+	uint32_t frame_size;  /* 2048 or 4096 bytes */
+	uint32_t num_frames;  /* Frames for this queue (power of two) */
+	uint32_t fill_frames; /* Kept posted to the fill queue for RX */
+	uint32_t tx_frames;   /* Held by the worker, in the TX ring/backlog or completing */
+	uint32_t fill_size;   /* Ring entries (all powers of two) */
+	uint32_t comp_size;
+	uint32_t rx_size;
+	uint32_t tx_size;
+};
+
 /* Platform-specific context for AF_XDP */
 struct platform_ctx {
 	struct xsk_socket_info {
@@ -62,20 +130,101 @@ struct platform_ctx {
 	int mac_map_fd;
 	int sig_map_fd;
 	int stats_map_fd;
+	int config_map_fd;
 	int prog_fd;
-
-	uint32_t frame_size;
-	uint32_t num_frames;
-	uint32_t umem_frame_free;
+	struct xdp_stats *stats_percpu; /* stats_map lookup buffer (worker 0) */
+	int stats_ncpus;                /* Entries in stats_percpu (possible CPUs) */
+	pthread_mutex_t stats_lock;     /* Serializes get_stats/reset_stats callers */
+	bool rx_meta;          /* Frames are preceded by struct xdp_rx_meta */
+	phc_clock_t phc;       /* Maps rx_meta stamps (PHC time) to the fast clock */
+	bool shared_umem;      /* UMEM is g_shared_umem */
+	bool umem_owner;       /* This socket uses the UMEM's own FQ/CQ */
+	bool prefer_busy_poll; /* SO_PREFER_BUSY_POLL set: recv_batch drives NAPI */
+
+	struct xdp_geometry geo;
+	uint32_t frame_size;  /* geo.frame_size */
+	uint32_t num_frames;  /* Frames in the mapped UMEM (whole region when shared) */
+	uint32_t fill_target; /* geo.fill_frames: frames kept posted in the fill queue */
+	int numa_node;        /* Node the UMEM is bound to (-1 = none) */
+	uint32_t page_kb;     /* Page size backing the UMEM */
+
+	/* UMEM frame allocator (see xdp_frame_move) */
+	struct xdp_frame_alloc {
+		uint64_t *free_stack; /* Frame base addresses owned by userspace, unused */
+		uint32_t free_count;
+		uint32_t cache_size; /* free_stack capacity; spills to the shared pool */
+		uint8_t *state;                           /* enum xdp_frame_state per frame */
+		uint32_t in_state[XDP_FRAME_STATE_COUNT]; /* Frames currently in each state */
+		uint64_t bad_transitions;                 /* Frame not in the expected state */
+		uint64_t fill_starved;                    /* Fill queue had room but no free frames */
+	} frames;
+
+	/* Frames the TX ring could not take yet (see tx_backlog_t) */
+	tx_backlog_t tx_backlog;
 };
 
+static inline uint32_t pow2_floor(uint32_t v)
+{
+	return v ? 1u << (31 - __builtin_clz(v)) : 0;
+}
+
+/* Configured UMEM frame count, rounded down to a power of two */
+static uint32_t xdp_umem_frames(const reflector_config_t *cfg)
+{
+	if (cfg->num_frames < XDP_MIN_FRAMES) {
+		return XDP_MIN_FRAMES;
+	}
+	return pow2_floor((uint32_t)cfg->num_frames);
+}
+
+/*
+ * Derive ring sizes and the fill/TX frame split.
+ *
+ * Private UMEM: half the frames are kept posted for RX, so the fill, RX and
+ * completion rings are that size. The TX ring gets the largest power of two
+ * that still leaves room in the TX half for the backlog and one MAX_BATCH_SIZE
+ * burst held by the worker, so transmit can never eat into RX frames.
+ *
+ * Shared UMEM: each queue gets XDP_SHARED_FRAMES_PER_QUEUE frames of the region
+ * with all rings at XDP_SHARED_FILL_FRAMES; TX frames come from the shared pool.
+ */
+static void xdp_compute_geometry(const reflector_config_t *cfg, struct xdp_geometry *geo)
+{
+	geo->frame_size = (uint32_t)cfg->frame_size;
+	if (geo->frame_size != 2048 && geo->frame_size != 4096) {
+		reflector_log(LOG_WARN, "Unsupported AF_XDP frame size %d, using %d", cfg->frame_size,
+		              FRAME_SIZE);
+		geo->frame_size = FRAME_SIZE;
+	}
+
+	if (cfg->shared_umem) {
+		geo->num_frames = XDP_SHARED_FRAMES_PER_QUEUE;
+		geo->fill_frames = XDP_SHARED_FILL_FRAMES;
+		geo->tx_frames = geo->num_frames - geo->fill_frames;
+		geo->fill_size = geo->comp_size = geo->rx_size = geo->tx_size = XDP_SHARED_FILL_FRAMES;
+		return;
+	}
+
+	geo->num_frames = xdp_umem_frames(cfg);
+	if (geo->num_frames != (uint32_t)cfg->num_frames) {
+		reflector_log(LOG_WARN, "UMEM frame count %d adjusted to %u (power of two, >= %d)",
+		              cfg->num_frames, geo->num_frames, XDP_MIN_FRAMES);
+	}
+	geo->fill_frames = geo->num_frames / 2;
+	geo->tx_frames = geo->num_frames - geo->fill_frames;
+	geo->fill_size = geo->fill_frames;
+	geo->rx_size = geo->fill_frames;
+	geo->tx_size = pow2_floor(geo->tx_frames - TX_BACKLOG_SIZE - MAX_BATCH_SIZE);
+	geo->comp_size = geo->tx_size;
+}
+
 /*
  * Configure UMEM (User Memory) for zero-copy packet buffers
  */
 static int configure_umem(struct platform_ctx *pctx, void *buffer, uint64_t size)
 {
-	struct xsk_umem_config cfg = {.fill_size = NUM_FRAMES / 2,
-	                              .comp_size = NUM_FRAMES / 2,
+	struct xsk_umem_config cfg = {.fill_size = pctx->geo.fill_size,
+	                              .comp_size = pctx->geo.comp_size,
 	                              .frame_size = pctx->frame_size,
 	                              .frame_headroom = 0, /* XDP_PACKET_HEADROOM */
 	                              .flags = 0};
@@ -95,23 +244,516 @@ static int configure_umem(struct platform_ctx *pctx, void *buffer, uint64_t size
 }
 
 /*
- * Populate fill queue with buffers for kernel to use
+ * Set up the frame allocator. A private UMEM starts with every frame on the
+ * free stack (low addresses popped first); with a shared UMEM the cache starts
+ * empty and is filled from the pool on the first replenish.
+ */
+static int xdp_frame_alloc_init(struct platform_ctx *pctx)
+{
+	struct xdp_frame_alloc *fa = &pctx->frames;
+
+	if (pctx->shared_umem) {
+		fa->cache_size = XDP_FRAME_CACHE_SIZE;
+		fa->free_stack = calloc(fa->cache_size, sizeof(*fa->free_stack));
+		fa->state = g_shared_umem.state;
+		return fa->free_stack ? 0 : -ENOMEM;
+	}
+
+	fa->cache_size = pctx->num_frames;
+	fa->free_stack = calloc(pctx->num_frames, sizeof(*fa->free_stack));
+	fa->state = calloc(pctx->num_frames, sizeof(*fa->state));
+	if (!fa->free_stack || !fa->state) {
+		free(fa->free_stack);
+		free(fa->state);
+		fa->free_stack = NULL;
+		fa->state = NULL;
+		return -ENOMEM;
+	}
+
+	for (uint32_t i = 0; i < pctx->num_frames; i++) {
+		fa->free_stack[i] = (uint64_t)(pctx->num_frames - 1 - i) * pctx->frame_size;
+	}
+	fa->free_count = pctx->num_frames;
+	fa->in_state[XDP_FRAME_FREE] = pctx->num_frames;
+	return 0;
+}
+
+/*
+ * Log the allocator state and warn if frames went missing.
+ * Frames still in FILL/APP/TX at teardown are fine; an inconsistent total or
+ * bad transitions are not. With a shared UMEM frames migrate between workers,
+ * so only the per-worker counts are shown.
+ */
+static void xdp_frame_alloc_report(const struct platform_ctx *pctx, int worker_id)
+{
+	const struct xdp_frame_alloc *fa = &pctx->frames;
+	uint32_t total = 0;
+
+	for (int s = 0; s < XDP_FRAME_STATE_COUNT; s++) {
+		total += fa->in_state[s];
+	}
+
+	bool lost = !pctx->shared_umem && total != pctx->num_frames;
+	int level = (lost || fa->bad_transitions) ? LOG_WARN : LOG_DEBUG;
+	reflector_log(level,
+	              "Worker %d UMEM frames: %s=%u %s=%u %s=%u %s=%u (of %u), "
+	              "bad transitions=%lu, fill starved=%lu",
+	              worker_id, xdp_frame_state_names[XDP_FRAME_FREE], fa->in_state[XDP_FRAME_FREE],
+	              xdp_frame_state_names[XDP_FRAME_FILL], fa->in_state[XDP_FRAME_FILL],
+	              xdp_frame_state_names[XDP_FRAME_APP], fa->in_state[XDP_FRAME_APP],
+	              xdp_frame_state_names[XDP_FRAME_TX], fa->in_state[XDP_FRAME_TX], pctx->num_frames,
+	              fa->bad_transitions, fa->fill_starved);
+}
+
+static void xdp_frame_alloc_destroy(struct platform_ctx *pctx)
+{
+	free(pctx->frames.free_stack);
+	if (!pctx->shared_umem) {
+		free(pctx->frames.state);
+	}
+	pctx->frames.free_stack = NULL;
+	pctx->frames.state = NULL;
+}
+
+/*
+ * Move up to n free frames from the shared pool into this worker's cache.
+ * Returns number of frames taken.
  */
-static void populate_fill_queue(struct platform_ctx *pctx, uint32_t num)
+static uint32_t xdp_frame_cache_refill(struct platform_ctx *pctx, uint32_t n)
 {
-	uint32_t idx;
+	struct xdp_frame_alloc *fa = &pctx->frames;
+
+	if (n > fa->cache_size - fa->free_count) {
+		n = fa->cache_size - fa->free_count;
+	}
+
+	pthread_mutex_lock(&g_shared_umem.lock);
+	if (n > g_shared_umem.pool_count) {
+		n = g_shared_umem.pool_count;
+	}
+	g_shared_umem.pool_count -= n;
+	memcpy(&fa->free_stack[fa->free_count], &g_shared_umem.pool[g_shared_umem.pool_count],
+	       n * sizeof(*fa->free_stack));
+	pthread_mutex_unlock(&g_shared_umem.lock);
+
+	fa->free_count += n;
+	fa->in_state[XDP_FRAME_FREE] += n;
+	return n;
+}
+
+/* Hand the oldest part of a full cache back to the shared pool */
+static void xdp_frame_cache_spill(struct platform_ctx *pctx)
+{
+	struct xdp_frame_alloc *fa = &pctx->frames;
+	uint32_t n = XDP_FRAME_POOL_BATCH;
+
+	pthread_mutex_lock(&g_shared_umem.lock);
+	memcpy(&g_shared_umem.pool[g_shared_umem.pool_count], fa->free_stack,
+	       n * sizeof(*fa->free_stack));
+	g_shared_umem.pool_count += n;
+	pthread_mutex_unlock(&g_shared_umem.lock);
+
+	fa->free_count -= n;
+	memmove(fa->free_stack, &fa->free_stack[n], fa->free_count * sizeof(*fa->free_stack));
+	fa->in_state[XDP_FRAME_FREE] -= n;
+}
+
+/*
+ * Record a frame changing owner. addr may point anywhere inside the frame
+ * (RX descriptors carry the headroom offset). Returns false, and counts a bad
+ * transition, if the frame was not in the expected state; the caller must then
+ * leave the frame alone rather than risk posting it twice.
+ */
+static inline bool xdp_frame_move(struct platform_ctx *pctx, uint64_t addr,
+                                  enum xdp_frame_state from, enum xdp_frame_state to)
+{
+	struct xdp_frame_alloc *fa = &pctx->frames;
+	uint64_t idx = addr / pctx->frame_size;
+
+	if (unlikely(idx >= pctx->num_frames || fa->state[idx] != from)) {
+		fa->bad_transitions++;
+		return false;
+	}
+	fa->state[idx] = (uint8_t)to;
+	fa->in_state[from]--;
+	fa->in_state[to]++;
+	return true;
+}
 
-	if (xsk_ring_prod__reserve(&pctx->xsk_info.umem.fq, num, &idx) != num) {
-		reflector_log(LOG_ERROR, "Failed to reserve fill queue entries");
+/* Give a frame back to the free stack */
+static inline void xdp_frame_free(struct platform_ctx *pctx, uint64_t addr,
+                                  enum xdp_frame_state from)
+{
+	if (likely(xdp_frame_move(pctx, addr, from, XDP_FRAME_FREE))) {
+		if (unlikely(pctx->frames.free_count == pctx->frames.cache_size)) {
+			xdp_frame_cache_spill(pctx);
+		}
+		uint64_t base = addr - addr % pctx->frame_size;
+		pctx->frames.free_stack[pctx->frames.free_count++] = base;
+	}
+}
+
+/*
+ * Top the fill queue back up to fill_target from the free stack, refilling
+ * the cache from the shared pool when it runs short.
+ * Returns number of frames posted.
+ */
+static uint32_t xdp_fill_replenish(struct platform_ctx *pctx)
+{
+	struct xdp_frame_alloc *fa = &pctx->frames;
+	uint32_t want, idx_fq;
+
+	if (fa->in_state[XDP_FRAME_FILL] >= pctx->fill_target) {
+		return 0;
+	}
+	want = pctx->fill_target - fa->in_state[XDP_FRAME_FILL];
+	if (want > fa->free_count && pctx->shared_umem) {
+		uint32_t missing = want - fa->free_count;
+		xdp_frame_cache_refill(pctx, missing > XDP_FRAME_POOL_BATCH ? missing
+		                                                            : XDP_FRAME_POOL_BATCH);
+	}
+	if (want > fa->free_count) {
+		fa->fill_starved++;
+		want = fa->free_count;
+	}
+	want = xsk_prod_nb_free(&pctx->xsk_info.umem.fq, want);
+	if (want == 0 || xsk_ring_prod__reserve(&pctx->xsk_info.umem.fq, want, &idx_fq) != want) {
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < want; i++) {
+		uint64_t addr = fa->free_stack[--fa->free_count];
+		fa->state[addr / pctx->frame_size] = XDP_FRAME_FILL;
+		*xsk_ring_prod__fill_addr(&pctx->xsk_info.umem.fq, idx_fq++) = addr;
+	}
+	fa->in_state[XDP_FRAME_FREE] -= want;
+	fa->in_state[XDP_FRAME_FILL] += want;
+	xsk_ring_prod__submit(&pctx->xsk_info.umem.fq, want);
+
+	return want;
+}
+
+/* Default hugetlb page size in kB (0 if unknown) */
+static uint32_t default_hugepage_kb(void)
+{
+	char line[128];
+	uint32_t kb = 0;
+
+	FILE *f = fopen("/proc/meminfo", "r");
+	if (!f) {
+		return 0;
+	}
+	while (fgets(line, sizeof(line), f)) {
+		if (sscanf(line, "Hugepagesize: %u kB", &kb) == 1) {
+			break;
+		}
+	}
+	fclose(f);
+	return kb;
+}
+
+/*
+ * Map a UMEM area on the NIC's NUMA node, preferring huge pages when asked
+ * (better TLB utilization). The policy is applied before anything touches the
+ * area; pages are faulted in when xsk_umem__create() pins them. Normal pages
+ * are bound strictly; hugetlb pages only prefer the node, since a strict bind
+ * with no free huge pages there would fault at pin time instead of falling
+ * back. Sets *page_kb to the page size obtained.
+ * Returns MAP_FAILED with errno set on failure.
+ */
+static void *xdp_map_umem_area(uint64_t size, bool huge_pages, int numa_node, uint32_t *page_kb)
+{
+	void *area = MAP_FAILED;
+	int mode = MPOL_BIND;
+
+	*page_kb = (uint32_t)(sysconf(_SC_PAGESIZE) / 1024);
+
+	if (huge_pages) {
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0x40000 /* Linux-specific flag for huge pages */
+#endif
+		area = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+		            -1, 0);
+		if (area != MAP_FAILED) {
+			uint32_t huge_kb = default_hugepage_kb();
+			*page_kb = huge_kb ? huge_kb : 2048;
+			mode = MPOL_PREFERRED;
+		} else {
+			reflector_log(LOG_WARN,
+			              "Huge pages requested but not available (vm.nr_hugepages?), "
+			              "UMEM falls back to %u kB pages",
+			              *page_kb);
+		}
+	}
+
+	if (area == MAP_FAILED) {
+		area = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (area == MAP_FAILED) {
+			return MAP_FAILED;
+		}
+	}
+
+	if (numa_node >= 0) {
+		unsigned long nodemask[16] = {0};
+		const unsigned long bits = 8 * sizeof(nodemask[0]);
+
+		if ((unsigned long)numa_node < bits * 16) {
+			nodemask[numa_node / bits] = 1UL << (numa_node % bits);
+			if (syscall(SYS_mbind, area, size, mode, nodemask, bits * 16, 0) != 0) {
+				reflector_log(LOG_WARN, "Failed to bind UMEM to NUMA node %d: %s", numa_node,
+				              strerror(errno));
+			}
+		}
+	}
+
+	return area;
+}
+
+/*
+ * Attach a worker to the shared UMEM, creating it for the first worker.
+ * The region holds geo.num_frames frames per worker (at least the configured
+ * UMEM size), always a multiple of 2 MB so it can be hugepage-backed.
+ */
+static int xdp_shared_umem_attach(reflector_ctx_t *rctx, struct platform_ctx *pctx)
+{
+	pctx->shared_umem = true;
+
+	if (g_shared_umem.users > 0) {
+		pctx->num_frames = g_shared_umem.num_frames;
+		pctx->page_kb = g_shared_umem.page_kb;
+		pctx->xsk_info.umem.umem = g_shared_umem.umem;
+		pctx->xsk_info.umem.buffer = g_shared_umem.buffer;
+		pctx->xsk_info.umem.buffer_size = g_shared_umem.size;
+		g_shared_umem.users++;
+		return 0;
+	}
+
+	uint32_t num_frames = (uint32_t)rctx->num_workers * pctx->geo.num_frames;
+	if (num_frames < xdp_umem_frames(&rctx->config)) {
+		num_frames = xdp_umem_frames(&rctx->config);
+	}
+	uint64_t size = (uint64_t)num_frames * pctx->frame_size;
+
+	uint8_t *state = calloc(num_frames, sizeof(*state));
+	uint64_t *pool = calloc(num_frames, sizeof(*pool));
+	void *buffer = xdp_map_umem_area(size, true, pctx->numa_node, &pctx->page_kb);
+	if (!state || !pool || buffer == MAP_FAILED) {
+		int err = buffer == MAP_FAILED ? errno : ENOMEM;
+		reflector_log(LOG_ERROR, "Failed to allocate shared UMEM: %s", strerror(err));
+		if (buffer != MAP_FAILED) {
+			munmap(buffer, size);
+		}
+		free(state);
+		free(pool);
+		return err ? -err : -ENOMEM;
+	}
+
+	pctx->num_frames = num_frames;
+	int ret = configure_umem(pctx, buffer, size);
+	if (ret) {
+		munmap(buffer, size);
+		free(state);
+		free(pool);
+		return ret;
+	}
+
+	for (uint32_t i = 0; i < num_frames; i++) {
+		pool[i] = (uint64_t)(num_frames - 1 - i) * pctx->frame_size;
+	}
+
+	g_shared_umem.umem = pctx->xsk_info.umem.umem;
+	g_shared_umem.buffer = buffer;
+	g_shared_umem.size = size;
+	g_shared_umem.num_frames = num_frames;
+	g_shared_umem.state = state;
+	g_shared_umem.pool = pool;
+	g_shared_umem.pool_count = num_frames;
+	g_shared_umem.page_kb = pctx->page_kb;
+	g_shared_umem.users = 1;
+	pctx->umem_owner = true;
+
+	reflector_log(LOG_INFO,
+	              "Allocated shared UMEM: %lu MB (%u frames of %u bytes, %d queues, "
+	              "%u kB pages, NUMA node %d)",
+	              size / (1024 * 1024), num_frames, pctx->frame_size, rctx->num_workers,
+	              pctx->page_kb, pctx->numa_node);
+	return 0;
+}
+
+/*
+ * Drop this worker's UMEM: a private UMEM is deleted outright, the shared one
+ * when its last user goes away. Sockets must already be deleted.
+ */
+static void xdp_umem_put(struct platform_ctx *pctx)
+{
+	if (!pctx->xsk_info.umem.umem) {
 		return;
 	}
 
-	for (uint32_t i = 0; i < num; i++) {
-		uint64_t addr = i * pctx->frame_size;
-		*xsk_ring_prod__fill_addr(&pctx->xsk_info.umem.fq, idx++) = addr;
+	if (!pctx->shared_umem) {
+		xsk_umem__delete(pctx->xsk_info.umem.umem);
+		munmap(pctx->xsk_info.umem.buffer, pctx->xsk_info.umem.buffer_size);
+		pctx->xsk_info.umem.umem = NULL;
+		return;
+	}
+
+	pctx->xsk_info.umem.umem = NULL;
+	if (--g_shared_umem.users > 0) {
+		return;
+	}
+
+	xsk_umem__delete(g_shared_umem.umem);
+	munmap(g_shared_umem.buffer, g_shared_umem.size);
+	free(g_shared_umem.state);
+	free(g_shared_umem.pool);
+	g_shared_umem.umem = NULL;
+	g_shared_umem.buffer = NULL;
+	g_shared_umem.state = NULL;
+	g_shared_umem.pool = NULL;
+	g_shared_umem.pool_count = 0;
+}
+
+/* Signatures loaded into sig_map, keyed by the offset they appear at */
+static const struct {
+	const char *sig;
+	sig_type_t type;
+	uint32_t offset;
+} xdp_signatures[] = {
+    {ITO_SIG_PROBEOT, SIG_TYPE_PROBEOT, ITO_SIG_OFFSET},
+    {ITO_SIG_DATAOT, SIG_TYPE_DATAOT, ITO_SIG_OFFSET},
+    {ITO_SIG_LATENCY, SIG_TYPE_LATENCY, ITO_SIG_OFFSET},
+    {CUSTOM_SIG_RFC2544, SIG_TYPE_RFC2544, 0},
+    {CUSTOM_SIG_Y1564, SIG_TYPE_Y1564, 0},
+};
+
+/*
+ * Check whether a signature type is accepted by the configured filter
+ */
+static bool sig_filter_accepts(sig_filter_t filter, sig_type_t type)
+{
+	switch (filter) {
+	case SIG_FILTER_ITO:
+		return type <= SIG_TYPE_LATENCY;
+	case SIG_FILTER_RFC2544:
+		return type == SIG_TYPE_RFC2544;
+	case SIG_FILTER_Y1564:
+		return type == SIG_TYPE_Y1564;
+	case SIG_FILTER_CUSTOM:
+		return type == SIG_TYPE_RFC2544 || type == SIG_TYPE_Y1564;
+	case SIG_FILTER_ALL:
+	default:
+		return true;
+	}
+}
+
+/*
+ * Populate sig_map and config_map from the reflector configuration
+ */
+static int configure_xdp_maps(struct platform_ctx *pctx, const reflector_config_t *cfg)
+{
+	int ret;
+	int loaded = 0;
+
+	for (size_t i = 0; i < sizeof(xdp_signatures) / sizeof(xdp_signatures[0]); i++) {
+		if (!sig_filter_accepts(cfg->sig_filter, xdp_signatures[i].type)) {
+			continue;
+		}
+
+		struct xdp_sig_value val = {.sig_type = xdp_signatures[i].type,
+		                            .payload_offset = xdp_signatures[i].offset};
+		ret = bpf_map_update_elem(pctx->sig_map_fd, xdp_signatures[i].sig, &val, BPF_ANY);
+		if (ret) {
+			reflector_log(LOG_ERROR, "Failed to update sig_map for %s: %s",
+			              xdp_signatures[i].sig, strerror(-ret));
+			return ret;
+		}
+		loaded++;
+	}
+	reflector_log(LOG_INFO, "Loaded %d signatures into XDP hash map", loaded);
+
+	struct xdp_reflect_config xcfg = {0};
+	xcfg.reflect_mode = cfg->reflect_mode;
+	xcfg.ito_port = cfg->ito_port;
+	memcpy(xcfg.oui, cfg->oui, sizeof(xcfg.oui));
+	if (cfg->filter_dst_mac) {
+		xcfg.flags |= XDP_CFG_FILTER_DST_MAC;
+	}
+	if (cfg->filter_oui) {
+		xcfg.flags |= XDP_CFG_FILTER_OUI;
+	}
+	if (cfg->enable_vlan) {
+		xcfg.flags |= XDP_CFG_VLAN;
+	}
+	if (cfg->enable_ipv6) {
+		xcfg.flags |= XDP_CFG_IPV6;
+	}
+	if (cfg->xdp_tx) {
+		xcfg.flags |= XDP_CFG_TX_REFLECT;
+	}
+
+	uint32_t key = 0;
+	ret = bpf_map_update_elem(pctx->config_map_fd, &key, &xcfg, BPF_ANY);
+	if (ret) {
+		reflector_log(LOG_ERROR, "Failed to update config_map: %s", strerror(-ret));
+		return ret;
 	}
 
-	xsk_ring_prod__submit(&pctx->xsk_info.umem.fq, num);
+	if (cfg->xdp_tx) {
+		reflector_log(LOG_INFO, "XDP_TX reflection enabled: packets reflected in-kernel");
+	}
+	return 0;
+}
+
+/*
+ * Open and load filter.bpf.o. Only one of the two filter programs is loaded:
+ * xdp_filter_ito_rxts must be bound to the device for its metadata kfunc,
+ * which needs kernel 6.3+ and a driver implementing xmo_rx_timestamp.
+ * Returns the loaded object, or NULL with *err set (-ENOENT if unopenable).
+ */
+static struct bpf_object *open_xdp_object(const reflector_config_t *cfg, bool rx_ts, int *err)
+{
+#ifndef BPF_F_XDP_DEV_BOUND_ONLY
+	if (rx_ts) {
+		*err = -ENOTSUP; /* Built against pre-6.3 UAPI headers */
+		return NULL;
+	}
+#endif
+
+	struct bpf_object *obj = bpf_object__open_file("src/xdp/filter.bpf.o", NULL);
+	if (libbpf_get_error(obj)) {
+		*err = -ENOENT;
+		return NULL;
+	}
+
+	struct bpf_program *plain = bpf_object__find_program_by_name(obj, "xdp_filter_ito");
+	struct bpf_program *rxts = bpf_object__find_program_by_name(obj, "xdp_filter_ito_rxts");
+	if (rx_ts && !rxts) {
+		bpf_object__close(obj);
+		*err = -ENOTSUP;
+		return NULL;
+	}
+
+	/* Load only the program that will be attached */
+	if (rx_ts) {
+		if (plain) {
+			bpf_program__set_autoload(plain, false);
+		}
+#ifdef BPF_F_XDP_DEV_BOUND_ONLY
+		bpf_program__set_ifindex(rxts, (__u32)cfg->ifindex);
+		bpf_program__set_flags(rxts, bpf_program__flags(rxts) | BPF_F_XDP_DEV_BOUND_ONLY);
+#endif
+	} else if (rxts) {
+		bpf_program__set_autoload(rxts, false);
+	}
+	(void)cfg;
+
+	int ret = bpf_object__load(obj);
+	if (ret) {
+		bpf_object__close(obj);
+		*err = ret;
+		return NULL;
+	}
+	return obj;
 }
 
 /*
@@ -126,45 +768,59 @@ static int load_xdp_program(worker_ctx_t *wctx)
 	/* Check if BPF object file exists */
 	if (access("src/xdp/filter.bpf.o", F_OK) != 0) {
 		reflector_log(LOG_WARN, "eBPF filter not found, will use SKB mode without filter");
+		if (cfg->xdp_tx) {
+			reflector_log(LOG_WARN, "XDP_TX needs the eBPF filter, reflecting in userspace");
+		}
 		pctx->bpf_obj = NULL;
 		pctx->prog_fd = -1;
 		return 0; /* Not an error - AF_XDP works without eBPF */
 	}
 
-	/* Load BPF object file */
-	pctx->bpf_obj = bpf_object__open_file("src/xdp/filter.bpf.o", NULL);
-	if (libbpf_get_error(pctx->bpf_obj)) {
-		reflector_log(LOG_WARN, "Failed to load eBPF filter, will use SKB mode without filter");
-		pctx->bpf_obj = NULL;
-		pctx->prog_fd = -1;
-		return 0; /* Not an error - AF_XDP works without eBPF */
+	/* Load BPF object file (device-bound RX timestamp variant if requested) */
+	bool rx_ts = cfg->measure_latency && cfg->hw_timestamps;
+	pctx->bpf_obj = open_xdp_object(cfg, rx_ts, &ret);
+	if (!pctx->bpf_obj && rx_ts) {
+		reflector_log(LOG_WARN, "XDP RX timestamp metadata unsupported (%s), using software stamps",
+		              strerror(-ret));
+		rx_ts = false;
+		pctx->bpf_obj = open_xdp_object(cfg, false, &ret);
 	}
-
-	/* Load BPF program into kernel */
-	ret = bpf_object__load(pctx->bpf_obj);
-	if (ret) {
+	if (!pctx->bpf_obj) {
+		if (ret == -ENOENT) {
+			reflector_log(LOG_WARN, "Failed to load eBPF filter, will use SKB mode without filter");
+			if (cfg->xdp_tx) {
+				reflector_log(LOG_WARN, "XDP_TX needs the eBPF filter, reflecting in userspace");
+			}
+			pctx->prog_fd = -1;
+			return 0; /* Not an error - AF_XDP works without eBPF */
+		}
 		reflector_log(LOG_ERROR, "Failed to load BPF object: %s", strerror(-ret));
-		bpf_object__close(pctx->bpf_obj);
 		return ret;
 	}
 
 	/* Get program FD */
-	struct bpf_program *prog = bpf_object__find_program_by_name(pctx->bpf_obj, "xdp_filter_ito");
+	struct bpf_program *prog = bpf_object__find_program_by_name(
+	    pctx->bpf_obj, rx_ts ? "xdp_filter_ito_rxts" : "xdp_filter_ito");
 	if (!prog) {
 		reflector_log(LOG_ERROR, "Failed to find XDP program");
 		bpf_object__close(pctx->bpf_obj);
 		return -1;
 	}
 	pctx->prog_fd = bpf_program__fd(prog);
+	pctx->rx_meta = rx_ts;
+	if (rx_ts) {
+		reflector_log(LOG_INFO, "XDP RX timestamp metadata enabled (device-bound program)");
+	}
 
 	/* Get map FDs */
 	pctx->xsks_map_fd = bpf_object__find_map_fd_by_name(pctx->bpf_obj, "xsks_map");
 	pctx->mac_map_fd = bpf_object__find_map_fd_by_name(pctx->bpf_obj, "mac_map");
 	pctx->sig_map_fd = bpf_object__find_map_fd_by_name(pctx->bpf_obj, "sig_map");
 	pctx->stats_map_fd = bpf_object__find_map_fd_by_name(pctx->bpf_obj, "stats_map");
+	pctx->config_map_fd = bpf_object__find_map_fd_by_name(pctx->bpf_obj, "config_map");
 
 	if (pctx->xsks_map_fd < 0 || pctx->mac_map_fd < 0 || pctx->sig_map_fd < 0 ||
-	    pctx->stats_map_fd < 0) {
+	    pctx->stats_map_fd < 0 || pctx->config_map_fd < 0) {
 		reflector_log(LOG_ERROR, "Failed to find BPF maps");
 		bpf_object__close(pctx->bpf_obj);
 		return -1;
@@ -179,20 +835,12 @@ static int load_xdp_program(worker_ctx_t *wctx)
 		return ret;
 	}
 
-	/* Populate signature hash map for O(1) lookup */
-	const char *signatures[] = {"PROBEOT", "DATA:OT", "LATENCY"};
-	uint32_t sig_value = 1; /* Value unused, presence in map indicates match */
-
-	for (int i = 0; i < 3; i++) {
-		ret = bpf_map_update_elem(pctx->sig_map_fd, signatures[i], &sig_value, BPF_ANY);
-		if (ret) {
-			reflector_log(LOG_ERROR, "Failed to update sig_map for %s: %s", signatures[i],
-			              strerror(-ret));
-			bpf_object__close(pctx->bpf_obj);
-			return ret;
-		}
+	/* Populate signature hash map (O(1) lookup) and reflection config */
+	ret = configure_xdp_maps(pctx, cfg);
+	if (ret) {
+		bpf_object__close(pctx->bpf_obj);
+		return ret;
 	}
-	reflector_log(LOG_INFO, "Loaded %d ITO signatures into XDP hash map", 3);
 
 	/* Save to globals so other workers can use them */
 	g_bpf_obj = pctx->bpf_obj;
@@ -201,6 +849,7 @@ static int load_xdp_program(worker_ctx_t *wctx)
 	g_sig_map_fd = pctx->sig_map_fd;
 	g_stats_map_fd = pctx->stats_map_fd;
 	g_prog_fd = pctx->prog_fd;
+	g_rx_meta = pctx->rx_meta;
 
 	/* Memory barrier before signaling init done (release semantics) */
 	__atomic_store_n(&g_bpf_init_done, 1, __ATOMIC_RELEASE);
@@ -221,6 +870,43 @@ static int load_xdp_program(worker_ctx_t *wctx)
 	return 0;
 }
 
+/*
+ * Socket busy polling. SO_BUSY_POLL lets poll()/recvfrom()/sendto() spin on
+ * the NIC queue for XDP_BUSY_POLL_US before sleeping, so an idle worker picks
+ * up a new burst without an interrupt round trip. When the worker always
+ * spins (busy_poll), SO_PREFER_BUSY_POLL additionally keeps the queue's NAPI
+ * off softirq and recv_batch drives it with a recvfrom() on every poll.
+ */
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+#ifndef SO_BUSY_POLL_BUDGET
+#define SO_BUSY_POLL_BUDGET 70
+#endif
+#define XDP_BUSY_POLL_US 20
+
+static void xdp_setup_busy_poll(struct platform_ctx *pctx, const reflector_config_t *cfg)
+{
+	int fd = xsk_socket__fd(pctx->xsk_info.xsk);
+	int usecs = XDP_BUSY_POLL_US;
+	int budget = cfg->batch_size > 0 ? cfg->batch_size : BATCH_SIZE; /* One RX burst */
+	int one = 1;
+
+	if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs)) < 0 ||
+	    setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL_BUDGET, &budget, sizeof(budget)) < 0) {
+		reflector_log(LOG_DEBUG, "AF_XDP socket busy poll unavailable: %s", strerror(errno));
+		return;
+	}
+
+	if (cfg->busy_poll) {
+		if (setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &one, sizeof(one)) < 0) {
+			reflector_log(LOG_WARN, "SO_PREFER_BUSY_POLL unavailable: %s", strerror(errno));
+		} else {
+			pctx->prefer_busy_poll = true;
+		}
+	}
+}
+
 /*
  * Initialize AF_XDP socket
  */
@@ -230,16 +916,23 @@ static int init_xsk(worker_ctx_t *wctx)
 	reflector_config_t *cfg = wctx->config;
 	int ret;
 
-	struct xsk_socket_config xsk_cfg = {.rx_size = NUM_FRAMES / 2,
-	                                    .tx_size = NUM_FRAMES / 2,
+	struct xsk_socket_config xsk_cfg = {.rx_size = pctx->geo.rx_size,
+	                                    .tx_size = pctx->geo.tx_size,
 	                                    .libbpf_flags = 0,
 	                                    .xdp_flags = XDP_FLAGS_UPDATE_IF_NOEXIST,
 	                                    .bind_flags = XDP_USE_NEED_WAKEUP | XDP_ZEROCOPY};
 
-	/* Create AF_XDP socket */
-	ret = xsk_socket__create(&pctx->xsk_info.xsk, cfg->ifname, wctx->queue_id,
-	                         pctx->xsk_info.umem.umem, &pctx->xsk_info.rx, &pctx->xsk_info.tx,
-	                         &xsk_cfg);
+	/* Create AF_XDP socket; extra sockets on a shared UMEM get their own FQ/CQ */
+	if (pctx->shared_umem && !pctx->umem_owner) {
+		ret = xsk_socket__create_shared(&pctx->xsk_info.xsk, cfg->ifname, wctx->queue_id,
+		                                pctx->xsk_info.umem.umem, &pctx->xsk_info.rx,
+		                                &pctx->xsk_info.tx, &pctx->xsk_info.umem.fq,
+		                                &pctx->xsk_info.umem.cq, &xsk_cfg);
+	} else {
+		ret = xsk_socket__create(&pctx->xsk_info.xsk, cfg->ifname, wctx->queue_id,
+		                         pctx->xsk_info.umem.umem, &pctx->xsk_info.rx, &pctx->xsk_info.tx,
+		                         &xsk_cfg);
+	}
 
 	if (ret) {
 		reflector_log(LOG_ERROR, "Failed to create XSK socket: %s", strerror(-ret));
@@ -263,15 +956,17 @@ static int init_xsk(worker_ctx_t *wctx)
 		              wctx->queue_id);
 	}
 
+	xdp_setup_busy_poll(pctx, cfg);
 	return 0;
 }
 
+void xdp_platform_cleanup(worker_ctx_t *wctx);
+
 /*
  * Initialize platform (AF_XDP)
  */
 int xdp_platform_init(reflector_ctx_t *rctx, worker_ctx_t *wctx)
 {
-	(void)rctx; /* May be used for multi-worker coordination in future */
 	reflector_config_t *cfg = wctx->config;
 	struct platform_ctx *pctx = calloc(1, sizeof(*pctx));
 	if (!pctx) {
@@ -280,67 +975,61 @@ int xdp_platform_init(reflector_ctx_t *rctx, worker_ctx_t *wctx)
 	}
 
 	wctx->pctx = pctx;
-	pctx->frame_size = wctx->config->frame_size;
-	pctx->num_frames = wctx->config->num_frames;
+	xdp_compute_geometry(cfg, &pctx->geo);
+	pctx->frame_size = pctx->geo.frame_size;
+	pctx->num_frames = pctx->geo.num_frames;
+	pctx->fill_target = pctx->geo.fill_frames;
+	pctx->numa_node = get_nic_numa_node(cfg->ifname);
 
 	/* Initialize map FDs to -1 (will stay -1 if no eBPF program) */
 	pctx->xsks_map_fd = -1;
 	pctx->mac_map_fd = -1;
+	pctx->sig_map_fd = -1;
 	pctx->stats_map_fd = -1;
+	pctx->config_map_fd = -1;
 	pctx->prog_fd = -1;
 
-	/* Allocate UMEM buffer */
-	uint64_t umem_size = pctx->num_frames * pctx->frame_size;
-	void *umem_buffer;
-
-	/* Try huge pages if enabled in config (better TLB utilization) */
-	if (cfg->use_huge_pages) {
-#ifndef MAP_HUGETLB
-#define MAP_HUGETLB 0x40000 /* Linux-specific flag for huge pages */
-#endif
-		umem_buffer = mmap(NULL, umem_size, PROT_READ | PROT_WRITE,
-		                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
-
-		if (umem_buffer == MAP_FAILED) {
-			reflector_log(LOG_WARN,
-			              "Huge pages requested but not available, falling back to normal pages");
-			umem_buffer =
-			    mmap(NULL, umem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-		} else {
-			reflector_log(LOG_INFO, "Using huge pages for UMEM (reduces TLB misses)");
+	int ret;
+	if (cfg->shared_umem) {
+		ret = xdp_shared_umem_attach(rctx, pctx);
+		if (ret) {
+			free(pctx);
+			wctx->pctx = NULL; /* Prevent use-after-free */
+			return ret;
 		}
 	} else {
-		/* Use normal pages */
-		umem_buffer =
-		    mmap(NULL, umem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-	}
-
-	if (umem_buffer == MAP_FAILED) {
-		int saved_errno = errno;
-		reflector_log(LOG_ERROR, "Failed to allocate UMEM: %s", strerror(saved_errno));
-		free(pctx);
-		wctx->pctx = NULL; /* Prevent use-after-free */
-		return saved_errno ? -saved_errno : -ENOMEM;
-	}
+		/* Allocate UMEM buffer */
+		uint64_t umem_size = pctx->num_frames * pctx->frame_size;
+		void *umem_buffer =
+		    xdp_map_umem_area(umem_size, cfg->use_huge_pages, pctx->numa_node, &pctx->page_kb);
+		if (umem_buffer == MAP_FAILED) {
+			int saved_errno = errno;
+			reflector_log(LOG_ERROR, "Failed to allocate UMEM: %s", strerror(saved_errno));
+			free(pctx);
+			wctx->pctx = NULL; /* Prevent use-after-free */
+			return saved_errno ? -saved_errno : -ENOMEM;
+		}
 
-	reflector_log(LOG_INFO, "Allocated UMEM: %lu MB (%u frames of %u bytes)",
-	              umem_size / (1024 * 1024), pctx->num_frames, pctx->frame_size);
+		reflector_log(LOG_INFO,
+		              "Allocated UMEM: %lu MB (%u frames of %u bytes, %u kB pages, NUMA node %d)",
+		              umem_size / (1024 * 1024), pctx->num_frames, pctx->frame_size,
+		              pctx->page_kb, pctx->numa_node);
 
-	/* Configure UMEM */
-	int ret = configure_umem(pctx, umem_buffer, umem_size);
-	if (ret) {
-		munmap(umem_buffer, umem_size);
-		free(pctx);
-		wctx->pctx = NULL; /* Prevent use-after-free */
-		return ret;
+		/* Configure UMEM */
+		ret = configure_umem(pctx, umem_buffer, umem_size);
+		if (ret) {
+			munmap(umem_buffer, umem_size);
+			free(pctx);
+			wctx->pctx = NULL; /* Prevent use-after-free */
+			return ret;
+		}
 	}
 
 	/* Load and attach XDP program (only for first worker) */
 	if (wctx->worker_id == 0) {
 		ret = load_xdp_program(wctx);
 		if (ret) {
-			xsk_umem__delete(pctx->xsk_info.umem.umem);
-			munmap(umem_buffer, umem_size);
+			xdp_umem_put(pctx);
 			free(pctx);
 			wctx->pctx = NULL; /* Prevent use-after-free */
 			return ret;
@@ -357,6 +1046,7 @@ int xdp_platform_init(reflector_ctx_t *rctx, worker_ctx_t *wctx)
 		pctx->sig_map_fd = g_sig_map_fd;
 		pctx->stats_map_fd = g_stats_map_fd;
 		pctx->prog_fd = g_prog_fd;
+		pctx->rx_meta = g_rx_meta;
 	}
 
 	/* Initialize AF_XDP socket */
@@ -366,18 +1056,56 @@ int xdp_platform_init(reflector_ctx_t *rctx, worker_ctx_t *wctx)
 			bpf_xdp_detach(wctx->config->ifindex, XDP_FLAGS_UPDATE_IF_NOEXIST, NULL);
 			bpf_object__close(pctx->bpf_obj);
 		}
-		xsk_umem__delete(pctx->xsk_info.umem.umem);
-		munmap(umem_buffer, umem_size);
+		xdp_umem_put(pctx);
 		free(pctx);
 		wctx->pctx = NULL; /* Prevent use-after-free */
 		return ret;
 	}
 
-	/* Populate fill queue with initial buffers */
-	populate_fill_queue(pctx, pctx->num_frames / 2);
+	/* Hand the initial RX frames to the kernel */
+	ret = xdp_frame_alloc_init(pctx);
+	if (ret) {
+		reflector_log(LOG_ERROR, "Failed to allocate UMEM frame allocator");
+		xdp_platform_cleanup(wctx);
+		return ret;
+	}
+	xdp_fill_replenish(pctx);
 
 	pctx->xsk_info.outstanding_tx = 0;
 
+	/* stats_map lookups fill one value per possible CPU: size the buffer once */
+	if (wctx->worker_id == 0 && pctx->stats_map_fd >= 0) {
+		int ncpus = libbpf_num_possible_cpus();
+		if (ncpus <= 0) {
+			reflector_log(LOG_ERROR, "Failed to count possible CPUs: %s", strerror(-ncpus));
+			xdp_platform_cleanup(wctx);
+			return ncpus < 0 ? ncpus : -EINVAL;
+		}
+		pctx->stats_percpu = calloc((size_t)ncpus, sizeof(*pctx->stats_percpu));
+		if (!pctx->stats_percpu) {
+			reflector_log(LOG_ERROR, "Failed to allocate XDP stats buffer");
+			xdp_platform_cleanup(wctx);
+			return -ENOMEM;
+		}
+		pctx->stats_ncpus = ncpus;
+		pthread_mutex_init(&pctx->stats_lock, NULL);
+	}
+
+	/* Metadata stamps are raw PHC time: calibrate against the fast clock */
+	if (pctx->rx_meta) {
+		ret = phc_clock_open(&pctx->phc, wctx->config->ifname);
+		if (ret < 0) {
+			reflector_log(LOG_WARN,
+			              "No PTP clock for %s (%s): hardware stamps taken as CLOCK_REALTIME, "
+			              "sync the NIC clock with phc2sys",
+			              wctx->config->ifname, strerror(-ret));
+		}
+	}
+
+	reflector_log(LOG_INFO, "AF_XDP rings: fill=%u comp=%u rx=%u tx=%u (%u RX / %u TX frames)",
+	              pctx->geo.fill_size, pctx->geo.comp_size, pctx->geo.rx_size, pctx->geo.tx_size,
+	              pctx->geo.fill_frames, pctx->geo.tx_frames);
+
 	reflector_log(LOG_INFO, "AF_XDP platform initialized for worker %d", wctx->worker_id);
 	return 0;
 }
@@ -403,16 +1131,94 @@ void xdp_platform_cleanup(worker_ctx_t *wctx)
 		bpf_object__close(pctx->bpf_obj);
 	}
 
-	/* Delete UMEM */
-	if (pctx->xsk_info.umem.umem) {
-		munmap(pctx->xsk_info.umem.buffer, pctx->xsk_info.umem.buffer_size);
-		xsk_umem__delete(pctx->xsk_info.umem.umem);
+	if (pctx->frames.state) {
+		xdp_frame_alloc_report(pctx, wctx->worker_id);
 	}
+	xdp_frame_alloc_destroy(pctx);
+	phc_clock_close(&pctx->phc);
+	if (pctx->stats_percpu) {
+		pthread_mutex_destroy(&pctx->stats_lock);
+		free(pctx->stats_percpu);
+	}
+
+	/* Delete UMEM (the shared one only when its last user leaves) */
+	xdp_umem_put(pctx);
 
 	free(pctx);
 	wctx->pctx = NULL;
 }
 
+/*
+ * Helper: Poll completion queue and return completed TX frames to the free
+ * stack. Fill queue replenishment is separate (xdp_fill_replenish), so the CQ
+ * is drained completely: peeking the ring size takes every completion, however
+ * large the bursts. Returns number of frames completed.
+ */
+static int xdp_recycle_completed_tx(struct platform_ctx *pctx)
+{
+	uint32_t idx_cq;
+
+	uint32_t completed =
+	    xsk_ring_cons__peek(&pctx->xsk_info.umem.cq, pctx->geo.comp_size, &idx_cq);
+	if (completed == 0) {
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < completed; i++) {
+		uint64_t addr = *xsk_ring_cons__comp_addr(&pctx->xsk_info.umem.cq, idx_cq++);
+		xdp_frame_free(pctx, addr, XDP_FRAME_TX);
+	}
+	xsk_ring_cons__release(&pctx->xsk_info.umem.cq, completed);
+	pctx->xsk_info.outstanding_tx -= completed;
+
+	return (int)completed;
+}
+
+/* Wake the kernel TX path (needed when the socket uses need_wakeup) */
+static inline void xdp_kick_tx(struct platform_ctx *pctx)
+{
+	if (xsk_ring_prod__needs_wakeup(&pctx->xsk_info.tx)) {
+		sendto(xsk_socket__fd(pctx->xsk_info.xsk), NULL, 0, MSG_DONTWAIT, NULL, 0);
+	}
+}
+
+/* TX ring callbacks for the shared backlog (tx_backlog_send) */
+static uint32_t xdp_tx_submit(worker_ctx_t *wctx, const packet_t *pkts, uint32_t n)
+{
+	struct platform_ctx *pctx = wctx->pctx;
+	uint32_t idx_tx;
+
+	uint32_t reserved = xsk_ring_prod__reserve(&pctx->xsk_info.tx, n, &idx_tx);
+	for (uint32_t i = 0; i < reserved; i++) {
+		struct xdp_desc *tx_desc = xsk_ring_prod__tx_desc(&pctx->xsk_info.tx, idx_tx++);
+		tx_desc->addr = pkts[i].addr;
+		tx_desc->len = pkts[i].len;
+		tx_desc->options = 0;
+	}
+	if (reserved > 0) {
+		xsk_ring_prod__submit(&pctx->xsk_info.tx, reserved);
+		pctx->xsk_info.outstanding_tx += reserved;
+	}
+	return reserved;
+}
+
+static void xdp_tx_reclaim(worker_ctx_t *wctx)
+{
+	xdp_kick_tx(wctx->pctx);
+	xdp_recycle_completed_tx(wctx->pctx);
+}
+
+static void xdp_tx_drop(worker_ctx_t *wctx, const packet_t *pkt)
+{
+	xdp_frame_free(wctx->pctx, pkt->addr, XDP_FRAME_TX);
+}
+
+static const tx_ring_ops_t xdp_tx_ring_ops = {
+    .submit = xdp_tx_submit,
+    .reclaim = xdp_tx_reclaim,
+    .drop = xdp_tx_drop,
+};
+
 /*
  * Receive batch of packets (zero-copy)
  */
@@ -422,11 +1228,21 @@ int xdp_platform_recv_batch(worker_ctx_t *wctx, packet_t *pkts, int max_pkts)
 	uint32_t idx_rx;
 	int rcvd;
 
-	/* Check if we need to wake up kernel (NEED_WAKEUP flag) */
-	if (xsk_ring_prod__needs_wakeup(&pctx->xsk_info.umem.fq)) {
+	/* Wake the kernel if it asked (NEED_WAKEUP), or drive NAPI when preferring busy poll */
+	if (pctx->prefer_busy_poll || xsk_ring_prod__needs_wakeup(&pctx->xsk_info.umem.fq)) {
 		recvfrom(xsk_socket__fd(pctx->xsk_info.xsk), NULL, 0, MSG_DONTWAIT, NULL, NULL);
 	}
 
+	/* Keep draining queued TX even when no new traffic arrives */
+	if (unlikely(pctx->tx_backlog.count > 0)) {
+		xdp_recycle_completed_tx(pctx);
+		tx_backlog_flush(wctx, &pctx->tx_backlog, &xdp_tx_ring_ops);
+		xdp_kick_tx(pctx);
+	}
+
+	/* Repost frames freed by RX drops and TX completions */
+	xdp_fill_replenish(pctx);
+
 	/* Receive packets from RX ring */
 	rcvd = xsk_ring_cons__peek(&pctx->xsk_info.rx, max_pkts, &idx_rx);
 	if (rcvd == 0) {
@@ -438,12 +1254,22 @@ int xdp_platform_recv_batch(worker_ctx_t *wctx, packet_t *pkts, int max_pkts)
 		uint64_t addr = xsk_ring_cons__rx_desc(&pctx->xsk_info.rx, idx_rx)->addr;
 		uint32_t len = xsk_ring_cons__rx_desc(&pctx->xsk_info.rx, idx_rx++)->len;
 
+		xdp_frame_move(pctx, addr, XDP_FRAME_FILL, XDP_FRAME_APP);
 		pkts[i].addr = addr;
 		pkts[i].len = len;
 		pkts[i].data = xsk_umem__get_data(pctx->xsk_info.umem.buffer, addr);
 
-		/* Only timestamp if latency measurement is enabled (avoid hot-path syscall overhead) */
-		pkts[i].timestamp = wctx->config->measure_latency ? get_timestamp_ns() : 0;
+		/* NIC RX time from XDP metadata if present; 0 lets the core stamp the burst */
+		pkts[i].timestamp = 0;
+		if (pctx->rx_meta) {
+			struct xdp_rx_meta *meta = (struct xdp_rx_meta *)pkts[i].data - 1;
+			if (meta->flags & XDP_META_RX_TIMESTAMP) {
+				pkts[i].timestamp = pctx->phc.active
+				                        ? phc_clock_to_fast(&pctx->phc, meta->rx_timestamp)
+				                        : fast_clock_from_realtime(meta->rx_timestamp);
+				meta->flags = 0; /* Headroom is reused; never trust a stale stamp */
+			}
+		}
 	}
 
 	/* Release RX descriptors */
@@ -453,135 +1279,134 @@ int xdp_platform_recv_batch(worker_ctx_t *wctx, packet_t *pkts, int max_pkts)
 }
 
 /*
- * Helper: Poll completion queue and recycle completed TX buffers to fill queue
- * This enables proper buffer recycling for zero-copy XDP operation.
- * Returns number of buffers recycled.
+ * Send batch of packets (zero-copy)
  */
-static int xdp_recycle_completed_tx(struct platform_ctx *pctx)
+int xdp_platform_send_batch(worker_ctx_t *wctx, packet_t *pkts, int num_pkts)
 {
-	uint32_t idx_cq, idx_fq;
+	struct platform_ctx *pctx = wctx->pctx;
 
-	/* Poll completion queue to see what TX completed */
-	int completed = xsk_ring_cons__peek(&pctx->xsk_info.umem.cq, BATCH_SIZE, &idx_cq);
-	if (completed <= 0) {
+	/* Validate num_pkts to prevent out-of-bounds access */
+	if (unlikely(num_pkts < 0 || num_pkts > MAX_BATCH_SIZE)) {
+		reflector_log(LOG_ERROR, "Invalid num_pkts: %d (must be 0-%d)", num_pkts, MAX_BATCH_SIZE);
 		return 0;
 	}
 
-	/* Try to reserve space in fill queue for recycling */
-	int reserved = xsk_ring_prod__reserve(&pctx->xsk_info.umem.fq, completed, &idx_fq);
-	if (reserved > 0) {
-		/* Return completed buffers to fill queue */
-		for (int i = 0; i < reserved; i++) {
-			uint64_t addr = *xsk_ring_cons__comp_addr(&pctx->xsk_info.umem.cq, idx_cq++);
-			*xsk_ring_prod__fill_addr(&pctx->xsk_info.umem.fq, idx_fq++) = addr;
-		}
-		xsk_ring_prod__submit(&pctx->xsk_info.umem.fq, reserved);
+	/* Frames belong to the TX path until they complete or the backlog drops them */
+	for (int i = 0; i < num_pkts; i++) {
+		xdp_frame_move(pctx, pkts[i].addr, XDP_FRAME_APP, XDP_FRAME_TX);
 	}
 
-	/* Release from completion queue (even if couldn't reserve FQ space) */
-	xsk_ring_cons__release(&pctx->xsk_info.umem.cq, completed);
-	pctx->xsk_info.outstanding_tx -= completed;
+	/* Eagerly recycle completed TX buffers; the backlog goes out ahead of this burst */
+	xdp_recycle_completed_tx(pctx);
+	int accepted = tx_backlog_send(wctx, &pctx->tx_backlog, &xdp_tx_ring_ops, pkts, num_pkts);
+
+	/* Note: Stats are counted in core.c, not here (to avoid double-counting) */
+	if (accepted > 0 || pctx->tx_backlog.count > 0) {
+		xdp_kick_tx(pctx);
+	}
 
-	return completed;
+	return accepted;
 }
 
 /*
- * Send batch of packets (zero-copy)
+ * Idle wait: return completed TX frames, repost fill frames, then sleep in
+ * poll() until the RX ring has descriptors. Queued TX keeps the worker awake.
  */
-int xdp_platform_send_batch(worker_ctx_t *wctx, packet_t *pkts, int num_pkts)
+int xdp_platform_wait_rx(worker_ctx_t *wctx, int timeout_ms)
 {
 	struct platform_ctx *pctx = wctx->pctx;
-	uint32_t idx_tx;
 
-	/* Validate num_pkts to prevent out-of-bounds access */
-	if (unlikely(num_pkts < 0 || num_pkts > BATCH_SIZE)) {
-		reflector_log(LOG_ERROR, "Invalid num_pkts: %d (must be 0-%d)", num_pkts, BATCH_SIZE);
-		return 0;
+	if (pctx->tx_backlog.count > 0) {
+		return 1;
 	}
-
-	/* Eagerly recycle completed TX buffers to prevent UMEM exhaustion */
 	xdp_recycle_completed_tx(pctx);
+	xdp_fill_replenish(pctx);
 
-	/* Reserve space in TX ring */
-	int reserved = xsk_ring_prod__reserve(&pctx->xsk_info.tx, num_pkts, &idx_tx);
-	if (reserved == 0) {
-		/* TX ring full, recycle again and retry */
-		xdp_recycle_completed_tx(pctx);
-		return 0;
-	}
-
-	/* Submit packets to TX ring */
-	/* Note: Stats are counted in core.c, not here (to avoid double-counting) */
-	for (int i = 0; i < reserved; i++) {
-		struct xdp_desc *tx_desc = xsk_ring_prod__tx_desc(&pctx->xsk_info.tx, idx_tx++);
-		tx_desc->addr = pkts[i].addr;
-		tx_desc->len = pkts[i].len;
+	struct pollfd pfd = {.fd = xsk_socket__fd(pctx->xsk_info.xsk), .events = POLLIN};
+	int ret = poll(&pfd, 1, timeout_ms);
+	if (ret < 0) {
+		return errno == EINTR ? 0 : -errno;
 	}
+	return ret;
+}
 
-	xsk_ring_prod__submit(&pctx->xsk_info.tx, reserved);
-	pctx->xsk_info.outstanding_tx += reserved;
+/*
+ * Return received packets that will not be transmitted to the allocator.
+ * Packets handed to send_batch() are never released here: send_batch owns
+ * them and they come back through the completion queue.
+ */
+void xdp_platform_release_batch(worker_ctx_t *wctx, packet_t *pkts, int num_pkts)
+{
+	struct platform_ctx *pctx = wctx->pctx;
 
-	/* Kick TX if needed */
-	if (xsk_ring_prod__needs_wakeup(&pctx->xsk_info.tx)) {
-		sendto(xsk_socket__fd(pctx->xsk_info.xsk), NULL, 0, MSG_DONTWAIT, NULL, 0);
+	for (int i = 0; i < num_pkts; i++) {
+		xdp_frame_free(pctx, pkts[i].addr, XDP_FRAME_APP);
 	}
-
-	return reserved;
 }
 
 /*
- * Return buffers to fill queue
+ * Merge in-kernel XDP counters into aggregated stats
  *
- * For zero-copy XDP, this function handles two distinct use cases:
- *
- * 1. Immediate release of unwanted RX packets (num_pkts typically 1)
- *    - Non-ITO packets that were never sent to TX
- *    - Can safely return directly to FQ
- *
- * 2. Post-TX buffer recycling (num_pkts typically > 1)
- *    - Called after send_batch with packets just submitted to TX
- *    - Those packets are in-flight, so we poll CQ instead
- *    - Completed buffers are recycled via CQ polling
- *
- * Heuristic: Single packet release is immediate FQ return (case 1),
- * batch release is CQ polling (case 2). This works because core.c
- * calls release_batch(&pkt, 1) for non-ITO and release_batch(pkts, sent)
- * after send_batch where sent > 1 for batches.
+ * The program's own counters (seen/matched/passed/dropped) are reported in
+ * stats->xdp. Packets reflected with XDP_TX never reach a worker, so their
+ * counts live only in the per-CPU stats_map and are also folded into the
+ * packet and signature totals. Only worker 0 reports the shared map to
+ * avoid counting it once per worker.
  */
-void xdp_platform_release_batch(worker_ctx_t *wctx, packet_t *pkts, int num_pkts)
+void xdp_platform_get_stats(const worker_ctx_t *wctx, reflector_stats_t *stats)
 {
 	struct platform_ctx *pctx = wctx->pctx;
-	uint32_t idx_fq;
-
-	/* Validate num_pkts to prevent out-of-bounds access */
-	if (unlikely(num_pkts < 0 || num_pkts > BATCH_SIZE)) {
-		reflector_log(LOG_ERROR, "Invalid num_pkts: %d (must be 0-%d)", num_pkts, BATCH_SIZE);
+	if (!pctx || wctx->worker_id != 0 || !pctx->stats_percpu) {
 		return;
 	}
 
-	/*
-	 * Always poll CQ to recycle completed TX buffers.
-	 * This ensures continuous buffer flow in zero-copy mode.
-	 */
-	xdp_recycle_completed_tx(pctx);
+	const struct xdp_stats *percpu = pctx->stats_percpu;
+	const int ncpus = pctx->stats_ncpus;
+	uint32_t key = 0;
 
-	/*
-	 * Handle immediate release for single non-ITO packets.
-	 * These were never sent to TX, so safe to return directly to FQ.
-	 *
-	 * For batch releases (num_pkts > 1), assume post-TX and skip immediate
-	 * release since those packets are in-flight. They'll be recycled when
-	 * they appear in CQ.
-	 */
-	if (num_pkts == 1) {
-		/* Single packet: likely non-ITO, release immediately */
-		int reserved = xsk_ring_prod__reserve(&pctx->xsk_info.umem.fq, 1, &idx_fq);
-		if (reserved > 0) {
-			*xsk_ring_prod__fill_addr(&pctx->xsk_info.umem.fq, idx_fq) = pkts[0].addr;
-			xsk_ring_prod__submit(&pctx->xsk_info.umem.fq, 1);
+	pthread_mutex_lock(&pctx->stats_lock);
+	if (bpf_map_lookup_elem(pctx->stats_map_fd, &key, pctx->stats_percpu) == 0) {
+		stats->xdp.valid = true;
+		for (int cpu = 0; cpu < ncpus; cpu++) {
+			stats->xdp.packets_total += percpu[cpu].packets_total;
+			stats->xdp.packets_ito += percpu[cpu].packets_ito;
+			stats->xdp.packets_passed += percpu[cpu].packets_passed;
+			stats->xdp.packets_dropped += percpu[cpu].packets_dropped;
+			stats->xdp.packets_tx += percpu[cpu].packets_tx;
+			stats->xdp.bytes_tx += percpu[cpu].bytes_tx;
+
+			if (!wctx->config->xdp_tx) {
+				continue;
+			}
+			stats->packets_received += percpu[cpu].packets_tx;
+			stats->packets_reflected += percpu[cpu].packets_tx;
+			stats->bytes_received += percpu[cpu].bytes_tx;
+			stats->bytes_reflected += percpu[cpu].bytes_tx;
+			stats->sig_probeot_count += percpu[cpu].sig_tx[SIG_TYPE_PROBEOT];
+			stats->sig_dataot_count += percpu[cpu].sig_tx[SIG_TYPE_DATAOT];
+			stats->sig_latency_count += percpu[cpu].sig_tx[SIG_TYPE_LATENCY];
+			stats->sig_rfc2544_count += percpu[cpu].sig_tx[SIG_TYPE_RFC2544];
+			stats->sig_y1564_count += percpu[cpu].sig_tx[SIG_TYPE_Y1564];
 		}
 	}
-	/* else: batch release after TX, buffers recycled via CQ polling above */
+	pthread_mutex_unlock(&pctx->stats_lock);
+}
+
+/*
+ * Clear in-kernel counters (worker 0 owns the shared stats_map)
+ */
+void xdp_platform_reset_stats(worker_ctx_t *wctx)
+{
+	struct platform_ctx *pctx = wctx->pctx;
+	if (!pctx || wctx->worker_id != 0 || !pctx->stats_percpu) {
+		return;
+	}
+
+	uint32_t key = 0;
+	pthread_mutex_lock(&pctx->stats_lock);
+	memset(pctx->stats_percpu, 0, (size_t)pctx->stats_ncpus * sizeof(*pctx->stats_percpu));
+	bpf_map_update_elem(pctx->stats_map_fd, &key, pctx->stats_percpu, BPF_ANY);
+	pthread_mutex_unlock(&pctx->stats_lock);
 }
 
 /* Platform operations structure */
@@ -592,6 +1417,9 @@ static const platform_ops_t xdp_platform_ops = {
     .recv_batch = xdp_platform_recv_batch,
     .send_batch = xdp_platform_send_batch,
     .release_batch = xdp_platform_release_batch,
+    .get_stats = xdp_platform_get_stats,
+    .reset_stats = xdp_platform_reset_stats,
+    .wait_rx = xdp_platform_wait_rx,
 };
 
 const platform_ops_t *get_xdp_platform_ops(void)
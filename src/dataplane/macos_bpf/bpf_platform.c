@@ -439,7 +439,9 @@ int bpf_platform_recv_batch(worker_ctx_t *wctx, packet_t *pkts, int max_pkts)
 
 		if (nev == 0) {
 			/* Timeout */
+			worker_stats_write_begin(wctx);
 			wctx->stats.poll_timeout++;
+			worker_stats_write_end(wctx);
 			return 0;
 		}
 
@@ -482,8 +484,12 @@ int bpf_platform_recv_batch(worker_ctx_t *wctx, packet_t *pkts, int max_pkts)
 		pkts[num_pkts].len = pkt_len;
 		pkts[num_pkts].addr = 0; /* Not used on macOS */
 
-		/* Only timestamp if latency measurement is enabled (avoid hot-path syscall overhead) */
-		pkts[num_pkts].timestamp = wctx->config->measure_latency ? get_timestamp_ns() : 0;
+		/* Kernel capture time (realtime, microseconds) mapped into the fast clock domain */
+		pkts[num_pkts].timestamp =
+		    wctx->config->measure_latency
+		        ? fast_clock_from_realtime((uint64_t)bh->bh_tstamp.tv_sec * 1000000000ULL +
+		                                   (uint64_t)bh->bh_tstamp.tv_usec * 1000ULL)
+		        : 0;
 
 		num_pkts++;
 
@@ -508,7 +514,9 @@ static int flush_write_buffer(struct platform_ctx *pctx, worker_ctx_t *wctx)
 		int saved_errno = errno;
 		if (saved_errno != EAGAIN && saved_errno != ENOBUFS) {
 			reflector_log(LOG_ERROR, "BPF write error: %s", strerror(saved_errno));
+			worker_stats_write_begin(wctx);
 			wctx->stats.tx_errors++;
+			worker_stats_write_end(wctx);
 		}
 		errno = saved_errno;
 		return -1;
@@ -538,7 +546,9 @@ int bpf_platform_send_batch(worker_ctx_t *wctx, packet_t *pkts, int num_pkts)
 					if (errno == EAGAIN || errno == ENOBUFS) {
 						break; /* Would block, stop here */
 					}
+					worker_stats_write_begin(wctx);
 					wctx->stats.tx_errors++;
+					worker_stats_write_end(wctx);
 					continue;
 				}
 				if ((size_t)n == pkts[i].len) {
@@ -0,0 +1,716 @@
+/*
+ * vnic_platform.c - In-memory "virtual NIC" for tests and benchmarks
+ *
+ * Copyright (c) 2025 Kris Armstrong
+ *
+ * Runs the complete worker loop (batching, classification, reflection,
+ * stats, release semantics, multi-worker scaling) without a NIC or root:
+ * - RX: frames replayed from a pcap file, or synthetic ITO PROBEOT probes,
+ *   copied into a per-worker buffer arena the way a NIC DMAs into its ring
+ * - TX: a counting sink, optionally captured to a pcap file; optionally a
+ *   bounded ring that completes only between calls (or never, when stalled),
+ *   so send_batch() sees short counts and the TX backlog runs
+ * - Every buffer's owner is tracked, so a core change that sends, releases
+ *   or leaks a buffer wrongly shows up in vnic_stats_t
+ *
+ * Selected with the interface name "vnic" on every platform.
+ */
+
+#include "reflector.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#define VNIC_NUM_FRAMES (4 * MAX_BATCH_SIZE) /* Arena buffers per worker (power of two) */
+#define VNIC_FRAME_MASK (VNIC_NUM_FRAMES - 1)
+#define VNIC_FRAME_STRIDE 2048      /* Minimum buffer stride, as in a NIC RX ring */
+#define VNIC_MAX_FRAME_LEN 16384    /* Longest pcap frame replayed */
+#define VNIC_DEFAULT_FRAME_LEN 64   /* Synthetic frame length */
+#define VNIC_SYNTH_FLOWS 64         /* Synthetic probes differ in source MAC/IP/port */
+
+/* Classic pcap format (no libpcap dependency) */
+#define PCAP_MAGIC_USEC 0xa1b2c3d4u
+#define PCAP_MAGIC_NSEC 0xa1b23c4du
+#define PCAP_LINKTYPE_ETHERNET 1
+
+struct pcap_file_hdr {
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+};
+
+struct pcap_rec_hdr {
+	uint32_t ts_sec;
+	uint32_t ts_frac; /* usec or nsec, per magic */
+	uint32_t incl_len;
+	uint32_t orig_len;
+};
+
+/* Largest TX ring: the backlog and one RX burst must still fit in the arena */
+#define VNIC_MAX_TX_RING (VNIC_NUM_FRAMES - TX_BACKLOG_SIZE - MAX_BATCH_SIZE)
+
+/* Buffer owner */
+enum { VNIC_FRAME_FREE = 0, VNIC_FRAME_APP = 1, VNIC_FRAME_TX = 2 };
+
+/* Platform context (per-worker) */
+struct platform_ctx {
+	/* Source frames, replayed round-robin */
+	uint8_t *src_data;
+	uint32_t *src_off;
+	uint32_t *src_len;
+	uint32_t num_src;
+	uint32_t next_src;
+	uint64_t rx_budget; /* Frames left to inject (UINT64_MAX = unlimited) */
+	uint64_t rx_credit; /* Frames added from another thread (vnic_add_rx_frames) */
+
+	/* Buffer arena; free buffers cycle FIFO like descriptors in an RX ring */
+	uint8_t *arena;
+	uint32_t stride;
+	uint32_t free_ring[VNIC_NUM_FRAMES];
+	uint32_t free_head;
+	uint32_t free_count;
+	uint8_t owner[VNIC_NUM_FRAMES]; /* VNIC_FRAME_* */
+	uint64_t rx_seq[VNIC_NUM_FRAMES]; /* RX order of the frame in each buffer */
+	uint64_t next_seq;
+	uint64_t last_tx_seq;
+
+	/* Bounded TX ring (tx_ring_size 0 = frames complete inside send_batch) */
+	packet_t tx_ring[VNIC_MAX_TX_RING];
+	uint32_t tx_ring_size;
+	uint32_t tx_ring_count;
+	bool tx_stall; /* The ring never completes */
+	tx_backlog_t tx_backlog;
+
+	bool capture; /* Reflected frames go to the shared TX pcap */
+	vnic_stats_t stats;
+};
+
+/* Shared by all workers: TX capture file and totals of cleaned-up workers */
+static pthread_mutex_t vnic_lock = PTHREAD_MUTEX_INITIALIZER;
+static FILE *vnic_tx_file;
+static int vnic_tx_refs;
+static vnic_stats_t vnic_totals;
+
+bool is_vnic_ifname(const char *ifname)
+{
+	return ifname != NULL && strcmp(ifname, VNIC_IFNAME) == 0;
+}
+
+void vnic_get_totals(vnic_stats_t *totals)
+{
+	pthread_mutex_lock(&vnic_lock);
+	*totals = vnic_totals;
+	pthread_mutex_unlock(&vnic_lock);
+}
+
+void vnic_reset_totals(void)
+{
+	pthread_mutex_lock(&vnic_lock);
+	memset(&vnic_totals, 0, sizeof(vnic_totals));
+	pthread_mutex_unlock(&vnic_lock);
+}
+
+void vnic_add_rx_frames(worker_ctx_t *wctx, uint64_t frames)
+{
+	struct platform_ctx *pctx = wctx->pctx;
+
+	if (pctx != NULL) {
+		__atomic_fetch_add(&pctx->rx_credit, frames, __ATOMIC_RELEASE);
+	}
+}
+
+/* Fold frames added by vnic_add_rx_frames() into the worker's budget */
+static inline void vnic_take_rx_credit(struct platform_ctx *pctx)
+{
+	if (unlikely(__atomic_load_n(&pctx->rx_credit, __ATOMIC_RELAXED) != 0)) {
+		uint64_t credit = __atomic_exchange_n(&pctx->rx_credit, 0, __ATOMIC_ACQUIRE);
+		if (pctx->rx_budget != UINT64_MAX) {
+			pctx->rx_budget += credit;
+		}
+	}
+}
+
+/* Append one source frame */
+static int vnic_add_source(struct platform_ctx *pctx, const uint8_t *data, uint32_t len,
+                           size_t *data_cap, uint32_t *num_cap)
+{
+	uint32_t off = pctx->num_src > 0 ? pctx->src_off[pctx->num_src - 1] +
+	                                       pctx->src_len[pctx->num_src - 1]
+	                                 : 0;
+
+	if (pctx->num_src == *num_cap) {
+		uint32_t cap = *num_cap ? *num_cap * 2 : 64;
+		uint32_t *offs = realloc(pctx->src_off, cap * sizeof(*offs));
+		if (offs == NULL) {
+			return -ENOMEM;
+		}
+		pctx->src_off = offs;
+		uint32_t *lens = realloc(pctx->src_len, cap * sizeof(*lens));
+		if (lens == NULL) {
+			return -ENOMEM;
+		}
+		pctx->src_len = lens;
+		*num_cap = cap;
+	}
+	if ((size_t)off + len > *data_cap) {
+		size_t cap = *data_cap ? *data_cap : 65536;
+		while (cap < (size_t)off + len) {
+			cap *= 2;
+		}
+		uint8_t *buf = realloc(pctx->src_data, cap);
+		if (buf == NULL) {
+			return -ENOMEM;
+		}
+		pctx->src_data = buf;
+		*data_cap = cap;
+	}
+
+	memcpy(pctx->src_data + off, data, len);
+	pctx->src_off[pctx->num_src] = off;
+	pctx->src_len[pctx->num_src] = len;
+	pctx->num_src++;
+	return 0;
+}
+
+/*
+ * Load every Ethernet frame of a classic pcap file (either byte order,
+ * usec or nsec timestamps). Frames longer than VNIC_MAX_FRAME_LEN or
+ * shorter than an Ethernet header are skipped.
+ */
+static int vnic_load_pcap(struct platform_ctx *pctx, const char *path)
+{
+	FILE *f = fopen(path, "rb");
+	if (f == NULL) {
+		int err = errno;
+		reflector_log(LOG_ERROR, "vnic: cannot open %s: %s", path, strerror(err));
+		return -err;
+	}
+
+	struct pcap_file_hdr fh;
+	if (fread(&fh, sizeof(fh), 1, f) != 1) {
+		reflector_log(LOG_ERROR, "vnic: %s is not a pcap file", path);
+		fclose(f);
+		return -EINVAL;
+	}
+	bool swap = fh.magic == __builtin_bswap32(PCAP_MAGIC_USEC) ||
+	            fh.magic == __builtin_bswap32(PCAP_MAGIC_NSEC);
+	uint32_t linktype = swap ? __builtin_bswap32(fh.linktype) : fh.linktype;
+	if ((!swap && fh.magic != PCAP_MAGIC_USEC && fh.magic != PCAP_MAGIC_NSEC) ||
+	    linktype != PCAP_LINKTYPE_ETHERNET) {
+		reflector_log(LOG_ERROR, "vnic: %s is not an Ethernet pcap file (pcapng is not read)",
+		              path);
+		fclose(f);
+		return -EINVAL;
+	}
+
+	uint8_t *frame = malloc(VNIC_MAX_FRAME_LEN);
+	if (frame == NULL) {
+		fclose(f);
+		return -ENOMEM;
+	}
+
+	size_t data_cap = 0;
+	uint32_t num_cap = 0;
+	uint32_t skipped = 0;
+	int ret = 0;
+	struct pcap_rec_hdr rh;
+	while (fread(&rh, sizeof(rh), 1, f) == 1) {
+		uint32_t len = swap ? __builtin_bswap32(rh.incl_len) : rh.incl_len;
+		if (len < ETH_HDR_LEN || len > VNIC_MAX_FRAME_LEN) {
+			skipped++;
+			if (fseek(f, (long)len, SEEK_CUR) != 0) {
+				break;
+			}
+			continue;
+		}
+		if (fread(frame, len, 1, f) != 1) {
+			break; /* Truncated final record */
+		}
+		ret = vnic_add_source(pctx, frame, len, &data_cap, &num_cap);
+		if (ret < 0) {
+			break;
+		}
+	}
+	free(frame);
+	fclose(f);
+
+	if (ret < 0) {
+		return ret;
+	}
+	if (pctx->num_src == 0) {
+		reflector_log(LOG_ERROR, "vnic: no usable frames in %s", path);
+		return -EINVAL;
+	}
+	if (skipped > 0) {
+		reflector_log(LOG_WARN, "vnic: skipped %u frames outside %d-%d bytes in %s", skipped,
+		              ETH_HDR_LEN, VNIC_MAX_FRAME_LEN, path);
+	}
+	return 0;
+}
+
+/*
+ * Synthetic ITO PROBEOT probes that pass the default filters: to our MAC,
+ * from the configured OUI, IPv4/UDP to ito_port, RFC 2544 benchmark
+ * addresses (198.18.0.0/15). Flows differ in source MAC, IP and port.
+ */
+static int vnic_build_synthetic(struct platform_ctx *pctx, const reflector_config_t *cfg)
+{
+	uint32_t len =
+	    cfg->vnic_frame_len > 0 ? (uint32_t)cfg->vnic_frame_len : VNIC_DEFAULT_FRAME_LEN;
+	if (len < MIN_ITO_PACKET_LEN || len > VNIC_MAX_FRAME_LEN) {
+		reflector_log(LOG_ERROR, "vnic: frame length %u outside %d-%d", len, MIN_ITO_PACKET_LEN,
+		              VNIC_MAX_FRAME_LEN);
+		return -EINVAL;
+	}
+
+	uint8_t *frame = calloc(1, len);
+	if (frame == NULL) {
+		return -ENOMEM;
+	}
+
+	size_t data_cap = 0;
+	uint32_t num_cap = 0;
+	uint16_t dst_port = cfg->ito_port ? cfg->ito_port : ITO_UDP_PORT;
+	int ret = 0;
+	for (uint16_t flow = 0; flow < VNIC_SYNTH_FLOWS && ret == 0; flow++) {
+		memset(frame, 0, len);
+
+		/* Ethernet */
+		memcpy(frame + ETH_DST_OFFSET, cfg->mac, 6);
+		memcpy(frame + ETH_SRC_OFFSET, cfg->oui, 3);
+		frame[ETH_SRC_OFFSET + 5] = (uint8_t)flow;
+		frame[ETH_TYPE_OFFSET] = 0x08;
+
+		/* IPv4, 198.18.0.<flow+1> -> 198.19.0.1 */
+		uint8_t *ip = frame + ETH_HDR_LEN;
+		uint16_t ip_len = htons((uint16_t)(len - ETH_HDR_LEN));
+		ip[IP_VER_IHL_OFFSET] = 0x45;
+		memcpy(ip + 2, &ip_len, 2);
+		ip[8] = 64;
+		ip[IP_PROTO_OFFSET] = IPPROTO_UDP;
+		const uint8_t src_ip[4] = {198, 18, 0, (uint8_t)(flow + 1)};
+		const uint8_t dst_ip[4] = {198, 19, 0, 1};
+		memcpy(ip + IP_SRC_OFFSET, src_ip, 4);
+		memcpy(ip + IP_DST_OFFSET, dst_ip, 4);
+		uint16_t ip_check = htons((uint16_t)~checksum_partial(ip, IP_HDR_MIN_LEN, 0));
+		memcpy(ip + 10, &ip_check, 2);
+
+		/* UDP (no checksum) */
+		uint8_t *udp = ip + IP_HDR_MIN_LEN;
+		uint16_t sport = htons((uint16_t)(49152 + flow));
+		uint16_t dport = htons(dst_port);
+		uint16_t udp_len = htons((uint16_t)(len - ETH_HDR_LEN - IP_HDR_MIN_LEN));
+		memcpy(udp + UDP_SRC_PORT_OFFSET, &sport, 2);
+		memcpy(udp + UDP_DST_PORT_OFFSET, &dport, 2);
+		memcpy(udp + 4, &udp_len, 2);
+
+		/* 5-byte header, then the signature */
+		memcpy(udp + UDP_HDR_LEN + ITO_SIG_OFFSET, ITO_SIG_PROBEOT, ITO_SIG_LEN);
+
+		ret = vnic_add_source(pctx, frame, len, &data_cap, &num_cap);
+	}
+	free(frame);
+	return ret;
+}
+
+/* Shared TX capture: opened by the first worker, closed by the last */
+static int vnic_capture_open(const char *path)
+{
+	int ret = 0;
+
+	pthread_mutex_lock(&vnic_lock);
+	if (vnic_tx_refs == 0) {
+		vnic_tx_file = fopen(path, "wb");
+		if (vnic_tx_file == NULL) {
+			ret = -errno;
+			reflector_log(LOG_ERROR, "vnic: cannot create %s: %s", path, strerror(-ret));
+		} else {
+			struct pcap_file_hdr fh = {
+			    .magic = PCAP_MAGIC_NSEC,
+			    .version_major = 2,
+			    .version_minor = 4,
+			    .snaplen = VNIC_MAX_FRAME_LEN,
+			    .linktype = PCAP_LINKTYPE_ETHERNET,
+			};
+			fwrite(&fh, sizeof(fh), 1, vnic_tx_file);
+		}
+	}
+	if (ret == 0) {
+		vnic_tx_refs++;
+	}
+	pthread_mutex_unlock(&vnic_lock);
+	return ret;
+}
+
+static void vnic_capture_close(void)
+{
+	pthread_mutex_lock(&vnic_lock);
+	if (--vnic_tx_refs == 0 && vnic_tx_file != NULL) {
+		fclose(vnic_tx_file);
+		vnic_tx_file = NULL;
+	}
+	pthread_mutex_unlock(&vnic_lock);
+}
+
+/* Take a buffer from its current owner; false if `from` did not own it */
+static inline bool vnic_move_frame(struct platform_ctx *pctx, uint64_t addr, uint8_t from,
+                                   uint8_t to)
+{
+	if (unlikely(addr >= VNIC_NUM_FRAMES || pctx->owner[addr] != from)) {
+		pctx->stats.bad_returns++;
+		return false;
+	}
+	pctx->owner[addr] = to;
+	if (to == VNIC_FRAME_FREE) {
+		pctx->free_ring[(pctx->free_head + pctx->free_count) & VNIC_FRAME_MASK] =
+		    (uint32_t)addr;
+		pctx->free_count++;
+	}
+	return true;
+}
+
+/* Put frames on the wire: capture, count, check RX order, recycle buffers */
+static int vnic_transmit(struct platform_ctx *pctx, const packet_t *pkts, int num_pkts,
+                         uint8_t from)
+{
+	int sent = 0;
+
+	if (unlikely(pctx->capture)) {
+		struct timespec ts;
+		clock_gettime(CLOCK_REALTIME, &ts);
+		pthread_mutex_lock(&vnic_lock);
+		for (int i = 0; i < num_pkts; i++) {
+			struct pcap_rec_hdr rh = {
+			    .ts_sec = (uint32_t)ts.tv_sec,
+			    .ts_frac = (uint32_t)ts.tv_nsec,
+			    .incl_len = pkts[i].len,
+			    .orig_len = pkts[i].len,
+			};
+			fwrite(&rh, sizeof(rh), 1, vnic_tx_file);
+			fwrite(pkts[i].data, pkts[i].len, 1, vnic_tx_file);
+		}
+		pthread_mutex_unlock(&vnic_lock);
+	}
+
+	for (int i = 0; i < num_pkts; i++) {
+		uint64_t addr = pkts[i].addr;
+		if (vnic_move_frame(pctx, addr, from, VNIC_FRAME_FREE)) {
+			if (unlikely(pctx->rx_seq[addr] < pctx->last_tx_seq)) {
+				pctx->stats.tx_reordered++;
+			} else {
+				pctx->last_tx_seq = pctx->rx_seq[addr];
+			}
+			pctx->stats.tx_bytes += pkts[i].len;
+			sent++;
+		}
+	}
+	pctx->stats.tx_frames += (uint64_t)sent;
+
+	return sent;
+}
+
+/* Bounded TX ring callbacks for the shared backlog */
+static uint32_t vnic_tx_submit(worker_ctx_t *wctx, const packet_t *pkts, uint32_t n)
+{
+	struct platform_ctx *pctx = wctx->pctx;
+	uint32_t room = pctx->tx_ring_size - pctx->tx_ring_count;
+
+	if (n > room) {
+		n = room;
+	}
+	memcpy(&pctx->tx_ring[pctx->tx_ring_count], pkts, n * sizeof(*pkts));
+	pctx->tx_ring_count += n;
+	return n;
+}
+
+/* The "NIC" finishes everything on the ring each time the worker polls */
+static void vnic_tx_reclaim(worker_ctx_t *wctx)
+{
+	struct platform_ctx *pctx = wctx->pctx;
+
+	if (pctx->tx_stall || pctx->tx_ring_count == 0) {
+		return;
+	}
+	vnic_transmit(pctx, pctx->tx_ring, (int)pctx->tx_ring_count, VNIC_FRAME_TX);
+	pctx->tx_ring_count = 0;
+}
+
+static void vnic_tx_drop(worker_ctx_t *wctx, const packet_t *pkt)
+{
+	struct platform_ctx *pctx = wctx->pctx;
+
+	if (vnic_move_frame(pctx, pkt->addr, VNIC_FRAME_TX, VNIC_FRAME_FREE)) {
+		pctx->stats.tx_dropped++;
+	}
+}
+
+static const tx_ring_ops_t vnic_tx_ring_ops = {
+    .submit = vnic_tx_submit,
+    .reclaim = vnic_tx_reclaim,
+    .drop = vnic_tx_drop,
+};
+
+/*
+ * Initialize the virtual NIC for a worker
+ */
+int vnic_platform_init(reflector_ctx_t *rctx, worker_ctx_t *wctx)
+{
+	const reflector_config_t *cfg = &rctx->config;
+	int ret;
+
+	struct platform_ctx *pctx = calloc(1, sizeof(*pctx));
+	if (pctx == NULL) {
+		reflector_log(LOG_ERROR, "Failed to allocate vnic platform context");
+		return -ENOMEM;
+	}
+
+	ret = cfg->vnic_rx_pcap ? vnic_load_pcap(pctx, cfg->vnic_rx_pcap)
+	                        : vnic_build_synthetic(pctx, cfg);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	uint32_t max_len = 0;
+	for (uint32_t i = 0; i < pctx->num_src; i++) {
+		max_len = pctx->src_len[i] > max_len ? pctx->src_len[i] : max_len;
+	}
+	pctx->stride = (max_len + CACHE_LINE_SIZE - 1) & ~(uint32_t)(CACHE_LINE_SIZE - 1);
+	if (pctx->stride < VNIC_FRAME_STRIDE) {
+		pctx->stride = VNIC_FRAME_STRIDE;
+	}
+
+	void *arena = NULL;
+	if (posix_memalign(&arena, CACHE_LINE_SIZE, (size_t)VNIC_NUM_FRAMES * pctx->stride) != 0) {
+		ret = -ENOMEM;
+		goto fail;
+	}
+	pctx->arena = arena;
+	for (uint32_t i = 0; i < VNIC_NUM_FRAMES; i++) {
+		pctx->free_ring[i] = i;
+	}
+	pctx->free_count = VNIC_NUM_FRAMES;
+	pctx->rx_budget = cfg->vnic_rx_count ? cfg->vnic_rx_count : UINT64_MAX;
+
+	pctx->tx_ring_size = cfg->vnic_tx_ring;
+	if (pctx->tx_ring_size > VNIC_MAX_TX_RING) {
+		pctx->tx_ring_size = VNIC_MAX_TX_RING;
+	}
+	pctx->tx_stall = pctx->tx_ring_size > 0 && cfg->vnic_tx_stall;
+
+	if (cfg->vnic_tx_pcap) {
+		ret = vnic_capture_open(cfg->vnic_tx_pcap);
+		if (ret < 0) {
+			goto fail;
+		}
+		pctx->capture = true;
+	}
+
+	wctx->pctx = pctx;
+
+	if (wctx->worker_id == 0) {
+		reflector_log(LOG_INFO, "vnic: %u source frames (%s), TX %s%s", pctx->num_src,
+		              cfg->vnic_rx_pcap ? cfg->vnic_rx_pcap : "synthetic PROBEOT",
+		              cfg->vnic_tx_pcap ? "captured to " : "counted only",
+		              cfg->vnic_tx_pcap ? cfg->vnic_tx_pcap : "");
+		if (pctx->tx_ring_size > 0) {
+			reflector_log(LOG_INFO, "vnic: TX ring of %u frames%s", pctx->tx_ring_size,
+			              pctx->tx_stall ? ", stalled" : "");
+		}
+	}
+	return 0;
+
+fail:
+	free(pctx->arena);
+	free(pctx->src_data);
+	free(pctx->src_off);
+	free(pctx->src_len);
+	free(pctx);
+	return ret;
+}
+
+/*
+ * Cleanup: account for buffers the core never gave back, add this worker's
+ * counters to the totals
+ */
+void vnic_platform_cleanup(worker_ctx_t *wctx)
+{
+	struct platform_ctx *pctx = wctx->pctx;
+
+	if (pctx == NULL) {
+		return;
+	}
+
+	/* Let a live ring finish the backlog; a stalled one loses everything queued */
+	while (!pctx->tx_stall && pctx->tx_backlog.count > 0) {
+		vnic_tx_reclaim(wctx);
+		tx_backlog_flush(wctx, &pctx->tx_backlog, &vnic_tx_ring_ops);
+	}
+	vnic_tx_reclaim(wctx);
+	for (uint32_t i = 0; i < pctx->tx_ring_count; i++) {
+		vnic_tx_drop(wctx, &pctx->tx_ring[i]);
+	}
+	pctx->tx_ring_count = 0;
+	tx_backlog_drop_all(wctx, &pctx->tx_backlog, &vnic_tx_ring_ops);
+
+	pctx->stats.leaked = VNIC_NUM_FRAMES - pctx->free_count;
+	if (pctx->stats.leaked > 0 || pctx->stats.bad_returns > 0) {
+		reflector_log(LOG_WARN, "vnic worker %d: %" PRIu64 " buffers leaked, %" PRIu64
+		              " bad returns", wctx->worker_id, pctx->stats.leaked,
+		              pctx->stats.bad_returns);
+	}
+
+	pthread_mutex_lock(&vnic_lock);
+	vnic_totals.rx_frames += pctx->stats.rx_frames;
+	vnic_totals.tx_frames += pctx->stats.tx_frames;
+	vnic_totals.tx_bytes += pctx->stats.tx_bytes;
+	vnic_totals.tx_dropped += pctx->stats.tx_dropped;
+	vnic_totals.tx_reordered += pctx->stats.tx_reordered;
+	vnic_totals.released += pctx->stats.released;
+	vnic_totals.bad_returns += pctx->stats.bad_returns;
+	vnic_totals.leaked += pctx->stats.leaked;
+	pthread_mutex_unlock(&vnic_lock);
+
+	if (pctx->capture) {
+		vnic_capture_close();
+	}
+
+	free(pctx->arena);
+	free(pctx->src_data);
+	free(pctx->src_off);
+	free(pctx->src_len);
+	free(pctx);
+	wctx->pctx = NULL;
+}
+
+/*
+ * Receive: copy the next source frames into free buffers
+ */
+int vnic_platform_recv_batch(worker_ctx_t *wctx, packet_t *pkts, int max_pkts)
+{
+	struct platform_ctx *pctx = wctx->pctx;
+
+	/* Completions and queued TX first, as a NIC driver's poll would */
+	if (pctx->tx_ring_size > 0) {
+		vnic_tx_reclaim(wctx);
+		tx_backlog_flush(wctx, &pctx->tx_backlog, &vnic_tx_ring_ops);
+	}
+	vnic_take_rx_credit(pctx);
+
+	uint32_t n = (uint32_t)max_pkts;
+	if (n > pctx->free_count) {
+		n = pctx->free_count;
+	}
+	if (n > pctx->rx_budget) {
+		n = (uint32_t)pctx->rx_budget;
+	}
+
+	for (uint32_t i = 0; i < n; i++) {
+		uint32_t idx = pctx->free_ring[pctx->free_head];
+		pctx->free_head = (pctx->free_head + 1) & VNIC_FRAME_MASK;
+
+		uint32_t s = pctx->next_src;
+		pctx->next_src = s + 1 == pctx->num_src ? 0 : s + 1;
+
+		uint8_t *frame = pctx->arena + (size_t)idx * pctx->stride;
+		memcpy(frame, pctx->src_data + pctx->src_off[s], pctx->src_len[s]);
+		pctx->owner[idx] = VNIC_FRAME_APP;
+		pctx->rx_seq[idx] = pctx->next_seq++;
+
+		pkts[i].data = frame;
+		pkts[i].len = pctx->src_len[s];
+		pkts[i].addr = idx;
+		pkts[i].timestamp = 0;
+	}
+	pctx->free_count -= n;
+	pctx->rx_budget -= n;
+	pctx->stats.rx_frames += n;
+
+	return (int)n;
+}
+
+/*
+ * Send: without a TX ring, count (and optionally capture) the reflected
+ * frames and recycle their buffers; with one, hand them to the ring through
+ * the backlog
+ */
+int vnic_platform_send_batch(worker_ctx_t *wctx, packet_t *pkts, int num_pkts)
+{
+	struct platform_ctx *pctx = wctx->pctx;
+
+	if (pctx->tx_ring_size == 0) {
+		return vnic_transmit(pctx, pkts, num_pkts, VNIC_FRAME_APP);
+	}
+
+	/* Only frames the core really owned go to the ring */
+	int n = 0;
+	for (int i = 0; i < num_pkts; i++) {
+		if (vnic_move_frame(pctx, pkts[i].addr, VNIC_FRAME_APP, VNIC_FRAME_TX)) {
+			pkts[n++] = pkts[i];
+		}
+	}
+
+	/* The ring drained while the core worked on this burst, as a NIC's would */
+	vnic_tx_reclaim(wctx);
+	return tx_backlog_send(wctx, &pctx->tx_backlog, &vnic_tx_ring_ops, pkts, n);
+}
+
+/*
+ * Release: recycle buffers the core dropped
+ */
+void vnic_platform_release_batch(worker_ctx_t *wctx, packet_t *pkts, int num_pkts)
+{
+	struct platform_ctx *pctx = wctx->pctx;
+
+	for (int i = 0; i < num_pkts; i++) {
+		if (vnic_move_frame(pctx, pkts[i].addr, VNIC_FRAME_APP, VNIC_FRAME_FREE)) {
+			pctx->stats.released++;
+		}
+	}
+}
+
+/*
+ * Idle wait: frames are always ready until the budget runs out (or the core
+ * holds every buffer); then sleep out the timeout. Queued TX keeps the
+ * worker polling.
+ */
+int vnic_platform_wait_rx(worker_ctx_t *wctx, int timeout_ms)
+{
+	struct platform_ctx *pctx = wctx->pctx;
+
+	vnic_take_rx_credit(pctx);
+	if ((pctx->rx_budget > 0 && pctx->free_count > 0) || pctx->tx_backlog.count > 0) {
+		return 1;
+	}
+
+	struct timespec ts = {.tv_sec = timeout_ms / 1000, .tv_nsec = (timeout_ms % 1000) * 1000000L};
+	nanosleep(&ts, NULL);
+	return 0;
+}
+
+/* Platform operations structure */
+static const platform_ops_t vnic_platform_ops = {
+    .name = "Virtual NIC (in-memory)",
+    .init = vnic_platform_init,
+    .cleanup = vnic_platform_cleanup,
+    .recv_batch = vnic_platform_recv_batch,
+    .send_batch = vnic_platform_send_batch,
+    .release_batch = vnic_platform_release_batch,
+    .wait_rx = vnic_platform_wait_rx,
+};
+
+const platform_ops_t *get_vnic_platform_ops(void)
+{
+	return &vnic_platform_ops;
+}
@@ -0,0 +1,220 @@
+/*
+ * reflector_stat.c - Live rates from the shared-memory stats segment
+ *
+ * Maps the segment a reflector started with --shm publishes
+ * (REFLECTOR_SHM_PREFIX<interface>, see reflector_shm_t) read-only and prints
+ * per-worker and total rates every interval. Reading costs plain loads: no
+ * syscalls reach the reflector and nothing in it waits for us.
+ *
+ * Run with: reflector-stat <interface> [-i MS] [-n COUNT]
+ */
+
+#include "reflector.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t g_running = 1;
+
+static void signal_handler(int sig)
+{
+	(void)sig;
+	g_running = 0;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s <interface> [options]\n", prog);
+	fprintf(stderr, "  -i MS     Print interval in milliseconds (default: 1000)\n");
+	fprintf(stderr, "  -n COUNT  Exit after COUNT intervals (default: until interrupted)\n");
+	fprintf(stderr, "\nReads %s<interface>, published by: reflector <interface> --shm\n",
+	        REFLECTOR_SHM_PREFIX);
+}
+
+/* Map the segment read-only and check it matches the layout we were built with */
+static const reflector_shm_t *shm_attach(const char *ifname)
+{
+	char name[sizeof(REFLECTOR_SHM_PREFIX) + MAX_IFNAME_LEN];
+	snprintf(name, sizeof(name), REFLECTOR_SHM_PREFIX "%s", ifname);
+
+	int fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0) {
+		fprintf(stderr, "Cannot open %s: %s (is the reflector running with --shm?)\n", name,
+		        strerror(errno));
+		return NULL;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(reflector_shm_t)) {
+		fprintf(stderr, "%s is too small for this reader\n", name);
+		close(fd);
+		return NULL;
+	}
+
+	void *map = mmap(NULL, sizeof(reflector_shm_t), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "Cannot map %s: %s\n", name, strerror(errno));
+		return NULL;
+	}
+
+	const reflector_shm_t *shm = map;
+	const reflector_shm_header_t *hdr = &shm->header;
+	if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != REFLECTOR_SHM_MAGIC) {
+		fprintf(stderr, "%s is not initialized\n", name);
+	} else if (hdr->version != REFLECTOR_SHM_VERSION ||
+	           hdr->header_size != sizeof(reflector_shm_header_t) ||
+	           hdr->record_size != sizeof(reflector_shm_record_t) ||
+	           hdr->stats_size != sizeof(reflector_stats_t) || hdr->max_workers != MAX_WORKERS) {
+		fprintf(stderr, "%s has layout version %u, this reader expects %u (rebuild it)\n", name,
+		        hdr->version, REFLECTOR_SHM_VERSION);
+	} else {
+		return shm;
+	}
+	munmap(map, sizeof(reflector_shm_t));
+	return NULL;
+}
+
+static uint64_t errors_of(const reflector_stats_t *s)
+{
+	return s->err_invalid_mac + s->err_invalid_ethertype + s->err_invalid_protocol +
+	       s->err_invalid_signature + s->err_too_short + s->err_tx_failed + s->err_nomem;
+}
+
+/* Rates of one record between two reads ("-" until a new snapshot lands) */
+static void print_rates(const char *label, const reflector_shm_record_t *prev,
+                        const reflector_shm_record_t *cur)
+{
+	double secs = (double)(cur->timestamp_ns - prev->timestamp_ns) / 1e9;
+	if (secs <= 0) {
+		printf("%-8s %12s %12s %10s %10s\n", label, "-", "-", "-", "-");
+		return;
+	}
+
+	const reflector_stats_t *a = &prev->stats, *b = &cur->stats;
+	printf("%-8s %12.0f %12.0f %10.2f %10.0f\n", label,
+	       (double)(b->packets_received - a->packets_received) / secs,
+	       (double)(b->packets_reflected - a->packets_reflected) / secs,
+	       (double)(b->bytes_reflected - a->bytes_reflected) * 8.0 / (secs * 1e6),
+	       (double)(errors_of(b) - errors_of(a)) / secs);
+}
+
+/* Latency percentiles of the samples taken between two reads */
+static void print_interval_latency(const reflector_shm_record_t *prev,
+                                   const reflector_shm_record_t *cur)
+{
+	static latency_hist_t delta;
+	uint64_t samples = 0;
+
+	for (int i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+		uint64_t now = cur->stats.latency_hist.buckets[i];
+		uint64_t then = prev->stats.latency_hist.buckets[i];
+		delta.buckets[i] = now >= then ? now - then : now; /* Stats were reset */
+		samples += delta.buckets[i];
+	}
+	if (samples == 0) {
+		return;
+	}
+	printf("latency  p50 %.2f us  p99 %.2f us  p99.9 %.2f us  (%" PRIu64 " samples)\n",
+	       (double)latency_hist_percentile(&delta, 50.0) / 1000.0,
+	       (double)latency_hist_percentile(&delta, 99.0) / 1000.0,
+	       (double)latency_hist_percentile(&delta, 99.9) / 1000.0, samples);
+}
+
+int main(int argc, char **argv)
+{
+	const char *ifname = NULL;
+	long interval_ms = 1000;
+	long count = -1;
+
+	for (int i = 1; i < argc; i++) {
+		char *endptr;
+		if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+			interval_ms = strtol(argv[++i], &endptr, 10);
+			if (*endptr != '\0' || interval_ms < 1) {
+				fprintf(stderr, "Invalid interval: %s\n", argv[i]);
+				return 1;
+			}
+		} else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+			count = strtol(argv[++i], &endptr, 10);
+			if (*endptr != '\0' || count < 1) {
+				fprintf(stderr, "Invalid count: %s\n", argv[i]);
+				return 1;
+			}
+		} else if (argv[i][0] != '-' && !ifname) {
+			ifname = argv[i];
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (!ifname) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	const reflector_shm_t *shm = shm_attach(ifname);
+	if (!shm) {
+		return 1;
+	}
+
+	signal(SIGINT, signal_handler);
+	signal(SIGTERM, signal_handler);
+
+	const reflector_shm_header_t *hdr = &shm->header;
+	printf("%s on %s, pid %d, published every %u ms\n", hdr->platform, hdr->ifname, hdr->pid,
+	       hdr->interval_ms);
+
+	static reflector_shm_record_t prev[MAX_WORKERS + 1], cur[MAX_WORKERS + 1];
+	reflector_shm_read_record(&shm->total, &prev[MAX_WORKERS]);
+	for (int i = 0; i < MAX_WORKERS; i++) {
+		reflector_shm_read_record(&shm->workers[i], &prev[i]);
+	}
+
+	while (g_running && count != 0) {
+		usleep((useconds_t)interval_ms * 1000);
+		if (!g_running) {
+			break;
+		}
+
+		int nw = (int)__atomic_load_n(&hdr->num_workers, __ATOMIC_ACQUIRE);
+		if (nw > MAX_WORKERS) {
+			nw = MAX_WORKERS;
+		}
+		reflector_shm_read_record(&shm->total, &cur[MAX_WORKERS]);
+		for (int i = 0; i < nw; i++) {
+			reflector_shm_read_record(&shm->workers[i], &cur[i]);
+		}
+
+		printf("\n%-8s %12s %12s %10s %10s\n", "worker", "rx pps", "tx pps", "tx Mbps",
+		       "errors/s");
+		for (int i = 0; i < nw; i++) {
+			char label[16];
+			snprintf(label, sizeof(label), "%d/q%d", cur[i].worker_id, cur[i].queue_id);
+			print_rates(label, &prev[i], &cur[i]);
+		}
+		print_rates("total", &prev[MAX_WORKERS], &cur[MAX_WORKERS]);
+		print_interval_latency(&prev[MAX_WORKERS], &cur[MAX_WORKERS]);
+		fflush(stdout);
+
+		memcpy(prev, cur, sizeof(prev));
+		if (count > 0) {
+			count--;
+		}
+		if (!__atomic_load_n(&hdr->running, __ATOMIC_ACQUIRE)) {
+			printf("\nReflector stopped\n");
+			break;
+		}
+	}
+
+	munmap((void *)shm, sizeof(reflector_shm_t));
+	return 0;
+}
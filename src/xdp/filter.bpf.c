@@ -11,19 +11,50 @@
  * - Early packet filtering in kernel
  * - Avoiding unnecessary copies to userspace
  * - Leveraging XDP zero-copy RX
+ *
+ * When XDP_CFG_TX_REFLECT is set in config_map, matching packets are
+ * reflected in place and bounced back out of the receiving queue with
+ * XDP_TX, so they never reach userspace at all.
+ *
+ * xdp_filter_ito_rxts is the same filter built as a device-bound program: it
+ * asks the driver for the NIC RX timestamp (XDP metadata kfunc) and stores it
+ * in front of each redirected frame as struct xdp_rx_meta.
  */
 
 #include <linux/bpf.h>
 #include <linux/if_ether.h>
 #include <linux/in.h>
 #include <linux/ip.h>
+#include <linux/ipv6.h>
 #include <linux/udp.h>
 
 #include <bpf/bpf_endian.h>
 #include <bpf/bpf_helpers.h>
 
+#include "xdp_maps.h"
+
 /* ITO packet signatures */
 #define ITO_SIG_LEN 7
+#define ITO_SIG_OFFSET 5 /* ITO signature offset in UDP payload */
+
+/* 802.1Q, or 802.1ad QinQ outer + inner (matches MAX_VLAN_DEPTH in reflector.h) */
+#define MAX_VLAN_DEPTH 2
+
+#ifndef ETH_P_8021AD
+#define ETH_P_8021AD 0x88A8
+#endif
+
+struct vlan_hdr {
+	__be16 tci;
+	__be16 encap_proto;
+};
+
+/* reflect_mode_t values (see reflector.h) */
+#define REFLECT_MODE_MAC 0
+#define REFLECT_MODE_MAC_IP 1
+
+/* XDP RX metadata kfunc (kernel 6.3+, device-bound programs only) */
+extern int bpf_xdp_metadata_rx_timestamp(const struct xdp_md *ctx, __u64 *timestamp) __ksym __weak;
 
 /* Map for XDP socket redirect */
 struct {
@@ -41,27 +72,27 @@ struct {
 	__uint(max_entries, 1);
 } mac_map SEC(".maps");
 
+/* Reflection/filter settings (zeroed entry = legacy redirect-only behaviour) */
+struct {
+	__uint(type, BPF_MAP_TYPE_ARRAY);
+	__uint(key_size, sizeof(__u32));
+	__uint(value_size, sizeof(struct xdp_reflect_config));
+	__uint(max_entries, 1);
+} config_map SEC(".maps");
+
 /*
  * Hash map for O(1) signature lookup
- * Key: 7-byte ITO signature
- * Value: signature type (1=valid, value unused but required)
+ * Key: 7-byte signature
+ * Value: struct xdp_sig_value (signature type + expected payload offset)
  * Max 16 signatures (expandable for future)
  */
 struct {
 	__uint(type, BPF_MAP_TYPE_HASH);
 	__uint(key_size, ITO_SIG_LEN);
-	__uint(value_size, sizeof(__u32));
+	__uint(value_size, sizeof(struct xdp_sig_value));
 	__uint(max_entries, 16);
 } sig_map SEC(".maps");
 
-/* Statistics map */
-struct xdp_stats {
-	__u64 packets_total;
-	__u64 packets_ito;
-	__u64 packets_passed;
-	__u64 packets_dropped;
-};
-
 struct {
 	__uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
 	__uint(key_size, sizeof(__u32));
@@ -69,20 +100,111 @@ struct {
 	__uint(max_entries, 1);
 } stats_map SEC(".maps");
 
+static __always_inline int mac_equal(const __u8 *a, const __u8 *b)
+{
+	return a[0] == b[0] && a[1] == b[1] && a[2] == b[2] && a[3] == b[3] && a[4] == b[4] &&
+	       a[5] == b[5];
+}
+
 /*
- * Main XDP program
+ * Look up a signature at the given payload offset. Keys are only accepted at
+ * the offset they were registered for, so an RFC2544 string at offset 5 or an
+ * ITO string at offset 0 does not match.
+ */
+static __always_inline struct xdp_sig_value *lookup_sig(__u8 *payload, __u32 offset,
+                                                        void *data_end)
+{
+	__u8 *sig = payload + offset;
+	if (sig + ITO_SIG_LEN > (__u8 *)data_end) {
+		return 0;
+	}
+
+	struct xdp_sig_value *val = bpf_map_lookup_elem(&sig_map, sig);
+	if (val && val->payload_offset == offset) {
+		return val;
+	}
+	return 0;
+}
+
+/*
+ * Reflect headers in place (exactly one of iph/ip6h is non-NULL). Swapping
+ * source and destination fields does not change the ones' complement sum of
+ * the IPv4 header or the UDP pseudo-header (IPv4 or IPv6), so the RFC 1624
+ * incremental fixup is zero and checksums remain valid without touching them.
+ * VLAN tags are left in place so the reply goes back on the same VLAN(s).
+ */
+static __always_inline void reflect_headers(struct ethhdr *eth, struct iphdr *iph,
+                                            struct ipv6hdr *ip6h, struct udphdr *udph, __u32 mode)
+{
+	__u8 tmp_mac[ETH_ALEN];
+	__builtin_memcpy(tmp_mac, eth->h_dest, ETH_ALEN);
+	__builtin_memcpy(eth->h_dest, eth->h_source, ETH_ALEN);
+	__builtin_memcpy(eth->h_source, tmp_mac, ETH_ALEN);
+
+	if (mode == REFLECT_MODE_MAC) {
+		return;
+	}
+
+	if (ip6h) {
+		struct in6_addr tmp_ip6;
+		__builtin_memcpy(&tmp_ip6, &ip6h->saddr, sizeof(tmp_ip6));
+		__builtin_memcpy(&ip6h->saddr, &ip6h->daddr, sizeof(tmp_ip6));
+		__builtin_memcpy(&ip6h->daddr, &tmp_ip6, sizeof(tmp_ip6));
+	} else if (iph) {
+		__be32 tmp_ip = iph->saddr;
+		iph->saddr = iph->daddr;
+		iph->daddr = tmp_ip;
+	}
+
+	if (mode == REFLECT_MODE_MAC_IP) {
+		return;
+	}
+
+	__be16 tmp_port = udph->source;
+	udph->source = udph->dest;
+	udph->dest = tmp_port;
+}
+
+/*
+ * Prepend struct xdp_rx_meta with the NIC RX timestamp. Called only right
+ * before the redirect: bpf_xdp_adjust_meta() invalidates packet pointers.
+ */
+static __always_inline void store_rx_meta(struct xdp_md *ctx)
+{
+	if (bpf_xdp_adjust_meta(ctx, -(int)sizeof(struct xdp_rx_meta))) {
+		return;
+	}
+
+	void *data = (void *)(long)ctx->data;
+	struct xdp_rx_meta *meta = (void *)(long)ctx->data_meta;
+	if ((void *)(meta + 1) > data) {
+		return;
+	}
+
+	meta->rx_timestamp = 0;
+	meta->flags = 0;
+	meta->pad = 0;
+	if (bpf_ksym_exists(bpf_xdp_metadata_rx_timestamp) &&
+	    bpf_xdp_metadata_rx_timestamp(ctx, &meta->rx_timestamp) == 0) {
+		meta->flags = XDP_META_RX_TIMESTAMP;
+	}
+}
+
+/*
+ * Main XDP filter
  *
  * Packet flow:
  * 1. Parse Ethernet header
- * 2. Check destination MAC matches interface
- * 3. Parse IPv4 header
- * 4. Check for UDP protocol
- * 5. Check for ITO signature
- * 6. If match -> XDP_REDIRECT to AF_XDP socket
- * 7. Otherwise -> XDP_PASS to normal stack
+ * 2. Check destination MAC / source OUI per config_map
+ * 3. Skip up to two VLAN tags (802.1Q / QinQ) if XDP_CFG_VLAN
+ * 4. Parse IPv4 header, or IPv6 header if XDP_CFG_IPV6
+ * 5. Check for UDP protocol and ITO port
+ * 6. Check for signature (ITO at offset 5, RFC2544/Y.1564 at offset 0)
+ * 7. If match and XDP_CFG_TX_REFLECT -> reflect in place, XDP_TX
+ * 8. If match -> XDP_REDIRECT to AF_XDP socket (with xdp_rx_meta if rx_ts)
+ * 9. Otherwise -> XDP_PASS to normal stack
  */
-SEC("xdp")
-int xdp_filter_ito(struct xdp_md *ctx)
+static __always_inline int filter_ito(struct xdp_md *ctx, const int rx_ts)
 {
 	void *data_end = (void *)(long)ctx->data_end;
 	void *data = (void *)(long)ctx->data;
@@ -100,47 +222,91 @@ int xdp_filter_ito(struct xdp_md *ctx)
 		goto pass;
 	}
 
-	/* Check for IPv4 */
-	if (eth->h_proto != bpf_htons(ETH_P_IP)) {
-		goto pass;
-	}
+	struct xdp_reflect_config *cfg = bpf_map_lookup_elem(&config_map, &key);
+	__u32 flags = cfg ? cfg->flags : XDP_CFG_FILTER_DST_MAC;
 
 	/* Get interface MAC from map and check destination */
-	__u8 *mac_addr = bpf_map_lookup_elem(&mac_map, &key);
-	if (mac_addr) {
-		if (bpf_memcmp(eth->h_dest, mac_addr, 6) != 0) {
+	if (flags & XDP_CFG_FILTER_DST_MAC) {
+		__u8 *mac_addr = bpf_map_lookup_elem(&mac_map, &key);
+		if (mac_addr && !mac_equal(eth->h_dest, mac_addr)) {
 			/* Not for us, pass through */
 			goto pass;
 		}
 	}
 
-	/* Parse IPv4 header */
-	struct iphdr *iph = (void *)(eth + 1);
-	if ((void *)(iph + 1) > data_end) {
-		goto pass;
+	/* Check source OUI */
+	if (cfg && (flags & XDP_CFG_FILTER_OUI)) {
+		if (eth->h_source[0] != cfg->oui[0] || eth->h_source[1] != cfg->oui[1] ||
+		    eth->h_source[2] != cfg->oui[2]) {
+			goto pass;
+		}
 	}
 
-	/* Verify IPv4 and header length */
-	if (iph->version != 4 || iph->ihl < 5) {
-		goto pass;
+	/* Skip VLAN tags */
+	__be16 h_proto = eth->h_proto;
+	void *l3 = eth + 1;
+
+#pragma unroll
+	for (int i = 0; i < MAX_VLAN_DEPTH; i++) {
+		if (h_proto != bpf_htons(ETH_P_8021Q) && h_proto != bpf_htons(ETH_P_8021AD)) {
+			break;
+		}
+		if (!(flags & XDP_CFG_VLAN)) {
+			goto pass;
+		}
+		struct vlan_hdr *vh = l3;
+		if ((void *)(vh + 1) > data_end) {
+			goto pass;
+		}
+		h_proto = vh->encap_proto;
+		l3 = vh + 1;
 	}
 
-	/* Check for UDP protocol */
-	if (iph->protocol != IPPROTO_UDP) {
+	struct iphdr *iph = 0;
+	struct ipv6hdr *ip6h = 0;
+	struct udphdr *udph;
+
+	if (h_proto == bpf_htons(ETH_P_IP)) {
+		/* Parse IPv4 header */
+		iph = l3;
+		if ((void *)(iph + 1) > data_end) {
+			goto pass;
+		}
+
+		/* Verify IPv4 and header length */
+		if (iph->version != 4 || iph->ihl < 5) {
+			goto pass;
+		}
+
+		/* Check for UDP protocol */
+		if (iph->protocol != IPPROTO_UDP) {
+			goto pass;
+		}
+
+		udph = (void *)iph + iph->ihl * 4;
+	} else if (h_proto == bpf_htons(ETH_P_IPV6) && (flags & XDP_CFG_IPV6)) {
+		/* Parse IPv6 header (extension headers not followed) */
+		ip6h = l3;
+		if ((void *)(ip6h + 1) > data_end) {
+			goto pass;
+		}
+
+		if (ip6h->version != 6 || ip6h->nexthdr != IPPROTO_UDP) {
+			goto pass;
+		}
+
+		udph = (void *)(ip6h + 1);
+	} else {
 		goto pass;
 	}
 
 	/* Parse UDP header */
-	__u32 ip_hdr_len = iph->ihl * 4;
-	struct udphdr *udph = (void *)iph + ip_hdr_len;
 	if ((void *)(udph + 1) > data_end) {
 		goto pass;
 	}
 
-	/* Check UDP payload for ITO signature (at offset 5 - 5-byte proprietary header) */
-	__u8 *payload = (void *)(udph + 1);
-	__u8 *signature = payload + 5; /* ITO signature is at offset 5 in UDP payload */
-	if (signature + ITO_SIG_LEN > (__u8 *)data_end) {
+	/* Check ITO destination port */
+	if (cfg && cfg->ito_port != 0 && udph->dest != bpf_htons(cfg->ito_port)) {
 		goto pass;
 	}
 
@@ -149,13 +315,33 @@ int xdp_filter_ito(struct xdp_md *ctx)
 	 * Replaces O(N) sequential memcmp checks
 	 * Scales to many signatures without performance degradation
 	 */
-	__u32 *sig_type = bpf_map_lookup_elem(&sig_map, signature);
-	if (sig_type) {
-		/* ITO packet detected - redirect to AF_XDP socket */
+	__u8 *payload = (void *)(udph + 1);
+	struct xdp_sig_value *sig = lookup_sig(payload, ITO_SIG_OFFSET, data_end);
+	if (!sig) {
+		sig = lookup_sig(payload, 0, data_end);
+	}
+	if (sig) {
+		/* ITO packet detected */
 		if (stats) {
 			__sync_fetch_and_add(&stats->packets_ito, 1);
 		}
 
+		if (cfg && (flags & XDP_CFG_TX_REFLECT)) {
+			reflect_headers(eth, iph, ip6h, udph, cfg->reflect_mode);
+			if (stats) {
+				__sync_fetch_and_add(&stats->packets_tx, 1);
+				__sync_fetch_and_add(&stats->bytes_tx, (__u64)(data_end - data));
+				if (sig->sig_type < XDP_SIG_TYPE_MAX) {
+					__sync_fetch_and_add(&stats->sig_tx[sig->sig_type], 1);
+				}
+			}
+			return XDP_TX;
+		}
+
+		if (rx_ts) {
+			store_rx_meta(ctx);
+		}
+
 		/* Redirect to AF_XDP socket for this queue */
 		return bpf_redirect_map(&xsks_map, ctx->rx_queue_index, 0);
 	}
@@ -168,4 +354,17 @@ pass:
 	return XDP_PASS;
 }
 
+SEC("xdp")
+int xdp_filter_ito(struct xdp_md *ctx)
+{
+	return filter_ito(ctx, 0);
+}
+
+/* Loaded instead of xdp_filter_ito with --latency --hw-timestamp */
+SEC("xdp")
+int xdp_filter_ito_rxts(struct xdp_md *ctx)
+{
+	return filter_ito(ctx, 1);
+}
+
 char _license[] SEC("license") = "GPL";
@@ -11,6 +11,8 @@
 #include "reflector.h"
 
 #include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -304,6 +306,93 @@ void test_config_get(void)
 	PASS();
 }
 
+/*
+ * Writer for test_stats_snapshot: publishes counters that must stay in
+ * lockstep (bytes == 64 * packets, latency total == 100 * count)
+ */
+#define SNAPSHOT_UPDATES 100000
+
+static void *stats_writer(void *arg)
+{
+	worker_ctx_t *wctx = arg;
+
+	for (int i = 0; i < SNAPSHOT_UPDATES; i++) {
+		worker_stats_write_begin(wctx);
+		wctx->stats.packets_received++;
+		/* Hold the update open so an unsynchronised reader would see it torn */
+		for (volatile int spin = 0; spin < 20; spin++) {
+		}
+		wctx->stats.bytes_received += 64;
+		wctx->stats.latency.count++;
+		wctx->stats.latency.total_ns += 100;
+		wctx->stats.latency.max_ns = 100;
+		wctx->stats.latency.min_ns = 100;
+		worker_stats_write_end(wctx);
+	}
+	return NULL;
+}
+
+/*
+ * Test seqlock snapshots: readers never observe a half-published update, and
+ * worker contexts never share cache lines
+ */
+void test_stats_snapshot(void)
+{
+	TEST("stats_snapshot");
+
+	if (sizeof(worker_ctx_t) % CACHE_LINE_SIZE != 0 ||
+	    offsetof(worker_ctx_t, stats_seq) % CACHE_LINE_SIZE != 0) {
+		FAIL("worker_ctx_t stats not cache-line isolated");
+		return;
+	}
+
+	reflector_ctx_t rctx = {0};
+	if (reflector_init(&rctx, LOOPBACK_IF) < 0) {
+		FAIL("Failed to initialize reflector");
+		return;
+	}
+
+	void *mem = NULL;
+	if (posix_memalign(&mem, CACHE_LINE_SIZE, sizeof(worker_ctx_t)) != 0) {
+		FAIL("Failed to allocate worker context");
+		return;
+	}
+	memset(mem, 0, sizeof(worker_ctx_t));
+	rctx.workers = mem;
+	rctx.num_workers = 1;
+	rctx.workers[0].config = &rctx.config;
+
+	pthread_t tid;
+	if (pthread_create(&tid, NULL, stats_writer, &rctx.workers[0]) != 0) {
+		free(mem);
+		FAIL("Failed to start writer thread");
+		return;
+	}
+
+	bool torn = false;
+	reflector_stats_t stats;
+	do {
+		reflector_get_stats(&rctx, &stats);
+		if (stats.bytes_received != stats.packets_received * 64 ||
+		    stats.latency.total_ns != stats.latency.count * 100 ||
+		    stats.latency.count != stats.packets_received) {
+			torn = true;
+		}
+	} while (stats.packets_received < SNAPSHOT_UPDATES && !torn);
+
+	pthread_join(tid, NULL);
+	rctx.workers = NULL;
+	rctx.num_workers = 0;
+	free(mem);
+	reflector_cleanup(&rctx);
+
+	if (torn) {
+		FAIL("Torn statistics snapshot");
+		return;
+	}
+	PASS();
+}
+
 /*
  * Test interface utility functions
  */
@@ -349,6 +438,7 @@ int main(void)
 	test_worker_allocation();
 	test_stats_init();
 	test_stats_reset();
+	test_stats_snapshot();
 	test_config_update();
 	test_config_get();
 	test_interface_utils();
@@ -79,6 +79,15 @@ TEST(nic_speed_empty)
 	ASSERT_EQ(-1, speed);
 }
 
+TEST(nic_numa_node)
+{
+	/* Virtual and missing devices have no node; NULL/empty must not crash */
+	ASSERT_EQ(-1, get_nic_numa_node("lo"));
+	ASSERT_EQ(-1, get_nic_numa_node("nonexistent_iface_xyz"));
+	ASSERT_EQ(-1, get_nic_numa_node(NULL));
+	ASSERT_EQ(-1, get_nic_numa_node(""));
+}
+
 /* ============================================================================
  * DPDK Availability Tests
  * ============================================================================ */
@@ -277,6 +286,7 @@ int main(void)
 	RUN_TEST(nic_speed_nonexistent);
 	RUN_TEST(nic_speed_null);
 	RUN_TEST(nic_speed_empty);
+	RUN_TEST(nic_numa_node);
 
 	TEST_SUITE("DPDK Availability");
 	RUN_TEST(dpdk_availability);
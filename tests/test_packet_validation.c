@@ -718,6 +718,311 @@ TEST(reflect_packet_swaps_headers)
 	ASSERT(packet[36] == 0x0f && packet[37] == 0x02); /* dst port now 3842 */
 }
 
+/*
+ * Build a UDP test frame with optional VLAN tags and IPv6.
+ * Returns the frame length.
+ */
+static uint32_t build_udp_frame(uint8_t *buf, const uint8_t mac[6], int vlan_tags, bool ipv6,
+                                const char *sig, uint32_t sig_offset)
+{
+	static const uint8_t src_mac[6] = {0x00, 0xc0, 0x17, 0x54, 0x05, 0x98};
+	uint32_t off = 0;
+
+	memset(buf, 0, 128);
+	memcpy(&buf[0], mac, 6);
+	memcpy(&buf[6], src_mac, 6);
+	off = 12;
+
+	for (int i = 0; i < vlan_tags; i++) {
+		uint16_t tpid = (i == 0 && vlan_tags > 1) ? ETH_P_8021AD : ETH_P_8021Q;
+		buf[off] = tpid >> 8;
+		buf[off + 1] = tpid & 0xff;
+		buf[off + 2] = 0x00;
+		buf[off + 3] = (uint8_t)(10 + i); /* VID */
+		off += VLAN_HDR_LEN;
+	}
+
+	uint16_t ethertype = ipv6 ? ETH_P_IPV6 : ETH_P_IP;
+	buf[off] = ethertype >> 8;
+	buf[off + 1] = ethertype & 0xff;
+	off += 2;
+
+	uint32_t udp_off;
+	if (ipv6) {
+		buf[off] = 0x60;
+		buf[off + IPV6_NEXT_HDR_OFFSET] = 17;
+		buf[off + 7] = 64;
+		buf[off + IPV6_SRC_OFFSET + 15] = 0x0a; /* src ::a */
+		buf[off + IPV6_DST_OFFSET + 15] = 0x01; /* dst ::1 */
+		udp_off = off + IPV6_HDR_LEN;
+	} else {
+		buf[off] = 0x45;
+		buf[off + 8] = 64;
+		buf[off + IP_PROTO_OFFSET] = 17;
+		buf[off + IP_SRC_OFFSET + 3] = 0x0a;
+		buf[off + IP_DST_OFFSET + 3] = 0x01;
+		udp_off = off + IP_HDR_MIN_LEN;
+	}
+
+	buf[udp_off + 0] = 0x0f; /* src port 3842 */
+	buf[udp_off + 1] = 0x02;
+	buf[udp_off + 2] = 0x0f; /* dst port 3843 */
+	buf[udp_off + 3] = 0x03;
+	buf[udp_off + 5] = 28; /* UDP length: 8 + 20 payload */
+
+	memcpy(&buf[udp_off + UDP_HDR_LEN + sig_offset], sig, 7);
+	return udp_off + UDP_HDR_LEN + 20;
+}
+
+/* Test single-pass classifier on IPv4 with one 802.1Q tag */
+TEST(classify_vlan_ipv4)
+{
+	uint8_t mac[6] = {0x00, 0x01, 0x55, 0x17, 0x1e, 0x1b};
+	uint8_t packet[128];
+	uint32_t len = build_udp_frame(packet, mac, 1, false, ITO_SIG_DATAOT, ITO_SIG_OFFSET);
+
+	reflector_config_t config = make_test_config(mac);
+	config.enable_vlan = true;
+	pkt_hdrs_t hdrs;
+
+	ASSERT(classify_packet(packet, len, &config, &hdrs) == SIG_TYPE_DATAOT);
+	ASSERT(hdrs.vlan_depth == 1);
+	ASSERT(!hdrs.is_ipv6);
+	ASSERT(hdrs.l3_offset == ETH_HDR_LEN + VLAN_HDR_LEN);
+	ASSERT(hdrs.l4_offset == hdrs.l3_offset + IP_HDR_MIN_LEN);
+
+	/* Legacy validator stays IPv4/untagged only */
+	ASSERT(is_ito_packet(packet, len, &config) == false);
+
+	/* Tagged frames rejected when VLAN handling is disabled */
+	config.enable_vlan = false;
+	ASSERT(classify_packet(packet, len, &config, &hdrs) == SIG_TYPE_UNKNOWN);
+}
+
+/* Test single-pass classifier on QinQ IPv6 with a custom signature */
+TEST(classify_qinq_ipv6)
+{
+	uint8_t mac[6] = {0x00, 0x01, 0x55, 0x17, 0x1e, 0x1b};
+	uint8_t packet[128];
+	uint32_t len = build_udp_frame(packet, mac, 2, true, CUSTOM_SIG_RFC2544, 0);
+
+	reflector_config_t config = make_test_config(mac);
+	config.enable_vlan = true;
+	config.enable_ipv6 = true;
+	pkt_hdrs_t hdrs;
+
+	ASSERT(classify_packet(packet, len, &config, &hdrs) == SIG_TYPE_RFC2544);
+	ASSERT(hdrs.vlan_depth == 2);
+	ASSERT(hdrs.is_ipv6);
+	ASSERT(hdrs.l4_offset == ETH_HDR_LEN + 2 * VLAN_HDR_LEN + IPV6_HDR_LEN);
+
+	/* Signature filter is honoured */
+	config.sig_filter = SIG_FILTER_ITO;
+	ASSERT(classify_packet(packet, len, &config, &hdrs) == SIG_TYPE_UNKNOWN);
+
+	/* IPv6 rejected when disabled */
+	config.sig_filter = SIG_FILTER_ALL;
+	config.enable_ipv6 = false;
+	ASSERT(classify_packet(packet, len, &config, &hdrs) == SIG_TYPE_UNKNOWN);
+}
+
+/* Test reflection from parsed offsets leaves VLAN tags and swaps IPv6/ports */
+TEST(reflect_hdrs_vlan_ipv6)
+{
+	uint8_t mac[6] = {0x00, 0x01, 0x55, 0x17, 0x1e, 0x1b};
+	uint8_t packet[128];
+	uint32_t len = build_udp_frame(packet, mac, 1, true, ITO_SIG_PROBEOT, ITO_SIG_OFFSET);
+
+	reflector_config_t config = make_test_config(mac);
+	config.enable_vlan = true;
+	config.enable_ipv6 = true;
+	pkt_hdrs_t hdrs;
+	ASSERT(classify_packet(packet, len, &config, &hdrs) == SIG_TYPE_PROBEOT);
+
+	reflect_packet_hdrs(packet, len, &hdrs, REFLECT_MODE_ALL, true);
+
+	uint8_t expected_dst_mac[6] = {0x00, 0xc0, 0x17, 0x54, 0x05, 0x98};
+	ASSERT(memcmp(&packet[0], expected_dst_mac, 6) == 0);
+	ASSERT(memcmp(&packet[6], mac, 6) == 0);
+	ASSERT(packet[12] == 0x81 && packet[13] == 0x00 && packet[15] == 10); /* tag intact */
+
+	uint8_t *ip6 = packet + hdrs.l3_offset;
+	ASSERT(ip6[IPV6_SRC_OFFSET + 15] == 0x01);
+	ASSERT(ip6[IPV6_DST_OFFSET + 15] == 0x0a);
+
+	uint8_t *udp = packet + hdrs.l4_offset;
+	ASSERT(udp[0] == 0x0f && udp[1] == 0x03);
+	ASSERT(udp[2] == 0x0f && udp[3] == 0x02);
+	ASSERT(udp[6] != 0 || udp[7] != 0); /* IPv6 UDP checksum filled in */
+}
+
+/* Test batch classifier agrees with the scalar classifier on a mixed burst */
+TEST(classify_batch_matches_scalar)
+{
+	uint8_t mac[6] = {0x00, 0x01, 0x55, 0x17, 0x1e, 0x1b};
+	uint8_t frames[8][128];
+	packet_t pkts[8];
+
+	pkts[0].len = build_udp_frame(frames[0], mac, 0, false, ITO_SIG_PROBEOT, ITO_SIG_OFFSET);
+	pkts[1].len = build_udp_frame(frames[1], mac, 0, false, ITO_SIG_LATENCY, ITO_SIG_OFFSET);
+	pkts[2].len = build_udp_frame(frames[2], mac, 0, false, CUSTOM_SIG_Y1564, 0);
+	pkts[3].len = build_udp_frame(frames[3], mac, 0, false, "NOTITO!", ITO_SIG_OFFSET);
+	pkts[4].len = build_udp_frame(frames[4], mac, 1, false, ITO_SIG_DATAOT, ITO_SIG_OFFSET);
+	pkts[5].len = build_udp_frame(frames[5], mac, 0, true, ITO_SIG_PROBEOT, ITO_SIG_OFFSET);
+	pkts[6].len = build_udp_frame(frames[6], mac, 0, false, ITO_SIG_DATAOT, ITO_SIG_OFFSET);
+	frames[6][0] ^= 0x01; /* wrong dst MAC */
+	pkts[7].len = build_udp_frame(frames[7], mac, 0, false, ITO_SIG_DATAOT, ITO_SIG_OFFSET);
+	frames[7][ETH_HDR_LEN + IP_PROTO_OFFSET] = 6; /* TCP */
+
+	for (int i = 0; i < 8; i++) {
+		pkts[i].data = frames[i];
+	}
+
+	reflector_config_t config = make_test_config(mac);
+	config.enable_vlan = true;
+	config.enable_ipv6 = true;
+
+	uint64_t mask[CLASSIFY_MASK_WORDS(8)];
+	sig_type_t sigs[8];
+	pkt_hdrs_t hdrs[8];
+	int accepted = classify_batch(pkts, 8, &config, mask, sigs, hdrs);
+	ASSERT(accepted == 5);
+	ASSERT(mask[0] == 0x37); /* packets 0,1,2,4,5 */
+
+	for (int i = 0; i < 8; i++) {
+		pkt_hdrs_t ref;
+		sig_type_t expected = classify_packet(pkts[i].data, pkts[i].len, &config, &ref);
+		ASSERT(sigs[i] == expected);
+		if (expected != SIG_TYPE_UNKNOWN) {
+			ASSERT(hdrs[i].l4_offset == ref.l4_offset);
+			ASSERT(hdrs[i].is_ipv6 == ref.is_ipv6);
+		}
+	}
+}
+
+/* Test fused kernels produce the same frame as the three-call sequence */
+TEST(classify_reflect_matches_three_call)
+{
+	uint8_t mac[6] = {0x00, 0x01, 0x55, 0x17, 0x1e, 0x1b};
+	reflector_config_t config = make_test_config(mac);
+	const reflect_mode_t modes[] = {REFLECT_MODE_MAC, REFLECT_MODE_MAC_IP, REFLECT_MODE_ALL};
+
+	for (int m = 0; m < 3; m++) {
+		for (int csum = 0; csum < 2; csum++) {
+			uint8_t fused[128], legacy[128];
+			uint32_t len = build_udp_frame(fused, mac, 0, false, ITO_SIG_LATENCY, ITO_SIG_OFFSET);
+			memcpy(legacy, fused, sizeof(legacy));
+
+			ASSERT(is_ito_packet(legacy, len, &config));
+			sig_type_t expected = get_ito_signature_type(legacy, len);
+			reflect_packet_with_mode(legacy, len, modes[m], csum);
+
+			classify_reflect_fn_t kernel = classify_reflect_select(modes[m], csum);
+			ASSERT(kernel(fused, len, &config) == expected);
+			ASSERT(memcmp(fused, legacy, len) == 0);
+		}
+	}
+
+	/* Rejected packets are left untouched */
+	uint8_t packet[128], orig[128];
+	uint32_t len = build_udp_frame(packet, mac, 0, false, "NOTITO!", ITO_SIG_OFFSET);
+	memcpy(orig, packet, sizeof(orig));
+	ASSERT(classify_and_reflect(packet, len, &config) == SIG_TYPE_UNKNOWN);
+	ASSERT(memcmp(packet, orig, len) == 0);
+
+	/* Tagged IPv6 goes through the same single parse */
+	len = build_udp_frame(packet, mac, 2, true, CUSTOM_SIG_Y1564, 0);
+	memcpy(orig, packet, sizeof(orig));
+	config.enable_vlan = true;
+	config.enable_ipv6 = true;
+	config.software_checksum = true;
+	pkt_hdrs_t hdrs;
+	ASSERT(classify_packet(orig, len, &config, &hdrs) == SIG_TYPE_Y1564);
+	reflect_packet_hdrs(orig, len, &hdrs, REFLECT_MODE_ALL, true);
+	ASSERT(classify_and_reflect(packet, len, &config) == SIG_TYPE_Y1564);
+	ASSERT(memcmp(packet, orig, len) == 0);
+}
+
+/* Reference: RFC 1071 sum of big-endian words, folded */
+static uint32_t reference_sum(const uint8_t *p, uint32_t len)
+{
+	uint32_t sum = 0;
+	for (uint32_t i = 0; i + 1 < len; i += 2) {
+		sum += (uint32_t)(p[i] << 8 | p[i + 1]);
+	}
+	if (len & 1) {
+		sum += (uint32_t)p[len - 1] << 8;
+	}
+	while (sum >> 16) {
+		sum = (sum & 0xFFFF) + (sum >> 16);
+	}
+	return sum;
+}
+
+/* Test vectorised checksum kernel against the reference at odd lengths/alignments */
+TEST(checksum_partial_matches_reference)
+{
+	static uint8_t buf[9100];
+	uint32_t seed = 1;
+	for (size_t i = 0; i < sizeof(buf); i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = (uint8_t)(seed >> 16);
+	}
+
+	const uint32_t lens[] = {0, 1, 2, 7, 15, 16, 17, 31, 33, 63, 64, 65, 129, 1500, 9001};
+	for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+		for (uint32_t align = 0; align < 4; align++) {
+			uint32_t expected = reference_sum(buf + align, lens[l]);
+			uint32_t got = checksum_partial(buf + align, lens[l], 0);
+			/* 0x0000 and 0xFFFF are both ones' complement zero */
+			ASSERT(got == expected || (got % 0xFFFF == 0 && expected % 0xFFFF == 0));
+		}
+	}
+
+	/* All-0xFF input exercises the end-around carry */
+	memset(buf, 0xFF, sizeof(buf));
+	ASSERT(checksum_partial(buf, 9000, 0) == 0xFFFF);
+}
+
+/* Test swaps preserve valid checksums and RFC 1624 adjust matches a recompute */
+TEST(checksum_incremental_update)
+{
+	uint8_t mac[6] = {0x00, 0x01, 0x55, 0x17, 0x1e, 0x1b};
+	uint8_t packet[128];
+	uint32_t len = build_udp_frame(packet, mac, 0, false, ITO_SIG_PROBEOT, ITO_SIG_OFFSET);
+	packet[ETH_HDR_LEN + 3] = (uint8_t)(len - ETH_HDR_LEN); /* IP total length */
+
+	reflector_config_t config = make_test_config(mac);
+	pkt_hdrs_t hdrs;
+	ASSERT(classify_packet(packet, len, &config, &hdrs) == SIG_TYPE_PROBEOT);
+	packet_recompute_checksums(packet, len, &hdrs);
+
+	uint8_t *iph = packet + hdrs.l3_offset;
+	uint8_t *udph = packet + hdrs.l4_offset;
+	uint16_t ip_check, udp_check;
+	memcpy(&ip_check, iph + 10, 2);
+	memcpy(&udp_check, udph + 6, 2);
+	ASSERT(ip_check != 0 && udp_check != 0);
+	ASSERT(checksum_partial(iph, IP_HDR_MIN_LEN, 0) == 0xFFFF);
+
+	/* Reflection with software checksum keeps the (still valid) checksums */
+	reflect_packet_hdrs(packet, len, &hdrs, REFLECT_MODE_ALL, true);
+	ASSERT(memcmp(iph + 10, &ip_check, 2) == 0);
+	ASSERT(memcmp(udph + 6, &udp_check, 2) == 0);
+	ASSERT(checksum_partial(iph, IP_HDR_MIN_LEN, 0) == 0xFFFF);
+
+	/* Rewrite an 8-byte payload timestamp and adjust incrementally */
+	uint8_t *ts = udph + UDP_HDR_LEN + 12;
+	uint8_t old_ts[8], new_ts[8] = {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0};
+	memcpy(old_ts, ts, 8);
+	memcpy(ts, new_ts, 8);
+	uint16_t adjusted = checksum_adjust(udp_check, old_ts, new_ts, 8);
+
+	packet_recompute_checksums(packet, len, &hdrs);
+	memcpy(&udp_check, udph + 6, 2);
+	ASSERT(adjusted == udp_check);
+}
+
 int main(void)
 {
 	printf("Running packet validation tests...\n\n");
@@ -749,6 +1054,17 @@ int main(void)
 	/* Reflection tests */
 	RUN_TEST(reflect_packet_swaps_headers);
 
+	/* Single-pass classifier (VLAN/QinQ, IPv6) */
+	RUN_TEST(classify_vlan_ipv4);
+	RUN_TEST(classify_qinq_ipv6);
+	RUN_TEST(reflect_hdrs_vlan_ipv6);
+	RUN_TEST(classify_batch_matches_scalar);
+	RUN_TEST(classify_reflect_matches_three_call);
+
+	/* Checksum kernels */
+	RUN_TEST(checksum_partial_matches_reference);
+	RUN_TEST(checksum_incremental_update);
+
 	printf("\n=================================\n");
 	printf("Tests passed: %d\n", tests_passed);
 	printf("Tests failed: %d\n", tests_failed);
@@ -11,10 +11,12 @@
 #include "reflector.h"
 
 #include <assert.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 int tests_passed = 0;
@@ -250,8 +252,28 @@ void test_worker_limit(void)
 		reflector_cleanup(&rctx);
 		return;
 	}
+	reflector_cleanup(&rctx);
 
+	/* Set directly in the config (as main.c and the Go dataplane do) */
+	memset(&rctx, 0, sizeof(rctx));
+	if (reflector_init(&rctx, VNIC_IFNAME) < 0) {
+		FAIL("Failed to initialize the virtual NIC");
+		return;
+	}
+	rctx.config.num_workers = MAX_WORKERS + 4;
+	rctx.config.vnic_rx_count = 1;
+	if (reflector_start(&rctx) < 0) {
+		FAIL("Failed to start with too many workers");
+		reflector_cleanup(&rctx);
+		return;
+	}
+	int started = rctx.num_workers;
 	reflector_cleanup(&rctx);
+	if (started != MAX_WORKERS) {
+		FAIL("reflector_start did not cap num_workers");
+		return;
+	}
+
 	PASS();
 }
 
@@ -467,7 +489,358 @@ void test_batch_size(void)
 	int ret = reflector_set_config(&rctx, &config);
 	(void)ret; /* May fail or use default, both are acceptable */
 
+	/* Oversized bursts are capped to what the worker arrays hold */
+	config.batch_size = MAX_BATCH_SIZE * 4;
+	reflector_set_config(&rctx, &config);
+	reflector_get_config(&rctx, &config);
+	if (config.batch_size != MAX_BATCH_SIZE) {
+		FAIL("Batch size not capped to MAX_BATCH_SIZE");
+		reflector_cleanup(&rctx);
+		return;
+	}
+
+	reflector_cleanup(&rctx);
+	PASS();
+}
+
+/*
+ * Run the worker loop on the virtual NIC until it has taken every injected
+ * frame; the workers' vnic counters land in the totals at cleanup
+ */
+static int run_vnic(int workers, uint64_t frames, sig_filter_t sig_filter,
+                    reflector_stats_t *stats, vnic_stats_t *totals)
+{
+	reflector_ctx_t rctx = {0};
+
+	if (reflector_init(&rctx, VNIC_IFNAME) < 0) {
+		return -1;
+	}
+	rctx.config.num_workers = workers;
+	rctx.config.vnic_rx_count = frames;
+	rctx.config.sig_filter = sig_filter;
+	vnic_reset_totals();
+
+	if (reflector_start(&rctx) < 0) {
+		reflector_cleanup(&rctx);
+		return -1;
+	}
+	for (int i = 0; i < 500; i++) {
+		usleep(10000);
+		reflector_get_stats(&rctx, stats);
+		if (stats->packets_received >= frames * (uint64_t)workers) {
+			break;
+		}
+	}
+	reflector_cleanup(&rctx);
+	vnic_get_totals(totals);
+	return 0;
+}
+
+/*
+ * Test the complete worker loop on the in-memory virtual NIC: every probe
+ * is reflected (or released when filtered out) and every buffer comes back
+ * exactly once
+ */
+void test_vnic_end_to_end(void)
+{
+	TEST("vnic_end_to_end");
+
+	const uint64_t frames = 10000;
+	reflector_stats_t stats;
+	vnic_stats_t totals;
+
+	if (run_vnic(2, frames, SIG_FILTER_ALL, &stats, &totals) < 0) {
+		FAIL("Failed to run the virtual NIC");
+		return;
+	}
+	if (stats.packets_reflected != 2 * frames || totals.tx_frames != 2 * frames) {
+		FAIL("Not every injected probe was reflected");
+		return;
+	}
+	if (totals.leaked != 0 || totals.bad_returns != 0) {
+		FAIL("Buffers leaked or returned twice on the send path");
+		return;
+	}
+
+	/* PROBEOT filtered out: every frame goes through release_batch instead */
+	if (run_vnic(1, frames, SIG_FILTER_RFC2544, &stats, &totals) < 0) {
+		FAIL("Failed to run the virtual NIC");
+		return;
+	}
+	if (stats.packets_reflected != 0 || totals.released != frames) {
+		FAIL("Filtered frames were not released");
+		return;
+	}
+	if (totals.leaked != 0 || totals.bad_returns != 0) {
+		FAIL("Buffers leaked or returned twice on the release path");
+		return;
+	}
+
+	PASS();
+}
+
+/*
+ * Run one vnic worker with a bounded TX ring until every injected frame was
+ * either sent (reflected) or dropped (tx_failed). Stats are read while the
+ * worker still runs; the vnic totals after cleanup.
+ */
+static int run_vnic_tx_ring(uint32_t ring, bool stall, uint64_t frames, reflector_stats_t *stats,
+                            vnic_stats_t *totals)
+{
+	reflector_ctx_t rctx = {0};
+
+	if (reflector_init(&rctx, VNIC_IFNAME) < 0) {
+		return -1;
+	}
+	rctx.config.num_workers = 1;
+	rctx.config.vnic_rx_count = frames;
+	rctx.config.vnic_tx_ring = ring;
+	rctx.config.vnic_tx_stall = stall;
+	vnic_reset_totals();
+
+	if (reflector_start(&rctx) < 0) {
+		reflector_cleanup(&rctx);
+		return -1;
+	}
+	for (int i = 0; i < 500; i++) {
+		usleep(10000);
+		reflector_get_stats(&rctx, stats);
+		if (stats->packets_reflected + stats->err_tx_failed >= frames) {
+			break;
+		}
+	}
+	reflector_cleanup(&rctx);
+	vnic_get_totals(totals);
+	return 0;
+}
+
+/*
+ * Test the TX backlog through a bounded vnic TX ring: a slow ring loses
+ * nothing and keeps RX order, and a stalled one drops exactly what neither
+ * the ring nor the backlog holds, freeing every dropped frame
+ */
+void test_vnic_tx_backlog(void)
+{
+	TEST("vnic_tx_backlog");
+
+	const uint64_t frames = 20000;
+	const uint32_t ring = BATCH_SIZE / 4;
+	reflector_stats_t stats;
+	vnic_stats_t totals;
+
+	/* The ring takes a quarter burst per poll: the backlog grows, waits, drains in order */
+	if (run_vnic_tx_ring(ring, false, frames, &stats, &totals) < 0) {
+		FAIL("Failed to run the virtual NIC");
+		return;
+	}
+	if (stats.packets_reflected != frames || stats.err_tx_failed != 0 ||
+	    stats.err_tx_backpressure != 0) {
+		FAIL("Frames dropped although the TX ring kept draining");
+		return;
+	}
+	if (totals.tx_frames != frames || totals.tx_dropped != 0) {
+		FAIL("Queued frames were not all transmitted");
+		return;
+	}
+	if (totals.tx_reordered != 0) {
+		FAIL("Backlog drained out of RX order");
+		return;
+	}
+	if (totals.leaked != 0 || totals.bad_returns != 0) {
+		FAIL("Buffers leaked or returned twice through the backlog");
+		return;
+	}
+
+	/* Stalled ring: the ring and the backlog fill, every later frame waits out and drops */
+	if (run_vnic_tx_ring(ring, true, frames, &stats, &totals) < 0) {
+		FAIL("Failed to run the virtual NIC");
+		return;
+	}
+	if (stats.packets_reflected != ring + TX_BACKLOG_SIZE ||
+	    stats.err_tx_backpressure != frames - ring - TX_BACKLOG_SIZE ||
+	    stats.err_tx_failed != stats.err_tx_backpressure) {
+		FAIL("Backpressure drops do not match the ring and backlog size");
+		return;
+	}
+	if (totals.tx_frames != 0 || totals.tx_dropped != frames) {
+		FAIL("Frames transmitted by a stalled ring, or dropped frames not freed");
+		return;
+	}
+	if (totals.leaked != 0 || totals.bad_returns != 0) {
+		FAIL("Buffers leaked or returned twice on overflow");
+		return;
+	}
+
+	PASS();
+}
+
+/* Poll a running context until pred(stats) holds (5 s at most) */
+static bool wait_stats(reflector_ctx_t *rctx, reflector_stats_t *stats,
+                       bool (*pred)(const reflector_stats_t *, uint64_t), uint64_t arg)
+{
+	for (int i = 0; i < 500; i++) {
+		reflector_get_stats(rctx, stats);
+		if (pred(stats, arg)) {
+			return true;
+		}
+		usleep(10000);
+	}
+	return false;
+}
+
+static bool reflected_at_least(const reflector_stats_t *stats, uint64_t n)
+{
+	return stats->packets_reflected >= n;
+}
+
+static bool timeouts_at_least(const reflector_stats_t *stats, uint64_t n)
+{
+	return stats->poll_timeout >= n;
+}
+
+/*
+ * Test adaptive idle on the virtual NIC: once traffic stops the worker
+ * stops spinning and sleeps in wait_rx (its timeouts are counted), and
+ * traffic that starts again is picked up with nothing lost
+ */
+void test_vnic_idle_resume(void)
+{
+	TEST("vnic_idle_resume");
+
+	const uint64_t frames = 5000;
+	reflector_ctx_t rctx = {0};
+	reflector_stats_t stats;
+	vnic_stats_t totals;
+
+	if (reflector_init(&rctx, VNIC_IFNAME) < 0) {
+		FAIL("Failed to initialize the virtual NIC");
+		return;
+	}
+	rctx.config.num_workers = 1;
+	rctx.config.vnic_rx_count = frames;
+	rctx.config.poll_timeout_ms = 5;
+	vnic_reset_totals();
+
+	if (reflector_start(&rctx) < 0) {
+		reflector_cleanup(&rctx);
+		FAIL("Failed to start the virtual NIC");
+		return;
+	}
+
+	/* First burst of traffic, then silence: the worker must fall through to wait_rx */
+	bool first = wait_stats(&rctx, &stats, reflected_at_least, frames);
+	uint64_t base_timeouts = stats.poll_timeout;
+	bool slept = first && wait_stats(&rctx, &stats, timeouts_at_least, base_timeouts + 3);
+	uint64_t idle_received = stats.packets_received;
+
+	/* Traffic again: the sleeping worker wakes up and takes all of it */
+	vnic_add_rx_frames(&rctx.workers[0], frames);
+	bool resumed = slept && wait_stats(&rctx, &stats, reflected_at_least, 2 * frames);
+
 	reflector_cleanup(&rctx);
+	vnic_get_totals(&totals);
+
+	if (!first) {
+		FAIL("First burst not reflected");
+		return;
+	}
+	if (!slept || idle_received != frames) {
+		FAIL("Idle worker never slept in wait_rx");
+		return;
+	}
+	if (!resumed || stats.packets_received != 2 * frames || stats.packets_reflected != 2 * frames ||
+	    stats.err_tx_failed != 0) {
+		FAIL("Traffic lost after the worker woke up");
+		return;
+	}
+	if (totals.rx_frames != 2 * frames || totals.tx_frames != 2 * frames || totals.leaked != 0 ||
+	    totals.bad_returns != 0) {
+		FAIL("Buffers lost across the idle period");
+		return;
+	}
+
+	PASS();
+}
+
+/*
+ * Test the shared-memory stats segment: an outside reader sees the same
+ * counters as the published snapshot, and the segment is gone after stop
+ */
+void test_vnic_stats_shm(void)
+{
+	TEST("vnic_stats_shm");
+
+	const uint64_t frames = 10000;
+	reflector_ctx_t rctx = {0};
+	if (reflector_init(&rctx, VNIC_IFNAME) < 0) {
+		FAIL("Failed to initialize the virtual NIC");
+		return;
+	}
+	rctx.config.num_workers = 2;
+	rctx.config.vnic_rx_count = frames;
+	rctx.config.stats_shm = true;
+	rctx.config.snapshot_interval_ms = 10;
+
+	if (reflector_start(&rctx) < 0 || !rctx.shm) {
+		reflector_cleanup(&rctx);
+		FAIL("Failed to start with a stats segment");
+		return;
+	}
+
+	int fd = shm_open(rctx.shm_name, O_RDONLY, 0);
+	const reflector_shm_t *shm =
+	    fd < 0 ? MAP_FAILED : mmap(NULL, sizeof(*shm), PROT_READ, MAP_SHARED, fd, 0);
+	if (fd >= 0) {
+		close(fd);
+	}
+	if (shm == MAP_FAILED) {
+		reflector_cleanup(&rctx);
+		FAIL("Cannot map the stats segment");
+		return;
+	}
+
+	reflector_shm_record_t total;
+	for (int i = 0; i < 500; i++) {
+		usleep(10000);
+		reflector_shm_read_record(&shm->total, &total);
+		if (total.stats.packets_reflected >= 2 * frames) {
+			break;
+		}
+	}
+	reflector_stop(&rctx);
+
+	/* The final publish at stop is visible through the old mapping */
+	reflector_shm_record_t workers[2];
+	reflector_shm_read_record(&shm->total, &total);
+	reflector_shm_read_record(&shm->workers[0], &workers[0]);
+	reflector_shm_read_record(&shm->workers[1], &workers[1]);
+	bool layout_ok = shm->header.magic == REFLECTOR_SHM_MAGIC &&
+	                 shm->header.record_size == sizeof(reflector_shm_record_t) &&
+	                 shm->header.num_workers == 2 && shm->header.running == 0;
+	bool counts_ok = total.stats.packets_reflected == 2 * frames &&
+	                 workers[0].stats.packets_reflected + workers[1].stats.packets_reflected ==
+	                     total.stats.packets_reflected &&
+	                 total.worker_id == -1 && workers[1].worker_id == 1;
+	munmap((void *)shm, sizeof(*shm));
+
+	fd = shm_open(rctx.shm_name, O_RDONLY, 0);
+	if (fd >= 0) {
+		close(fd);
+	}
+	reflector_cleanup(&rctx);
+
+	if (!layout_ok) {
+		FAIL("Bad segment header");
+		return;
+	}
+	if (!counts_ok) {
+		FAIL("Segment counters do not match the injected frames");
+		return;
+	}
+	if (fd >= 0) {
+		FAIL("Segment still linked after stop");
+		return;
+	}
 	PASS();
 }
 
@@ -500,6 +873,12 @@ int main(void)
 	/* Cleanup tests */
 	test_graceful_shutdown();
 
+	/* End-to-end on the virtual NIC */
+	test_vnic_end_to_end();
+	test_vnic_tx_backlog();
+	test_vnic_idle_resume();
+	test_vnic_stats_shm();
+
 	/* Summary */
 	printf("\n=================================\n");
 	printf("Tests passed: %d\n", tests_passed);
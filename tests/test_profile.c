@@ -0,0 +1,246 @@
+/*
+ * test_profile.c - Hot-path profiler tests on the virtual NIC
+ *
+ * Built with ENABLE_HOT_PATH_PROFILE (see make test-profile).
+ *
+ * Tests:
+ * - Every phase is charged on a vnic run and the totals match the traffic
+ * - Without perf_event_open() (denied by seccomp) cycles fall back to the TSC
+ */
+
+#include "reflector.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__i386__))
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <x86intrin.h>
+#define HAVE_TSC_FALLBACK 1
+#else
+#define HAVE_TSC_FALLBACK 0
+#endif
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name)                                                                                 \
+	do {                                                                                           \
+		printf("Running %s... ", name);                                                            \
+		fflush(stdout);                                                                            \
+	} while (0)
+
+#define PASS()                                                                                     \
+	do {                                                                                           \
+		printf("PASS\n");                                                                          \
+		tests_passed++;                                                                            \
+	} while (0)
+
+#define FAIL(msg)                                                                                  \
+	do {                                                                                           \
+		printf("FAIL: %s\n", msg);                                                                 \
+		tests_failed++;                                                                            \
+	} while (0)
+
+#define PROFILE_WORKERS 2
+#define PROFILE_FRAMES 20000 /* Per worker */
+
+/*
+ * Profile a vnic run until every worker has reflected its frames. Stats are
+ * read before stop, while the workers still exist.
+ */
+static int run_profiled(reflector_stats_t *stats, uint64_t *tsc_span)
+{
+	reflector_ctx_t rctx = {0};
+	const uint64_t total = (uint64_t)PROFILE_WORKERS * PROFILE_FRAMES;
+
+	if (reflector_init(&rctx, VNIC_IFNAME) < 0) {
+		return -1;
+	}
+	rctx.config.num_workers = PROFILE_WORKERS;
+	rctx.config.vnic_rx_count = PROFILE_FRAMES;
+	rctx.config.profile_hot_path = true;
+
+#if HAVE_TSC_FALLBACK
+	uint64_t tsc_start = __rdtsc();
+#endif
+	if (reflector_start(&rctx) < 0) {
+		reflector_cleanup(&rctx);
+		return -1;
+	}
+	for (int i = 0; i < 500; i++) {
+		usleep(10000);
+		reflector_get_stats(&rctx, stats);
+		if (stats->packets_reflected >= total && stats->profile.packets >= total) {
+			break;
+		}
+	}
+#if HAVE_TSC_FALLBACK
+	*tsc_span = __rdtsc() - tsc_start;
+#else
+	*tsc_span = 0;
+#endif
+	reflector_cleanup(&rctx);
+	return 0;
+}
+
+/* Shared checks: every phase charged, burst/packet totals match the traffic */
+static const char *check_profile(const reflector_stats_t *stats)
+{
+	const hot_path_profile_t *prof = &stats->profile;
+	const uint64_t total = (uint64_t)PROFILE_WORKERS * PROFILE_FRAMES;
+
+	if (stats->packets_received != total || stats->packets_reflected != total) {
+		return "vnic run did not reflect every frame";
+	}
+	if (prof->packets != stats->packets_received) {
+		return "Profiled packets do not match packets received";
+	}
+	if (prof->bursts == 0 || prof->bursts > prof->packets ||
+	    prof->bursts * MAX_BATCH_SIZE < prof->packets) {
+		return "Profiled bursts do not match the packet count";
+	}
+	if (!(prof->events & (1U << PROF_EVENT_CYCLES))) {
+		return "Cycles not counted";
+	}
+	for (int e = 0; e < PROF_EVENT_COUNT; e++) {
+		for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+			bool counted = prof->events & (1U << e);
+			if (counted && prof->counts[p][e] == 0) {
+				return "A phase was never charged";
+			}
+			if (!counted && prof->counts[p][e] != 0) {
+				return "Counts for an event that was not read";
+			}
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Test a profiled vnic run with whatever counters this machine offers
+ */
+void test_profile_phases(void)
+{
+	TEST("profile_phases");
+
+	reflector_stats_t stats;
+	uint64_t tsc_span;
+	if (run_profiled(&stats, &tsc_span) < 0) {
+		FAIL("Failed to run the virtual NIC");
+		return;
+	}
+
+	const char *err = check_profile(&stats);
+	if (err != NULL) {
+		FAIL(err);
+		return;
+	}
+
+	PASS();
+}
+
+#if HAVE_TSC_FALLBACK
+/* Make perf_event_open() fail with EACCES for this thread and every thread it creates */
+static int deny_perf_event_open(void)
+{
+	struct sock_filter filter[] = {
+	    BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr)),
+	    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, __NR_perf_event_open, 0, 1),
+	    BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | EACCES),
+	    BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
+	};
+	struct sock_fprog prog = {
+	    .len = (unsigned short)(sizeof(filter) / sizeof(filter[0])),
+	    .filter = filter,
+	};
+
+	if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0 ||
+	    prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &prog) != 0) {
+		return -errno;
+	}
+	return 0;
+}
+
+/*
+ * Test the TSC fallback: with no PMU access, cycles come from the TSC, no
+ * other event is read, and the phases (disjoint slices of the workers' time)
+ * add up to no more than the TSC span of the whole run per worker
+ */
+void test_profile_tsc_fallback(void)
+{
+	TEST("profile_tsc_fallback");
+
+	if (deny_perf_event_open() < 0) {
+		FAIL("Cannot install the seccomp filter");
+		return;
+	}
+	if (syscall(__NR_perf_event_open, NULL, 0, -1, -1, 0) != -1 || errno != EACCES) {
+		FAIL("perf_event_open() not denied");
+		return;
+	}
+
+	reflector_stats_t stats;
+	uint64_t tsc_span;
+	if (run_profiled(&stats, &tsc_span) < 0) {
+		FAIL("Failed to run the virtual NIC");
+		return;
+	}
+
+	const char *err = check_profile(&stats);
+	if (err != NULL) {
+		FAIL(err);
+		return;
+	}
+	if (!stats.profile.tsc_cycles || stats.profile.events != (1U << PROF_EVENT_CYCLES)) {
+		FAIL("Cycles not taken from the TSC");
+		return;
+	}
+
+	uint64_t cycles = 0;
+	for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+		cycles += stats.profile.counts[p][PROF_EVENT_CYCLES];
+	}
+	if (cycles > tsc_span * PROFILE_WORKERS) {
+		FAIL("Phase cycles exceed the run's TSC span");
+		return;
+	}
+
+	PASS();
+}
+#endif
+
+int main(void)
+{
+	printf("Running hot-path profiler tests...\n\n");
+
+	/* Reduce log noise */
+	reflector_set_log_level(LOG_ERROR);
+
+	test_profile_phases();
+#if HAVE_TSC_FALLBACK
+	/* Last: the seccomp filter cannot be removed */
+	test_profile_tsc_fallback();
+#endif
+
+	/* Summary */
+	printf("\n=================================\n");
+	printf("Tests passed: %d\n", tests_passed);
+	printf("Tests failed: %d\n", tests_failed);
+	printf("=================================\n");
+
+	if (tests_failed == 0) {
+		printf("All profiler tests passed!\n");
+		return 0;
+	} else {
+		printf("Some tests failed\n");
+		return 1;
+	}
+}
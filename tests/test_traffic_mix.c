@@ -0,0 +1,714 @@
+/*
+ * test_traffic_mix.c - Classify+reflect benchmark over realistic traffic mixes
+ *
+ * Builds a frame arena much larger than the L1/L2 caches from a configurable
+ * mix of ITO and non-ITO traffic (wrong MAC, ARP, TCP, other UDP, unknown
+ * payload), shuffled so the branch predictor cannot learn the pattern, and
+ * times the three classify+reflect paths over it:
+ * - classify_batch() + reflect_packet_hdrs() (template pre-pass for untagged IPv4)
+ * - classify_packet() + reflect_packet_hdrs() per packet
+ * - the fused classify_reflect kernel per packet, as in the worker loop
+ *
+ * Accepted frames carry our MAC as both source and destination and the ITO
+ * port as both UDP ports, so reflecting them in place leaves them acceptable
+ * on the next pass. Every pass must accept exactly the generated ITO frames.
+ *
+ * Hardware counters (cycles, instructions, branch misses, L1D read misses)
+ * come from perf_event_open() on Linux when perf_event_paranoid allows it.
+ *
+ * Run with: ./test_traffic_mix [options] (--help lists them)
+ */
+
+#include "reflector.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define DEFAULT_FRAMES 65536
+#define DEFAULT_PASSES 16
+#define MIX_MAX_FRAME_LEN 9000
+#define MIX_MIN_FRAME_LEN 64
+
+/* Longest header stack build_frame() may grow a frame to: Eth+VLAN+IPv6+UDP+ITO */
+#define MIX_MAX_HDRS_LEN \
+	(ETH_HDR_LEN + VLAN_HDR_LEN + IPV6_HDR_LEN + UDP_HDR_LEN + ITO_SIG_OFFSET + ITO_SIG_LEN)
+
+/* Frame kinds; everything after MIX_ITO is rejected by the classifier */
+typedef enum {
+	MIX_ITO = 0,
+	MIX_WRONG_MAC,
+	MIX_ARP,
+	MIX_TCP,
+	MIX_OTHER_UDP,
+	MIX_BAD_SIG,
+	MIX_KIND_COUNT
+} mix_kind_t;
+
+static const char *const kind_names[MIX_KIND_COUNT] = {
+    "ITO", "wrong MAC", "ARP", "TCP", "other UDP", "bad signature",
+};
+
+static const char *const sig_names[SIG_TYPE_COUNT] = {
+    "PROBEOT", "DATA:OT", "LATENCY", "RFC2544", "Y.1564", "unknown",
+};
+
+typedef enum { SIZES_IMIX, SIZES_FIXED, SIZES_UNIFORM } size_mode_t;
+
+typedef struct {
+	uint32_t frames;
+	uint32_t passes;
+	double accept;
+	double vlan;
+	double ipv6;
+	uint32_t sig_weights[SIG_TYPE_UNKNOWN];
+	size_mode_t size_mode;
+	uint32_t size_min;
+	uint32_t size_max;
+	bool software_checksum;
+	uint32_t seed;
+} mix_opts_t;
+
+static const uint8_t our_mac[6] = {0x02, 0x52, 0x46, 0x4c, 0x00, 0x01};
+static const uint8_t peer_mac[6] = {0x02, 0x52, 0x46, 0x4c, 0x00, 0x02};
+
+static uint32_t rng_state;
+
+static uint32_t xorshift32(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return rng_state;
+}
+
+/* Uniform double in [0, 1) */
+static double rand_unit(void)
+{
+	return (xorshift32() >> 8) * (1.0 / 16777216.0);
+}
+
+static uint32_t pick_size(const mix_opts_t *opts)
+{
+	switch (opts->size_mode) {
+	case SIZES_FIXED:
+		return opts->size_min;
+	case SIZES_UNIFORM:
+		return opts->size_min + xorshift32() % (opts->size_max - opts->size_min + 1);
+	case SIZES_IMIX:
+	default: {
+		/* Simple IMIX: 7 x 64, 4 x 594, 1 x 1518 */
+		uint32_t r = xorshift32() % 12;
+		return r < 7 ? 64 : (r < 11 ? 594 : 1518);
+	}
+	}
+}
+
+static sig_type_t pick_signature(const mix_opts_t *opts, uint32_t weight_total)
+{
+	uint32_t r = xorshift32() % weight_total;
+	for (int s = 0; s < SIG_TYPE_UNKNOWN; s++) {
+		if (r < opts->sig_weights[s]) {
+			return (sig_type_t)s;
+		}
+		r -= opts->sig_weights[s];
+	}
+	return SIG_TYPE_PROBEOT;
+}
+
+/* Arena space for a frame of len bytes, cache-line aligned */
+static size_t frame_stride(uint32_t len)
+{
+	size_t room = len < MIX_MAX_HDRS_LEN ? MIX_MAX_HDRS_LEN : len;
+	return (room + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+	p[0] = (uint8_t)(v >> 8);
+	p[1] = (uint8_t)v;
+}
+
+/*
+ * Build one frame of the given kind. Returns the frame length, which is
+ * raised above len when the headers and signature do not fit.
+ */
+static uint32_t build_frame(uint8_t *buf, uint32_t len, mix_kind_t kind, sig_type_t sig, bool vlan,
+                            bool ipv6, uint16_t port, uint32_t flow)
+{
+	uint32_t l3 = ETH_HDR_LEN + (vlan ? VLAN_HDR_LEN : 0);
+	uint32_t l4 = l3 + (ipv6 ? IPV6_HDR_LEN : IP_HDR_MIN_LEN);
+	uint32_t payload = l4 + UDP_HDR_LEN;
+	uint32_t need = payload + ITO_SIG_OFFSET + ITO_SIG_LEN;
+	if (len < need) {
+		len = need;
+	}
+	memset(buf, 0, len);
+
+	memcpy(buf, kind == MIX_WRONG_MAC ? peer_mac : our_mac, 6);
+	memcpy(buf + 6, our_mac, 6);
+	uint32_t type_offset = ETH_TYPE_OFFSET;
+	if (vlan) {
+		put16(buf + type_offset, ETH_P_8021Q);
+		put16(buf + type_offset + 2, (uint16_t)(100 + flow % 16));
+		type_offset += VLAN_HDR_LEN;
+	}
+
+	if (kind == MIX_ARP) {
+		static const uint8_t arp[8] = {0x00, 0x01, 0x08, 0x00, 0x06, 0x04, 0x00, 0x01};
+		put16(buf + type_offset, 0x0806);
+		memcpy(buf + l3, arp, sizeof(arp));
+		memcpy(buf + l3 + 8, peer_mac, 6);
+		return len;
+	}
+
+	uint8_t proto = kind == MIX_TCP ? 6 : IPPROTO_UDP;
+	if (ipv6) {
+		put16(buf + type_offset, ETH_P_IPV6);
+		buf[l3] = 0x60;
+		put16(buf + l3 + 4, (uint16_t)(len - l4));
+		buf[l3 + IPV6_NEXT_HDR_OFFSET] = proto;
+		buf[l3 + 7] = 64;
+		buf[l3 + 8] = 0x20; /* 2001:db8::/32 documentation prefix */
+		buf[l3 + 9] = 0x01;
+		buf[l3 + 10] = 0x0d;
+		buf[l3 + 11] = 0xb8;
+		memcpy(buf + l3 + 24, buf + l3 + 8, 4);
+		put16(buf + l3 + 22, (uint16_t)flow);
+		buf[l3 + 39] = 1;
+	} else {
+		put16(buf + type_offset, ETH_P_IP);
+		buf[l3] = 0x45;
+		put16(buf + l3 + 2, (uint16_t)(len - l3));
+		buf[l3 + 8] = 64;
+		buf[l3 + IP_PROTO_OFFSET] = proto;
+		buf[l3 + 12] = 198; /* 198.18.0.0/15 benchmarking range */
+		buf[l3 + 13] = 18;
+		put16(buf + l3 + 14, (uint16_t)flow);
+		buf[l3 + 16] = 198;
+		buf[l3 + 17] = 19;
+		buf[l3 + 19] = 1;
+	}
+
+	put16(buf + l4, port);
+	put16(buf + l4 + UDP_DST_PORT_OFFSET, kind == MIX_OTHER_UDP ? 53 : port);
+	put16(buf + l4 + 4, (uint16_t)(len - l4));
+
+	if (kind == MIX_BAD_SIG) {
+		memcpy(buf + payload, "XXXXXXXXXXXX", ITO_SIG_OFFSET + ITO_SIG_LEN);
+		return len;
+	}
+	switch (sig) {
+	case SIG_TYPE_PROBEOT:
+		memcpy(buf + payload + ITO_SIG_OFFSET, ITO_SIG_PROBEOT, ITO_SIG_LEN);
+		break;
+	case SIG_TYPE_DATAOT:
+		memcpy(buf + payload + ITO_SIG_OFFSET, ITO_SIG_DATAOT, ITO_SIG_LEN);
+		break;
+	case SIG_TYPE_LATENCY:
+		memcpy(buf + payload + ITO_SIG_OFFSET, ITO_SIG_LATENCY, ITO_SIG_LEN);
+		break;
+	case SIG_TYPE_RFC2544:
+		memcpy(buf + payload, CUSTOM_SIG_RFC2544, CUSTOM_SIG_LEN);
+		break;
+	case SIG_TYPE_Y1564:
+		memcpy(buf + payload, CUSTOM_SIG_Y1564, CUSTOM_SIG_LEN);
+		break;
+	default:
+		break;
+	}
+	return len;
+}
+
+/* ------------------------------------------------------------------------
+ * Hardware counters
+ * ------------------------------------------------------------------------ */
+
+enum { PMU_CYCLES, PMU_INSTRUCTIONS, PMU_BRANCH_MISSES, PMU_L1D_MISSES, PMU_EVENTS };
+
+typedef struct {
+	int fd[PMU_EVENTS];
+	uint64_t val[PMU_EVENTS];
+	bool valid[PMU_EVENTS];
+} pmu_t;
+
+static const char *pmu_error;
+
+static void pmu_open(pmu_t *pmu)
+{
+	memset(pmu, 0, sizeof(*pmu));
+	for (int e = 0; e < PMU_EVENTS; e++) {
+		pmu->fd[e] = -1;
+	}
+#ifdef __linux__
+	static const struct {
+		uint32_t type;
+		uint64_t config;
+	} events[PMU_EVENTS] = {
+	    [PMU_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+	    [PMU_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+	    [PMU_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+	    [PMU_L1D_MISSES] = {PERF_TYPE_HW_CACHE,
+	                        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+	                            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+	};
+
+	for (int e = 0; e < PMU_EVENTS; e++) {
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = events[e].type;
+		attr.config = events[e].config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1; /* Allowed at perf_event_paranoid <= 2 */
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		pmu->fd[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		if (pmu->fd[e] < 0 && !pmu_error) {
+			pmu_error = strerror(errno);
+		}
+	}
+#else
+	pmu_error = "perf_event_open() is Linux-only";
+#endif
+}
+
+static void pmu_start(pmu_t *pmu)
+{
+#ifdef __linux__
+	for (int e = 0; e < PMU_EVENTS; e++) {
+		if (pmu->fd[e] >= 0) {
+			ioctl(pmu->fd[e], PERF_EVENT_IOC_RESET, 0);
+			ioctl(pmu->fd[e], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#else
+	(void)pmu;
+#endif
+}
+
+static void pmu_stop(pmu_t *pmu)
+{
+#ifdef __linux__
+	for (int e = 0; e < PMU_EVENTS; e++) {
+		if (pmu->fd[e] >= 0) {
+			ioctl(pmu->fd[e], PERF_EVENT_IOC_DISABLE, 0);
+		}
+	}
+	for (int e = 0; e < PMU_EVENTS; e++) {
+		uint64_t buf[3]; /* value, time enabled, time running */
+		pmu->valid[e] = false;
+		if (pmu->fd[e] < 0 || read(pmu->fd[e], buf, sizeof(buf)) != (ssize_t)sizeof(buf) ||
+		    buf[2] == 0) {
+			continue;
+		}
+		/* Scale up if the kernel multiplexed the counter */
+		pmu->val[e] = buf[2] < buf[1] ? (uint64_t)((double)buf[0] * buf[1] / buf[2]) : buf[0];
+		pmu->valid[e] = true;
+	}
+#else
+	(void)pmu;
+#endif
+}
+
+static void pmu_close(pmu_t *pmu)
+{
+#ifdef __linux__
+	for (int e = 0; e < PMU_EVENTS; e++) {
+		if (pmu->fd[e] >= 0) {
+			close(pmu->fd[e]);
+		}
+	}
+#else
+	(void)pmu;
+#endif
+}
+
+/* ------------------------------------------------------------------------
+ * Benchmarked paths
+ * ------------------------------------------------------------------------ */
+
+typedef enum { PATH_BATCH, PATH_SCALAR, PATH_FUSED, PATH_COUNT } bench_path_t;
+
+static const char *const path_names[PATH_COUNT] = {
+    "classify_batch + reflect_packet_hdrs",
+    "classify_packet + reflect_packet_hdrs",
+    "fused classify_reflect kernel",
+};
+
+/* One pass over every frame; returns accepted count and adds to sig_counts */
+static uint64_t run_pass(bench_path_t path, packet_t *pkts, uint32_t frames,
+                         const reflector_config_t *config, classify_reflect_fn_t kernel,
+                         uint64_t *sig_counts)
+{
+	uint64_t accepted = 0;
+
+	if (path == PATH_BATCH) {
+		uint64_t mask[CLASSIFY_MASK_WORDS(BATCH_SIZE)];
+		sig_type_t sigs[BATCH_SIZE];
+		pkt_hdrs_t hdrs[BATCH_SIZE];
+
+		for (uint32_t base = 0; base < frames; base += BATCH_SIZE) {
+			int n = frames - base < BATCH_SIZE ? (int)(frames - base) : BATCH_SIZE;
+			packet_t *burst = &pkts[base];
+			accepted += (uint64_t)classify_batch(burst, n, config, mask, sigs, hdrs);
+			for (int i = 0; i < n; i++) {
+				if (mask[i >> 6] & (1ULL << (i & 63))) {
+					sig_counts[sigs[i]]++;
+					reflect_packet_hdrs(burst[i].data, burst[i].len, &hdrs[i],
+					                    config->reflect_mode, config->software_checksum);
+				}
+			}
+		}
+	} else if (path == PATH_SCALAR) {
+		for (uint32_t i = 0; i < frames; i++) {
+			pkt_hdrs_t hdrs;
+			sig_type_t sig = classify_packet(pkts[i].data, pkts[i].len, config, &hdrs);
+			if (sig != SIG_TYPE_UNKNOWN) {
+				accepted++;
+				sig_counts[sig]++;
+				reflect_packet_hdrs(pkts[i].data, pkts[i].len, &hdrs, config->reflect_mode,
+				                    config->software_checksum);
+			}
+		}
+	} else {
+		for (uint32_t i = 0; i < frames; i++) {
+			sig_type_t sig = kernel(pkts[i].data, pkts[i].len, config);
+			if (sig != SIG_TYPE_UNKNOWN) {
+				accepted++;
+				sig_counts[sig]++;
+			}
+		}
+	}
+
+	return accepted;
+}
+
+/* ------------------------------------------------------------------------
+ * Option parsing
+ * ------------------------------------------------------------------------ */
+
+static void print_usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [options]\n\n", prog);
+	fprintf(stderr, "  --frames N        Frames in the arena (default: %d)\n", DEFAULT_FRAMES);
+	fprintf(stderr, "  --passes N        Timed passes over the arena per path (default: %d)\n",
+	        DEFAULT_PASSES);
+	fprintf(stderr, "  --accept R        Share of ITO frames, 0-1 (default: 0.25)\n");
+	fprintf(stderr, "  --sigs P,D,L,R,Y  Weights of PROBEOT,DATA:OT,LATENCY,RFC2544,Y.1564\n");
+	fprintf(stderr, "                    (default: 70,10,10,5,5)\n");
+	fprintf(stderr, "  --vlan R          Share of 802.1Q-tagged frames, 0-1 (default: 0.1)\n");
+	fprintf(stderr, "  --ipv6 R          Share of IPv6 among IP frames, 0-1 (default: 0.1)\n");
+	fprintf(stderr, "  --sizes S         imix, N, or MIN-MAX uniform, %d-%d (default: imix)\n",
+	        MIX_MIN_FRAME_LEN, MIX_MAX_FRAME_LEN);
+	fprintf(stderr, "  --sw-checksum     Recompute checksums in software when reflecting\n");
+	fprintf(stderr, "  --seed N          PRNG seed (default: 1)\n");
+}
+
+static bool parse_ratio(const char *s, double *out)
+{
+	char *end;
+	double v = strtod(s, &end);
+	if (*end != '\0' || v < 0.0 || v > 1.0) {
+		return false;
+	}
+	*out = v;
+	return true;
+}
+
+static bool parse_u32(const char *s, uint32_t min, uint32_t max, uint32_t *out)
+{
+	char *end;
+	errno = 0;
+	unsigned long v = strtoul(s, &end, 10);
+	if (errno != 0 || end == s || *end != '\0' || v < min || v > max) {
+		return false;
+	}
+	*out = (uint32_t)v;
+	return true;
+}
+
+static bool parse_sizes(const char *s, mix_opts_t *opts)
+{
+	if (strcmp(s, "imix") == 0) {
+		opts->size_mode = SIZES_IMIX;
+		return true;
+	}
+
+	char lo[16], hi[16];
+	const char *dash = strchr(s, '-');
+	if (!dash) {
+		opts->size_mode = SIZES_FIXED;
+		return parse_u32(s, MIX_MIN_FRAME_LEN, MIX_MAX_FRAME_LEN, &opts->size_min);
+	}
+	if ((size_t)(dash - s) >= sizeof(lo) || strlen(dash + 1) >= sizeof(hi)) {
+		return false;
+	}
+	memcpy(lo, s, (size_t)(dash - s));
+	lo[dash - s] = '\0';
+	strcpy(hi, dash + 1);
+	opts->size_mode = SIZES_UNIFORM;
+	return parse_u32(lo, MIX_MIN_FRAME_LEN, MIX_MAX_FRAME_LEN, &opts->size_min) &&
+	       parse_u32(hi, opts->size_min, MIX_MAX_FRAME_LEN, &opts->size_max);
+}
+
+static bool parse_sigs(const char *s, mix_opts_t *opts)
+{
+	const char *p = s;
+	uint32_t total = 0;
+	for (int i = 0; i < SIG_TYPE_UNKNOWN; i++) {
+		char *end;
+		errno = 0;
+		unsigned long v = strtoul(p, &end, 10);
+		if (errno != 0 || end == p || v > 1000000) {
+			return false;
+		}
+		opts->sig_weights[i] = (uint32_t)v;
+		total += (uint32_t)v;
+		if (i < SIG_TYPE_UNKNOWN - 1) {
+			if (*end != ',') {
+				return false;
+			}
+			p = end + 1;
+		} else if (*end != '\0') {
+			return false;
+		}
+	}
+	return total > 0;
+}
+
+static int parse_args(int argc, char *argv[], mix_opts_t *opts)
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+			print_usage(argv[0]);
+			return 1;
+		}
+		if (strcmp(arg, "--sw-checksum") == 0) {
+			opts->software_checksum = true;
+			continue;
+		}
+		if (i + 1 >= argc) {
+			fprintf(stderr, "Missing value for %s\n", arg);
+			return -1;
+		}
+
+		const char *val = argv[++i];
+		bool ok;
+		if (strcmp(arg, "--frames") == 0) {
+			ok = parse_u32(val, BATCH_SIZE, 1U << 24, &opts->frames);
+		} else if (strcmp(arg, "--passes") == 0) {
+			ok = parse_u32(val, 1, 1000000, &opts->passes);
+		} else if (strcmp(arg, "--accept") == 0) {
+			ok = parse_ratio(val, &opts->accept);
+		} else if (strcmp(arg, "--vlan") == 0) {
+			ok = parse_ratio(val, &opts->vlan);
+		} else if (strcmp(arg, "--ipv6") == 0) {
+			ok = parse_ratio(val, &opts->ipv6);
+		} else if (strcmp(arg, "--sizes") == 0) {
+			ok = parse_sizes(val, opts);
+		} else if (strcmp(arg, "--sigs") == 0) {
+			ok = parse_sigs(val, opts);
+		} else if (strcmp(arg, "--seed") == 0) {
+			ok = parse_u32(val, 1, UINT32_MAX, &opts->seed);
+		} else {
+			fprintf(stderr, "Unknown option: %s\n", arg);
+			print_usage(argv[0]);
+			return -1;
+		}
+		if (!ok) {
+			fprintf(stderr, "Invalid value for %s: %s\n", arg, val);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/* ------------------------------------------------------------------------
+ * Main
+ * ------------------------------------------------------------------------ */
+
+int main(int argc, char *argv[])
+{
+	mix_opts_t opts = {
+	    .frames = DEFAULT_FRAMES,
+	    .passes = DEFAULT_PASSES,
+	    .accept = 0.25,
+	    .vlan = 0.1,
+	    .ipv6 = 0.1,
+	    .sig_weights = {70, 10, 10, 5, 5},
+	    .size_mode = SIZES_IMIX,
+	    .seed = 1,
+	};
+
+	int ret = parse_args(argc, argv, &opts);
+	if (ret != 0) {
+		return ret < 0 ? 1 : 0;
+	}
+	rng_state = opts.seed;
+
+	reflector_config_t config = {0};
+	memcpy(config.mac, our_mac, 6);
+	config.filter_dst_mac = true;
+	config.ito_port = ITO_UDP_PORT;
+	config.enable_vlan = true;
+	config.enable_ipv6 = true;
+	config.sig_filter = SIG_FILTER_ALL;
+	config.reflect_mode = REFLECT_MODE_ALL;
+	config.software_checksum = opts.software_checksum;
+
+	/* Lay frames out at cache-line-rounded offsets in one arena */
+	uint32_t *lens = malloc(opts.frames * sizeof(*lens));
+	packet_t *pkts = calloc(opts.frames, sizeof(*pkts));
+	if (!lens || !pkts) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+
+	size_t arena_len = 0;
+	for (uint32_t i = 0; i < opts.frames; i++) {
+		lens[i] = pick_size(&opts);
+		arena_len += frame_stride(lens[i]);
+	}
+	uint8_t *arena = NULL;
+	if (posix_memalign((void **)&arena, CACHE_LINE_SIZE, arena_len) != 0) {
+		fprintf(stderr, "Out of memory (%zu byte arena)\n", arena_len);
+		return 1;
+	}
+
+	uint32_t weight_total = 0;
+	for (int s = 0; s < SIG_TYPE_UNKNOWN; s++) {
+		weight_total += opts.sig_weights[s];
+	}
+
+	uint64_t kind_counts[MIX_KIND_COUNT] = {0};
+	uint64_t expected_sigs[SIG_TYPE_COUNT] = {0};
+	uint64_t expected_accept = 0;
+	uint64_t total_bytes = 0;
+	uint32_t vlan_frames = 0, ipv6_frames = 0;
+	size_t offset = 0;
+
+	for (uint32_t i = 0; i < opts.frames; i++) {
+		mix_kind_t kind = MIX_ITO;
+		if (rand_unit() >= opts.accept) {
+			kind = (mix_kind_t)(MIX_WRONG_MAC + xorshift32() % (MIX_KIND_COUNT - MIX_WRONG_MAC));
+		}
+		sig_type_t sig = pick_signature(&opts, weight_total);
+		bool vlan = rand_unit() < opts.vlan;
+		bool ipv6 = kind != MIX_ARP && rand_unit() < opts.ipv6;
+
+		uint8_t *buf = arena + offset;
+		uint32_t len =
+		    build_frame(buf, lens[i], kind, sig, vlan, ipv6, config.ito_port, xorshift32());
+		offset += frame_stride(lens[i]);
+
+		pkts[i].data = buf;
+		pkts[i].len = len;
+		kind_counts[kind]++;
+		total_bytes += len;
+		vlan_frames += vlan;
+		ipv6_frames += ipv6;
+		if (kind == MIX_ITO) {
+			expected_accept++;
+			expected_sigs[sig]++;
+		}
+	}
+
+	printf("=================================\n");
+	printf("Traffic Mix Benchmark\n");
+	printf("=================================\n");
+	printf("Frames: %u, passes: %u, seed: %u\n", opts.frames, opts.passes, opts.seed);
+	printf("Arena: %.1f MB, mean frame %.0f bytes\n", arena_len / (1024.0 * 1024.0),
+	       (double)total_bytes / opts.frames);
+	printf("Mix:");
+	for (int k = 0; k < MIX_KIND_COUNT; k++) {
+		printf("%s %s %.1f%%", k ? "," : "", kind_names[k], 100.0 * kind_counts[k] / opts.frames);
+	}
+	printf("\n");
+	printf("     802.1Q %.1f%%, IPv6 %.1f%%, checksums %s\n", 100.0 * vlan_frames / opts.frames,
+	       100.0 * ipv6_frames / opts.frames, opts.software_checksum ? "software" : "NIC");
+	printf("\n");
+
+	pmu_t pmu;
+	pmu_open(&pmu);
+	if (pmu_error) {
+		printf("Hardware counters: partly or fully unavailable (%s)\n\n", pmu_error);
+	}
+
+	classify_reflect_fn_t kernel =
+	    classify_reflect_select(config.reflect_mode, config.software_checksum);
+	int failures = 0;
+
+	for (int p = 0; p < PATH_COUNT; p++) {
+		uint64_t sig_counts[SIG_TYPE_COUNT] = {0};
+
+		/* Untimed warm-up pass faults in the arena and checks the result */
+		bench_path_t path = (bench_path_t)p;
+		uint64_t accepted = run_pass(path, pkts, opts.frames, &config, kernel, sig_counts);
+		bool ok = accepted == expected_accept;
+		for (int s = 0; s < SIG_TYPE_COUNT; s++) {
+			ok = ok && sig_counts[s] == expected_sigs[s];
+		}
+
+		uint64_t dummy[SIG_TYPE_COUNT] = {0};
+		uint64_t total_accepted = 0;
+		pmu_start(&pmu);
+		uint64_t start = get_timestamp_ns();
+		for (uint32_t pass = 0; pass < opts.passes; pass++) {
+			total_accepted += run_pass(path, pkts, opts.frames, &config, kernel, dummy);
+		}
+		uint64_t elapsed_ns = get_timestamp_ns() - start;
+		pmu_stop(&pmu);
+
+		ok = ok && total_accepted == expected_accept * opts.passes;
+		double packets = (double)opts.frames * opts.passes;
+
+		printf("%s:\n", path_names[p]);
+		printf("  %.2f ns/pkt, %.2f Mpps\n", elapsed_ns / packets, packets * 1000.0 / elapsed_ns);
+		if (pmu.valid[PMU_CYCLES] && pmu.valid[PMU_INSTRUCTIONS]) {
+			uint64_t cycles = pmu.val[PMU_CYCLES] ? pmu.val[PMU_CYCLES] : 1;
+			printf("  %.1f cycles/pkt, %.1f instructions/pkt, IPC %.2f\n", cycles / packets,
+			       pmu.val[PMU_INSTRUCTIONS] / packets, (double)pmu.val[PMU_INSTRUCTIONS] / cycles);
+		}
+		if (pmu.valid[PMU_BRANCH_MISSES]) {
+			printf("  Branch misses: %llu (%.3f/pkt)\n",
+			       (unsigned long long)pmu.val[PMU_BRANCH_MISSES],
+			       pmu.val[PMU_BRANCH_MISSES] / packets);
+		}
+		if (pmu.valid[PMU_L1D_MISSES]) {
+			printf("  L1D read misses: %llu (%.3f/pkt)\n",
+			       (unsigned long long)pmu.val[PMU_L1D_MISSES], pmu.val[PMU_L1D_MISSES] / packets);
+		}
+		printf("  Accepted per pass: %llu of %u", (unsigned long long)accepted, opts.frames);
+		for (int s = 0; s < SIG_TYPE_UNKNOWN; s++) {
+			printf("%s%s %llu", s ? ", " : " (", sig_names[s], (unsigned long long)sig_counts[s]);
+		}
+		printf(")%s\n\n", ok ? "" : "  MISMATCH");
+		if (!ok) {
+			failures++;
+		}
+	}
+
+	if (failures) {
+		printf("❌ %d path(s) accepted a different set of frames than generated (%llu ITO)\n",
+		       failures, (unsigned long long)expected_accept);
+	}
+
+	pmu_close(&pmu);
+	free(arena);
+	free(pkts);
+	free(lens);
+	return failures ? 1 : 0;
+}
@@ -7,7 +7,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <errno.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 int tests_passed = 0;
 int tests_failed = 0;
@@ -40,6 +43,36 @@ TEST(timestamp_monotonic)
 	ASSERT(t2 - t1 < 1000000); /* Should be less than 1ms apart */
 }
 
+/* Test calibrated fast clock against CLOCK_MONOTONIC */
+TEST(fast_clock_tracks_monotonic)
+{
+	fast_clock_init(); /* Falls back to clock_gettime without an invariant counter */
+
+	uint64_t f1 = fast_clock_ns();
+	uint64_t f2 = fast_clock_ns();
+	ASSERT(f2 >= f1);
+
+	/* Both clocks share the CLOCK_MONOTONIC epoch; allow 1ms calibration error */
+	uint64_t m1 = get_timestamp_ns();
+	uint64_t f3 = fast_clock_ns();
+	ASSERT(f3 + 1000000 > m1 && f3 < m1 + 1000000);
+
+	/* Elapsed time over ~20ms agrees within 2% */
+	struct timespec delay = {.tv_sec = 0, .tv_nsec = 20000000};
+	nanosleep(&delay, NULL);
+	uint64_t m2 = get_timestamp_ns();
+	uint64_t f4 = fast_clock_ns();
+	int64_t err = (int64_t)(f4 - f3) - (int64_t)(m2 - m1);
+	ASSERT(err < (int64_t)(m2 - m1) / 50 && -err < (int64_t)(m2 - m1) / 50);
+
+	/* Realtime conversion lands on "now" */
+	struct timespec rt;
+	clock_gettime(CLOCK_REALTIME, &rt);
+	uint64_t conv = fast_clock_from_realtime((uint64_t)rt.tv_sec * 1000000000ULL + rt.tv_nsec);
+	uint64_t f5 = fast_clock_ns();
+	ASSERT(conv + 1000000 > f5 && conv < f5 + 1000000);
+}
+
 /* Test signature type detection */
 TEST(signature_type_probeot)
 {
@@ -327,6 +360,35 @@ TEST(latency_stats_update)
 	ASSERT(stats.avg_ns == 150000.0);
 }
 
+TEST(latency_hist_percentiles)
+{
+	static latency_hist_t hist;
+	memset(&hist, 0, sizeof(hist));
+
+	ASSERT(latency_hist_percentile(&hist, 99.0) == 0);
+
+	/* 1..10000 ns uniformly: pN is N% of 10000 within one bucket (~3%) */
+	for (uint64_t v = 1; v <= 10000; v++) {
+		latency_hist_record(&hist, v);
+	}
+	uint64_t p50 = latency_hist_percentile(&hist, 50.0);
+	uint64_t p99 = latency_hist_percentile(&hist, 99.0);
+	ASSERT(p50 >= 5000 && p50 <= 5000 + 5000 / 32);
+	ASSERT(p99 >= 9900 && p99 <= 9900 + 9900 / 32);
+
+	/* Exact below LATENCY_HIST_SUB_BUCKETS */
+	static latency_hist_t small;
+	memset(&small, 0, sizeof(small));
+	latency_hist_record(&small, 7);
+	ASSERT(latency_hist_percentile(&small, 50.0) == 7);
+
+	/* One slow outlier in 10000 shows up at p99.99 only; huge values clamp */
+	latency_hist_merge(&small, &hist);
+	latency_hist_record(&small, 1ULL << 40);
+	ASSERT(latency_hist_percentile(&small, 99.0) < 10400);
+	ASSERT(latency_hist_percentile(&small, 100.0) >= (1ULL << LATENCY_HIST_MAX_BITS) - 1);
+}
+
 TEST(signature_stats_update)
 {
 	reflector_stats_t stats = {0};
@@ -358,18 +420,145 @@ TEST(error_stats_update)
 	ASSERT(stats.err_tx_failed == 1);
 }
 
+/* Test CPU list parsing (--cpus, sysfs lists) */
+TEST(cpu_list_parse)
+{
+	int cpus[8];
+
+	ASSERT(parse_cpu_list("3", cpus, 8) == 1 && cpus[0] == 3);
+	ASSERT(parse_cpu_list("0-3,8,10-11\n", cpus, 8) == 7);
+	ASSERT(cpus[0] == 0 && cpus[3] == 3 && cpus[4] == 8 && cpus[6] == 11);
+
+	ASSERT(parse_cpu_list("", cpus, 8) == -EINVAL);
+	ASSERT(parse_cpu_list("1,", cpus, 8) == -EINVAL);
+	ASSERT(parse_cpu_list("3-1", cpus, 8) == -EINVAL);
+	ASSERT(parse_cpu_list("a", cpus, 8) == -EINVAL);
+	ASSERT(parse_cpu_list("-1", cpus, 8) == -EINVAL);
+	ASSERT(parse_cpu_list("0-8", cpus, 8) == -EINVAL); /* 9 CPUs > capacity */
+	ASSERT(parse_cpu_list(NULL, cpus, 8) == -EINVAL);
+}
+
+/* Test /proc/interrupts name matching for queue IRQs */
+TEST(irq_name_match)
+{
+	ASSERT(irq_name_matches_queue("eth1-TxRx-3", "eth1", NULL, 3));
+	ASSERT(irq_name_matches_queue("ice-eth1-TxRx-3", "eth1", NULL, 3));
+	ASSERT(irq_name_matches_queue("eth1:rx_3", "eth1", NULL, 3));
+	ASSERT(!irq_name_matches_queue("eth1-TxRx-13", "eth1", NULL, 3));
+
+	/* The interface name is a whole token */
+	ASSERT(!irq_name_matches_queue("eth10-TxRx-3", "eth1", NULL, 3));
+	ASSERT(!irq_name_matches_queue("veth1-rx-3", "eth1", NULL, 3));
+	ASSERT(!irq_name_matches_queue("eth1x-rx-3", "eth1", NULL, 3));
+	ASSERT(irq_name_matches_queue("eth10-TxRx-3", "eth10", NULL, 3));
+
+	/* mlx5 names the PCI device, not the interface */
+	ASSERT(irq_name_matches_queue("mlx5_comp3@pci:0000:03:00.0", "eth1", "0000:03:00.0", 3));
+	ASSERT(!irq_name_matches_queue("mlx5_comp3@pci:0000:03:00.1", "eth1", "0000:03:00.0", 3));
+	ASSERT(!irq_name_matches_queue("mlx5_comp3@pci:0000:03:00.0", "eth1", NULL, 3));
+}
+
+/* Test worker placement precedence */
+TEST(worker_placement)
+{
+	reflector_config_t cfg = {0};
+	int cpus[4];
+
+	/* Explicit list wins and wraps */
+	cfg.num_worker_cpus = parse_cpu_list("5,7", cfg.worker_cpus, MAX_WORKERS);
+	cfg.cpu_affinity = 1;
+	if (plan_worker_cpus(&cfg, -1, 4, cpus) < 0) {
+		return; /* Placement unsupported on this platform */
+	}
+	ASSERT(cpus[0] == 5 && cpus[1] == 7 && cpus[2] == 5 && cpus[3] == 7);
+
+	/* A single start CPU no longer pins every worker to the same core */
+	long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+	cfg.num_worker_cpus = 0;
+	cfg.cpu_affinity = 0;
+	ASSERT(plan_worker_cpus(&cfg, -1, 2, cpus) == 0);
+	ASSERT(cpus[0] == 0 && cpus[1] == (nprocs > 1 ? 1 : 0));
+
+	/* Automatic placement picks online CPUs, distinct while they last */
+	cfg.cpu_affinity = -1;
+	strcpy(cfg.ifname, "lo");
+	ASSERT(plan_worker_cpus(&cfg, -1, 2, cpus) == 0);
+	ASSERT(cpus[0] >= 0 && cpus[0] < PLACEMENT_MAX_CPUS);
+	ASSERT(nprocs < 2 || cpus[0] != cpus[1]);
+
+	/* More workers than MAX_WORKERS: every worker gets an online CPU */
+	int many[MAX_WORKERS * 4 + 1];
+	const int num_many = (int)(sizeof(many) / sizeof(many[0]));
+	for (int i = 0; i < num_many; i++) {
+		many[i] = -2;
+	}
+	ASSERT(plan_worker_cpus(&cfg, -1, num_many - 1, many) == 0);
+	for (int i = 0; i < num_many - 1; i++) {
+		ASSERT(many[i] >= 0 && many[i] < PLACEMENT_MAX_CPUS);
+	}
+	ASSERT(many[num_many - 1] == -2); /* Nothing written past num_workers */
+}
+
+TEST(burst_ctl_adapts)
+{
+	burst_ctl_t bc;
+
+	/* Fixed mode never moves; out-of-range sizes are clamped */
+	burst_ctl_init(&bc, 1000, false);
+	ASSERT(bc.size == MAX_BATCH_SIZE);
+	burst_ctl_update(&bc, 1);
+	ASSERT(bc.size == MAX_BATCH_SIZE);
+	burst_ctl_init(&bc, 0, false);
+	ASSERT(bc.size == BATCH_SIZE);
+
+	/* Adaptive: full bursts double up to the ceiling */
+	burst_ctl_init(&bc, MAX_BATCH_SIZE, true);
+	ASSERT(bc.size == ADAPTIVE_BATCH_MIN);
+	while (bc.size < MAX_BATCH_SIZE) {
+		int prev = bc.size;
+		burst_ctl_update(&bc, bc.size);
+		ASSERT(bc.size == prev * 2);
+	}
+	burst_ctl_update(&bc, bc.size);
+	ASSERT(bc.size == MAX_BATCH_SIZE);
+
+	/* Light bursts halve only after ADAPTIVE_SHRINK_AFTER in a row */
+	for (int i = 0; i < ADAPTIVE_SHRINK_AFTER - 1; i++) {
+		burst_ctl_update(&bc, 1);
+	}
+	burst_ctl_update(&bc, MAX_BATCH_SIZE / 2); /* Moderate burst resets the streak */
+	for (int i = 0; i < ADAPTIVE_SHRINK_AFTER - 1; i++) {
+		burst_ctl_update(&bc, 1);
+	}
+	ASSERT(bc.size == MAX_BATCH_SIZE);
+	burst_ctl_update(&bc, 1);
+	ASSERT(bc.size == MAX_BATCH_SIZE / 2);
+
+	/* ...and never below the floor */
+	for (int i = 0; i < 64 * ADAPTIVE_SHRINK_AFTER; i++) {
+		burst_ctl_update(&bc, 1);
+	}
+	ASSERT(bc.size == ADAPTIVE_BATCH_MIN);
+}
+
 int main(void)
 {
 	printf("Running utility function tests...\n\n");
 
 	RUN_TEST(timestamp_monotonic);
+	RUN_TEST(fast_clock_tracks_monotonic);
 	RUN_TEST(signature_type_probeot);
 	RUN_TEST(signature_type_dataot);
 	RUN_TEST(signature_type_latency);
 	RUN_TEST(signature_type_unknown);
 	RUN_TEST(latency_stats_update);
+	RUN_TEST(latency_hist_percentiles);
 	RUN_TEST(signature_stats_update);
 	RUN_TEST(error_stats_update);
+	RUN_TEST(cpu_list_parse);
+	RUN_TEST(irq_name_match);
+	RUN_TEST(worker_placement);
+	RUN_TEST(burst_ctl_adapts);
 
 	printf("\n=================================\n");
 	printf("Tests passed: %d\n", tests_passed);